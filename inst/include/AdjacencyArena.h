@@ -0,0 +1,618 @@
+#ifndef ADJACENCYARENAH_
+#define ADJACENCYARENAH_
+
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <iterator>
+#include <boost/shared_ptr.hpp>
+
+#include "DegreeIndex.h"
+
+namespace lolog{
+
+
+/*!
+ * The neighbour lists of all vertices of a network, held in a few large
+ * pages.
+ *
+ * Each vertex owns a slot of a page holding its neighbours in increasing
+ * order, followed by some unused capacity. Inserting into a full slot moves
+ * the list to the end of the last page with double the capacity, leaving a
+ * hole behind. Once the holes make up more than half of the arena it is
+ * compacted. Slots larger than half a page get a page of their own.
+ *
+ * Compared with a separate sorted set per vertex, this costs a handful of
+ * allocations for the whole network and keeps the neighbours of consecutive
+ * vertices near one another in memory.
+ *
+ * Copies of an arena share their pages and hubs copy-on-write: a copy costs
+ * O(n) for the per vertex bookkeeping, and a page or hub is only duplicated
+ * the first time one of the copies modifies it. Copying settles the source
+ * arena, so shared hubs have no pending flips and are never changed by reads.
+ *
+ * Inserting into or erasing from a sorted list moves the entries after it,
+ * which is slow for hubs with tens of thousands of neighbours. A vertex whose
+ * degree reaches hubDegree() leaves the arena and becomes a hub: its
+ * neighbours are kept in a sorted vector of their own, and changes are
+ * recorded in a balanced tree of pending flips, so that updates cost
+ * O(log d). The flips are merged into the sorted vector when the neighbours
+ * of the hub are next iterated (which costs O(d) in any case), or once there
+ * are more than d / 16 of them. A hub returns to the arena when its degree
+ * falls below half the threshold.
+ *
+ * The degrees are also held in a DegreeIndex, so that the owner of a random
+ * neighbour list entry can be found in O(log n).
+ *
+ * Pointers returned by begin and end are invalidated by any modification
+ * of the arena, not just of the vertex they were taken from. Because begin
+ * and end may merge the pending flips of a hub, an arena must not be read
+ * from several threads at once after it has been modified.
+ */
+class AdjacencyArena{
+protected:
+
+    /*!
+     * the neighbours of a high degree vertex
+     */
+    struct Hub{
+        std::vector<int> sorted;    /*!< the neighbours as of the last merge */
+        std::set<int> flipped;      /*!< the ids whose membership differs from sorted */
+    };
+
+    typedef boost::shared_ptr< std::vector<int> > PagePtr;
+    typedef boost::shared_ptr<Hub> HubPtr;
+
+    std::vector<PagePtr> pages;
+    std::vector<int> page;      /*!< the page holding each vertex's slot */
+    std::vector<int> offset;    /*!< the offset of each vertex's slot in its page */
+    std::vector<int> count;     /*!< the number of neighbours of each vertex */
+    std::vector<int> cap;       /*!< the capacity of each vertex's slot */
+    size_t tail;                /*!< the used length of the last page */
+    size_t holes;               /*!< entries left behind by relocated slots */
+    size_t nAllocated;          /*!< the total length of the pages */
+
+    std::vector<int> hubIndex;  /*!< the index in hubs of each vertex, -1 if not a hub */
+    std::vector<HubPtr> hubs;
+    std::vector<int> freeHubs;  /*!< unused (null) entries of hubs */
+    int hubThreshold;
+
+    DegreeIndex index;          /*!< partial sums of count */
+
+    /*!
+     * the slot of v, for reading
+     */
+    inline const int* slot(int v) const{
+        return &(*pages[page[v]])[0] + offset[v];
+    }
+
+    /*!
+     * the slot of v, for writing. Copies its page if it is shared.
+     */
+    inline int* slot(int v){
+        PagePtr& p = pages[page[v]];
+        if(!p.unique())
+            p = PagePtr(new std::vector<int>(*p));
+        return &(*p)[0] + offset[v];
+    }
+
+    /*!
+     * hub h, for writing. Copies it if it is shared.
+     */
+    inline Hub& hub(int h){
+        if(!hubs[h].unique())
+            hubs[h] = HubPtr(new Hub(*hubs[h]));
+        return *hubs[h];
+    }
+
+    /*!
+     * gives v a new, unfilled slot of the given capacity at the end of the
+     * arena
+     */
+    void place(int v, int capacity){
+        if(capacity > pageSize() / 2){
+            pages.push_back(PagePtr(new std::vector<int>(capacity)));
+            nAllocated += capacity;
+            page[v] = pages.size() - 1;
+            offset[v] = 0;
+            tail = capacity;
+        }else{
+            if(pages.empty() || tail + capacity > pages.back()->size()){
+                pages.push_back(PagePtr(new std::vector<int>(pageSize())));
+                nAllocated += pageSize();
+                tail = 0;
+            }
+            page[v] = pages.size() - 1;
+            offset[v] = tail;
+            tail += capacity;
+        }
+        cap[v] = capacity;
+    }
+
+    /*!
+     * starts a new, empty set of pages, returning the old ones
+     */
+    void resetPages(std::vector<PagePtr>& old){
+        old.swap(pages);
+        pages.clear();
+        tail = 0;
+        holes = 0;
+        nAllocated = 0;
+    }
+
+    inline bool isHub(int v) const{
+        return hubIndex[v] >= 0;
+    }
+
+    /*!
+     * merges the pending flips of a hub into its sorted neighbours
+     */
+    void flush(int h) const{
+        Hub& hub = *hubs[h];
+        if(hub.flipped.empty())
+            return;
+        std::vector<int> merged;
+        merged.reserve(hub.sorted.size() + hub.flipped.size());
+        std::set_symmetric_difference(hub.sorted.begin(), hub.sorted.end(),
+                hub.flipped.begin(), hub.flipped.end(), std::back_inserter(merged));
+        hub.sorted.swap(merged);
+        hub.flipped.clear();
+    }
+
+    /*!
+     * changes the membership of x in the neighbours of hub h
+     */
+    void flip(int h, int x){
+        Hub& hub = this->hub(h);
+        std::pair<std::set<int>::iterator, bool> res = hub.flipped.insert(x);
+        if(!res.second)
+            hub.flipped.erase(res.first);
+        if(hub.flipped.size() > std::max((size_t) 64, hub.sorted.size() / 16))
+            flush(h);
+    }
+
+    /*!
+     * moves the neighbours of v from its slot to a hub
+     */
+    void promote(int v){
+        int h;
+        if(freeHubs.empty()){
+            h = hubs.size();
+            hubs.push_back(HubPtr());
+        }else{
+            h = freeHubs.back();
+            freeHubs.pop_back();
+        }
+        hubs[h] = HubPtr(new Hub());
+        const int* s = static_cast<const AdjacencyArena*>(this)->slot(v);
+        hubs[h]->sorted.assign(s, s + count[v]);
+        holes += cap[v];
+        cap[v] = 0;
+        hubIndex[v] = h;
+    }
+
+    /*!
+     * moves the neighbours of hub v back to a slot at the end of the arena
+     */
+    void demote(int v){
+        int h = hubIndex[v];
+        flush(h);
+        hubIndex[v] = -1;
+        HubPtr old = hubs[h];
+        hubs[h] = HubPtr();
+        freeHubs.push_back(h);
+        if(holes > 1024 && 2 * holes > nAllocated)
+            compact();
+        place(v, std::max(4, 2 * count[v]));
+        if(count[v] > 0)
+            std::memcpy(slot(v), &old->sorted[0], count[v] * sizeof(int));
+    }
+
+    /*!
+     * drops the neighbours held by hub v without moving them to the arena
+     */
+    void release(int v){
+        int h = hubIndex[v];
+        hubIndex[v] = -1;
+        hubs[h] = HubPtr();
+        freeHubs.push_back(h);
+    }
+
+    /*!
+     * moves every hub back into the arena
+     */
+    void demoteAll(){
+        for(int i=0;i<size();i++)
+            if(isHub(i))
+                demote(i);
+    }
+
+    /*!
+     * makes a hub of every vertex at or above the threshold
+     */
+    void promoteAll(){
+        for(int i=0;i<size();i++)
+            if(!isHub(i) && count[i] >= hubThreshold)
+                promote(i);
+    }
+
+    /*!
+     * moves the slot of v to the end of the arena, with room for at
+     * least one more neighbour
+     */
+    void grow(int v){
+        int newCap = std::max(4, 2 * cap[v]);
+        if(holes > 1024 && 2 * holes > nAllocated)
+            compact();
+        if(cap[v] > 0 && page[v] == pages.size() - 1 && offset[v] + cap[v] == tail &&
+                offset[v] + newCap <= pages.back()->size()){
+            //the last slot can be extended in place
+            tail = offset[v] + newCap;
+            cap[v] = newCap;
+            return;
+        }
+        PagePtr from = cap[v] > 0 ? pages[page[v]] : PagePtr();
+        int fromOffset = offset[v];
+        holes += cap[v];
+        place(v, newCap);
+        if(count[v] > 0)
+            std::memcpy(slot(v), &(*from)[0] + fromOffset, count[v] * sizeof(int));
+    }
+
+public:
+
+    AdjacencyArena() : tail(0), holes(0), nAllocated(0), hubThreshold(defaultHubDegree()), index(0){}
+
+    /*!
+     * An arena for n vertices without neighbours
+     */
+    AdjacencyArena(int n) : page(n, -1), offset(n, 0), count(n, 0), cap(n, 0), tail(0), holes(0),
+        nAllocated(0), hubIndex(n, -1), hubThreshold(defaultHubDegree()), index(n){}
+
+    /*!
+     * A copy sharing the pages and hubs of arena until either is modified
+     */
+    AdjacencyArena(const AdjacencyArena& arena){
+        *this = arena;
+    }
+
+    AdjacencyArena& operator=(const AdjacencyArena& arena){
+        arena.settle();
+        pages = arena.pages;
+        page = arena.page;
+        offset = arena.offset;
+        count = arena.count;
+        cap = arena.cap;
+        tail = arena.tail;
+        holes = arena.holes;
+        nAllocated = arena.nAllocated;
+        hubIndex = arena.hubIndex;
+        hubs = arena.hubs;
+        freeHubs = arena.freeHubs;
+        hubThreshold = arena.hubThreshold;
+        index = arena.index;
+        return *this;
+    }
+
+    /*!
+     * the length of a page, in neighbours
+     */
+    static int pageSize(){
+        return 4096;
+    }
+
+    /*!
+     * the degree at which a vertex becomes a hub, unless changed by setHubDegree
+     */
+    static int defaultHubDegree(){
+        return 1024;
+    }
+
+    int hubDegree() const{
+        return hubThreshold;
+    }
+
+    /*!
+     * sets the degree at which a vertex becomes a hub (at least 2).
+     * Takes effect at the next change to each vertex.
+     */
+    void setHubDegree(int degree){
+        hubThreshold = std::max(2, degree);
+    }
+
+    /*!
+     * the number of vertices currently held as hubs
+     */
+    int nHubs() const{
+        return hubs.size() - freeHubs.size();
+    }
+
+    int size() const{
+        return count.size();
+    }
+
+    inline int degree(int v) const{
+        return count[v];
+    }
+
+    /*!
+     * the neighbours of v, in increasing order
+     */
+    inline const int* begin(int v) const{
+        if(isHub(v)){
+            flush(hubIndex[v]);
+            return count[v] == 0 ? NULL : &hubs[hubIndex[v]]->sorted[0];
+        }
+        return cap[v] == 0 ? NULL : slot(v);
+    }
+
+    inline const int* end(int v) const{
+        if(isHub(v))
+            return begin(v) + count[v];
+        return cap[v] == 0 ? NULL : slot(v) + count[v];
+    }
+
+    inline bool contains(int v, int x) const{
+        if(isHub(v)){
+            const Hub& hub = *hubs[hubIndex[v]];
+            bool in = std::binary_search(hub.sorted.begin(), hub.sorted.end(), x);
+            return in != (hub.flipped.count(x) > 0);
+        }
+        return std::binary_search(begin(v), end(v), x);
+    }
+
+    /*!
+     * merges the pending flips of all hubs, after which the arena may be read
+     * from several threads until it is next modified
+     */
+    void settle() const{
+        for(int h=0;h<hubs.size();h++)
+            if(hubs[h])
+                flush(h);
+    }
+
+    /*!
+     * the partial sums of the degrees
+     */
+    const DegreeIndex& degrees() const{
+        return index;
+    }
+
+    /*!
+     * the r-th vertex (counting from 0) in [lo, hi) which is neither v nor
+     * a neighbour of v, found by bisection in O(log n log d)
+     */
+    int nthNonNeighbour(int v, int r, int lo, int hi) const{
+        const int* e = end(v);
+        const int* first = std::lower_bound(begin(v), e, lo);
+        int origin = lo;
+        while(lo < hi){
+            int mid = lo + (hi - lo) / 2;
+            //the number of non-neighbours in [origin, mid]
+            int excluded = (std::upper_bound(first, e, mid) - first) + (v >= origin && v <= mid);
+            if(mid - origin + 1 - excluded > r)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        return lo;
+    }
+
+    /*!
+     * adds x to the neighbours of v
+     * \returns false if x was already a neighbour
+     */
+    bool insert(int v, int x){
+        if(isHub(v)){
+            if(contains(v, x))
+                return false;
+            flip(hubIndex[v], x);
+            count[v]++;
+            index.add(v, 1);
+            return true;
+        }
+        const int* b = begin(v);
+        const int* e = end(v);
+        const int* pos = std::lower_bound(b, e, x);
+        if(pos != e && *pos == x)
+            return false;
+        size_t offset = pos - b;
+        if(count[v] == cap[v])
+            grow(v);
+        int* s = slot(v);
+        std::memmove(s + offset + 1, s + offset, (count[v] - offset) * sizeof(int));
+        s[offset] = x;
+        count[v]++;
+        index.add(v, 1);
+        if(count[v] >= hubThreshold)
+            promote(v);
+        return true;
+    }
+
+    /*!
+     * removes x from the neighbours of v
+     * \returns false if x was not a neighbour
+     */
+    bool erase(int v, int x){
+        if(isHub(v)){
+            if(!contains(v, x))
+                return false;
+            flip(hubIndex[v], x);
+            count[v]--;
+            index.add(v, -1);
+            if(2 * count[v] < hubThreshold)
+                demote(v);
+            return true;
+        }
+        const int* b = begin(v);
+        const int* e = end(v);
+        const int* pos = std::lower_bound(b, e, x);
+        if(pos == e || *pos != x)
+            return false;
+        size_t offset = pos - b;
+        int* s = slot(v);
+        std::memmove(s + offset, s + offset + 1, (count[v] - offset - 1) * sizeof(int));
+        count[v]--;
+        index.add(v, -1);
+        return true;
+    }
+
+    /*!
+     * removes all neighbours of v, keeping its capacity unless it is a hub
+     */
+    void clear(int v){
+        if(isHub(v))
+            release(v);
+        index.add(v, -count[v]);
+        count[v] = 0;
+    }
+
+    /*!
+     * removes all neighbours of all vertices, keeping their capacity
+     */
+    void clearAll(){
+        for(int i=0;i<size();i++)
+            if(isHub(i))
+                release(i);
+        std::fill(count.begin(), count.end(), 0);
+        index.clear();
+    }
+
+    /*!
+     * replaces the neighbours of every vertex v with nbrs[start[v]] to
+     * nbrs[start[v + 1] - 1], in O(n + m). Each list must be in increasing
+     * order without repeats.
+     */
+    void assign(const int64_t* start, const int* nbrs){
+        for(int i=0;i<size();i++)
+            if(isHub(i))
+                release(i);
+        std::vector<PagePtr> oldPages;
+        resetPages(oldPages);
+        for(int i=0;i<size();i++){
+            count[i] = start[i + 1] - start[i];
+            page[i] = -1;
+            offset[i] = 0;
+            cap[i] = 0;
+            if(count[i] == 0)
+                continue;
+            place(i, count[i]);
+            std::memcpy(slot(i), nbrs + start[i], count[i] * sizeof(int));
+        }
+        index.assign(count);
+        promoteAll();
+    }
+
+    /*!
+     * adds a vertex without neighbours
+     */
+    void addVertex(){
+        page.push_back(-1);
+        offset.push_back(0);
+        count.push_back(0);
+        cap.push_back(0);
+        hubIndex.push_back(-1);
+        index.addVertex();
+    }
+
+    /*!
+     * removes vertex v, dropping it from all neighbour lists and shifting
+     * the ids of the vertices after it down by one
+     */
+    void removeVertex(int v){
+        demoteAll();
+        holes += cap[v];
+        page.erase(page.begin() + v);
+        offset.erase(offset.begin() + v);
+        count.erase(count.begin() + v);
+        cap.erase(cap.begin() + v);
+        hubIndex.erase(hubIndex.begin() + v);
+        for(int i=0;i<size();i++){
+            int* s = count[i] > 0 ? slot(i) : NULL;
+            int k = 0;
+            for(int j=0;j<count[i];j++){
+                if(s[j] == v)
+                    continue;
+                s[k++] = s[j] > v ? s[j] - 1 : s[j];
+            }
+            count[i] = k;
+        }
+        index.assign(count);
+        promoteAll();
+    }
+
+    /*!
+     * renumbers the vertices so that vertex i becomes the old vertex order[i]
+     */
+    void relabel(const std::vector<int>& order){
+        demoteAll();
+        int n = size();
+        std::vector<int> newId(n);
+        for(int i=0;i<n;i++)
+            newId[order[i]] = i;
+        std::vector<PagePtr> oldPages;
+        resetPages(oldPages);
+        std::vector<int> oldPage, oldOffset, oldCount, oldCap;
+        oldPage.swap(page);
+        oldOffset.swap(offset);
+        oldCount.swap(count);
+        oldCap.swap(cap);
+        page.assign(n, -1);
+        offset.assign(n, 0);
+        count.assign(n, 0);
+        cap.assign(n, 0);
+        for(int i=0;i<n;i++){
+            int old = order[i];
+            count[i] = oldCount[old];
+            if(oldCap[old] == 0)
+                continue;
+            place(i, oldCap[old]);
+            const int* from = &(*oldPages[oldPage[old]])[0] + oldOffset[old];
+            int* to = slot(i);
+            for(int k=0;k<count[i];k++)
+                to[k] = newId[from[k]];
+            std::sort(to, to + count[i]);
+        }
+        index.assign(count);
+        promoteAll();
+    }
+
+    /*!
+     * removes the holes left by relocated slots
+     */
+    void compact(){
+        std::vector<PagePtr> oldPages;
+        resetPages(oldPages);
+        for(int i=0;i<size();i++){
+            if(isHub(i) || cap[i] == 0){
+                page[i] = -1;
+                cap[i] = 0;
+                continue;
+            }
+            const int* from = &(*oldPages[page[i]])[0] + offset[i];
+            place(i, cap[i]);
+            if(count[i] > 0)
+                std::memcpy(slot(i), from, count[i] * sizeof(int));
+        }
+    }
+
+    /*!
+     * the number of ints allocated in the arena, including unused capacity
+     * and holes but not the neighbours of hubs
+     */
+    size_t allocated() const{
+        return nAllocated;
+    }
+
+    /*!
+     * the number of ints in holes left by relocated slots
+     */
+    size_t unused() const{
+        return holes;
+    }
+};
+
+}
+
+#endif /* ADJACENCYARENAH_ */
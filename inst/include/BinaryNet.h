@@ -8,9 +8,14 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <iterator>
+#include <algorithm>
 #include <Rcpp.h>
-#include "DirectedVertex.h"
-#include "UndirectedVertex.h"
+#include "Vertex.h"
+#include "AdjacencyArena.h"
+#include "DyadMissingness.h"
+#include "VertexAttributes.h"
+#include "Bits.h"
 #include "VarAttrib.h"
 #include "util.h"
 #include "ShallowCopyable.h"
@@ -23,13 +28,17 @@ namespace lolog {
 using namespace Rcpp;
 
 
-#ifdef _WIN32
-typedef unsigned __int64	unsigned64_t;
-#else
+template<class Engine>
+class BinaryNetEdgeIterator;
 
-typedef uint64_t			unsigned64_t;
+template<class Engine>
+class BinaryNet;
 
-#endif
+template<class Engine>
+void writeNetworkFile(BinaryNet<Engine>& net, const std::string& file);
+
+template<class Engine>
+boost::shared_ptr< BinaryNet<Engine> > readNetworkFile(const std::string& file);
 
 /*!
  * The network. the fundamental structure of this package. Takes Engine as
@@ -50,6 +59,7 @@ protected:
 public:
 
     typedef typename Engine::NeighborIterator NeighborIterator;
+    typedef BinaryNetEdgeIterator<Engine> EdgeIterator;
     /*!
      * constructor
      */
@@ -104,7 +114,9 @@ public:
     }
 
     /*!
-     * deep copy
+     * deep copy. The neighbours, missing dyads and vertex variables are
+     * shared with this network copy-on-write, so a clone only pays for the
+     * parts of the network that either copy later changes.
      *  \returns a deep copy of the network
      */
     boost::shared_ptr<BinaryNet<Engine> >  clone() const{
@@ -126,14 +138,14 @@ public:
      * remove a vertex
      */
     void removeVertex(int which){
-        engine.removeVertex();
+        engine.removeVertex(which);
     }
 
     /*!
      * permute the order of the nodes
      */
     void reorderVertices(std::vector<int> order){
-        engine.reorderVertices();
+        engine.reorderVertices(order);
     }
 
     /*!
@@ -189,6 +201,21 @@ public:
         engine.emptyGraph();
     }
 
+    /*!
+     * replaces all edges with those of a compressed sparse row adjacency,
+     * in O(n + m) for the sparse engines
+     *
+     * The (out) neighbours of vertex v are outNbrs[outStart[v]] to
+     * outNbrs[outStart[v + 1] - 1], in increasing order without repeats or
+     * loops. Undirected networks list each edge under both ends. Directed
+     * networks also give the in neighbours, which must be the transpose of
+     * the out neighbours. The lists are not checked.
+     */
+    void assignEdges(const int64_t* outStart, const int* outNbrs,
+            const int64_t* inStart = NULL, const int* inNbrs = NULL){
+        engine.assignEdges(outStart, outNbrs, inStart, inNbrs);
+    }
+
     /*!
      * adds an edge to a dyad if none exists, otherwise removes the edge.
      * \param from the id of the from node
@@ -226,6 +253,14 @@ public:
         return engine.nMissing(from);
     }
 
+    /*!
+     * appends the alters of the missing (out-)dyads of node from which are at
+     * least lo to out, in increasing order
+     */
+    void missingAlters(int from, std::vector<int>& out, int lo = 0) const{
+        engine.missingAlters(from, out, lo);
+    }
+
     /*!
      * set a  dyad's missingness
      * \param from the id of the from node
@@ -286,6 +321,22 @@ public:
     bool isDirected() const{
         return engine.isDirected();
     }
+    /*!
+     * are ties restricted to pairs of vertices in different modes.
+     */
+    bool isBipartite() const{
+        return engine.isBipartite();
+    }
+
+    /*!
+     * the number of vertices in the first mode of a bipartite network. Vertices
+     * 0 to firstModeSize() - 1 are in the first mode, the rest are in the second.
+     * The network size if not bipartite.
+     */
+    int firstModeSize() const{
+        return engine.firstModeSize();
+    }
+
     /*!
      * \returns the maximum number of edges possible
      */
@@ -422,6 +473,24 @@ public:
 		return engine.neighbors(which);
 	}
      */
+
+    /*!
+     * the number of neighbours shared by two nodes
+     * throws error for directed nets
+     */
+    int sharedNeighbors(int a,int b) const{
+        return engine.sharedNeighbors(a,b);
+    }
+
+    /*!
+     * the neighbours shared by two nodes, in increasing order
+     * throws error for directed nets
+     * \param out output, cleared first
+     */
+    void sharedNeighbors(int a,int b,std::vector<int>& out) const{
+        engine.sharedNeighbors(a,b,out);
+    }
+
     /*!
      * select a random dyad
      * \returns a pair of ids representing the dyad
@@ -470,6 +539,58 @@ public:
         return engine.edgelist();
     }
 
+    /*!
+     * Iterates over the edges in the order of edgelist(), reading the
+     * neighbour lists in place rather than copying them.
+     *
+     * \param firstVertex only edges whose first vertex is at least firstVertex
+     * \param lastVertex only edges whose first vertex is below lastVertex.
+     *        -1 for size().
+     */
+    EdgeIterator edgesBegin(int firstVertex = 0,int lastVertex = -1) const{
+        return EdgeIterator(*this, firstVertex, lastVertex < 0 ? size() : lastVertex);
+    }
+
+    /*!
+     * the end of the edges whose first vertex is below lastVertex. -1 for size().
+     */
+    EdgeIterator edgesEnd(int lastVertex = -1) const{
+        int last = lastVertex < 0 ? size() : lastVertex;
+        return EdgeIterator(*this, last, last);
+    }
+
+    /*!
+     * Splits the vertices into ranges holding roughly equal numbers of edges,
+     * for dividing the edges between threads (see parallelEdges)
+     *
+     * \param parts the number of ranges
+     * \returns parts + 1 vertex ids. Range i is [cuts[i], cuts[i + 1]).
+     */
+    std::vector<int> edgePartition(int parts) const{
+        int n = size();
+        parts = std::max(1, parts);
+        std::vector<int> cuts(parts + 1, n);
+        cuts[0] = 0;
+        double total = isDirected() ? nEdges() : 2.0 * nEdges();
+        double running = 0.0;
+        int part = 1;
+        for(int i=0;i<n && part < parts;i++){
+            running += isDirected() ? outdegree(i) : degree(i);
+            while(part < parts && running >= total * part / parts)
+                cuts[part++] = i + 1;
+        }
+        return cuts;
+    }
+
+    /*!
+     * Completes any deferred updates to the neighbour lists, which would
+     * otherwise be done on the first read. Call before reading the network
+     * from several threads.
+     */
+    void settle() const{
+        engine.settle();
+    }
+
 
 
     /*!
@@ -489,6 +610,15 @@ public:
         return engine.continVariableValue(which,at);
     }
 
+    /*!
+     * the values of a continuous variable, indexed by vertex id. Invalidated
+     * when vertices or variables are added or removed.
+     * \param which the variable index
+     */
+    const double* continVariableColumn(int which) const{
+        return engine.continVariableColumn(which);
+    }
+
     /*!
      * set a value of a continuous variable at a vertex
      * \param which the variable index
@@ -577,6 +707,15 @@ public:
         return engine.discreteVariableValue(which,at);
     }
 
+    /*!
+     * the values of a discrete variable, indexed by vertex id. Invalidated
+     * when vertices or variables are added or removed.
+     * \param which the variable index
+     */
+    const int* discreteVariableColumn(int which) const{
+        return engine.discreteVariableColumn(which);
+    }
+
     /*!
      * set a value of a discrete variable at a vertex
      * \param which the variable index
@@ -688,6 +827,14 @@ public:
      */
     BinaryNet(Rcpp::IntegerMatrix edgeList,int numNodes) : engine(edgeList,numNodes){}
 
+    /*!
+     * construct a two mode network from an edgelist. Bipartite engines only.
+     * \param edgeList the edgelist
+     * \param nFirst the number of nodes in the first mode
+     * \param nSecond the number of nodes in the second mode
+     */
+    BinaryNet(Rcpp::IntegerMatrix edgeList,int nFirst,int nSecond) : engine(edgeList,nFirst,nSecond){}
+
     /*!
      * deep copy
      *  \returns an R Reference Class deep copy of the network
@@ -696,6 +843,20 @@ public:
         return wrap(BinaryNet(*this,true));
     }
 
+    /*!
+     * writes the network to file in the binary network format (see NetworkFile.h)
+     */
+    void saveFileR(std::string file){
+        writeNetworkFile(*this, file);
+    }
+
+    /*!
+     * replaces the network with one read from a binary network file
+     */
+    void loadFileR(std::string file){
+        *this = *readNetworkFile<Engine>(file);
+    }
+
     /*!
      * sets the specified dyads to the supplied values
      *
@@ -1058,28 +1219,162 @@ public:
 };
 
 
+/*!
+ * A forward iterator over the edges of a BinaryNet, in the order of
+ * edgelist(), reading the neighbour lists of the network in place. For
+ * undirected networks, each edge is visited once with first < second.
+ *
+ * Invalidated by any change to the network.
+ */
+template<class Engine>
+class BinaryNetEdgeIterator{
+protected:
+    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    const BinaryNet<Engine>* net;
+    int last;                   /*!< one past the last vertex visited */
+    NeighborIterator it;
+    NeighborIterator itEnd;
+    std::pair<int,int> edge;    /*!< edge.first is the current vertex */
+
+    //positions it at the neighbours of edge.first which follow it in the edge list
+    void load(){
+        if(net->isDirected()){
+            it = net->outBegin(edge.first);
+            itEnd = net->outEnd(edge.first);
+        }else{
+            itEnd = net->end(edge.first);
+            it = std::lower_bound(net->begin(edge.first), itEnd, edge.first + 1);
+        }
+    }
+
+    //moves to the next vertex with an edge, if the current one has none left
+    void seek(){
+        while(it == itEnd){
+            edge.first++;
+            if(edge.first >= last){
+                edge.first = last;
+                return;
+            }
+            load();
+        }
+        edge.second = *it;
+    }
+
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef std::pair<int,int> value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const std::pair<int,int>* pointer;
+    typedef const std::pair<int,int>& reference;
+
+    BinaryNetEdgeIterator() : net(NULL), last(0), edge(0, -1){}
+
+    /*!
+     * the first edge whose first vertex is in [first, last)
+     */
+    BinaryNetEdgeIterator(const BinaryNet<Engine>& network,int first,int lastVertex) :
+        net(&network), last(lastVertex), edge(first, -1){
+        if(first >= last){
+            edge.first = last;
+            return;
+        }
+        load();
+        seek();
+    }
+
+    reference operator*() const{
+        return edge;
+    }
+
+    pointer operator->() const{
+        return &edge;
+    }
+
+    BinaryNetEdgeIterator& operator++(){
+        it++;
+        seek();
+        return *this;
+    }
+
+    BinaryNetEdgeIterator operator++(int){
+        BinaryNetEdgeIterator tmp = *this;
+        ++(*this);
+        return tmp;
+    }
+
+    bool operator==(const BinaryNetEdgeIterator& other) const{
+        if(edge.first != other.edge.first)
+            return false;
+        return edge.first == last || it == other.it;
+    }
+
+    bool operator!=(const BinaryNetEdgeIterator& other) const{
+        return !(*this == other);
+    }
+};
+
+
+/*!
+ * Divides the edges of net between (at most) nThreads threads, calling
+ * fn(thread, begin, end) with each thread's range of edges (see
+ * BinaryNet::edgePartition). The ranges follow one another in the order of
+ * edgelist(). fn must not call the R API or change the network.
+ */
+template<class Engine, class Fn>
+void parallelEdges(const BinaryNet<Engine>& net, int nThreads, Fn fn){
+    int parts = std::max(1, std::min(nThreads, net.nEdges()));
+    std::vector<int> cuts = net.edgePartition(parts);
+    if(parts > 1)
+        net.settle();
+    parallelRanges(parts, parts, [&](int t, int begin, int end){
+        fn(t, net.edgesBegin(cuts[t], cuts[t + 1]), net.edgesEnd(cuts[t + 1]));
+    });
+}
+
+/*!
+ * The sum of fn(from, to) over the edges of net, computed with per-thread
+ * partial sums. fn must not call the R API or change the network.
+ */
+template<class Engine, class Fn>
+double parallelEdgeSum(const BinaryNet<Engine>& net, int nThreads, Fn fn){
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
+    std::vector<double> partial(std::max(1, std::min(nThreads, net.nEdges())), 0.0);
+    parallelEdges(net, nThreads, [&](int t, EdgeIterator it, EdgeIterator end){
+        double sum = 0.0;
+        for(;it != end;it++)
+            sum += fn(it->first, it->second);
+        partial[t] = sum;
+    });
+    double result = 0.0;
+    for(int t=0;t<partial.size();t++)
+        result += partial[t];
+    return result;
+}
+
+
 
 class Directed{
 protected:
-    typedef DirectedVertex VertType;
-    typedef boost::shared_ptr<VertType> vertPtr;
     typedef boost::shared_ptr< std::vector<ContinAttrib> > cAttrVecPtr;
     typedef boost::shared_ptr< std::vector<DiscreteAttrib> > dAttrVecPtr;
-    std::vector< vertPtr > verts;
+    typedef boost::shared_ptr<AdjacencyArena> ArenaPtr;
+    typedef boost::shared_ptr<DyadMissingness> MissingPtr;
+    typedef boost::shared_ptr<VertexAttributes> AttribPtr;
+    ArenaPtr outEdges;      /*!< the out neighbours of each vertex */
+    ArenaPtr inEdges;       /*!< the in neighbours of each vertex */
+    MissingPtr missing;     /*!< the missing out dyads of each vertex */
+    AttribPtr attributes;   /*!< the vertex variables, by column */
     cAttrVecPtr contMeta;
     dAttrVecPtr disMeta;
     boost::shared_ptr<double> numEdges;
-    void refreshIds(){
-        for(int i=0;i<verts.size();i++)
-            verts[i]->setId(i);
-    }
 
 public:
 
-    typedef Set::const_iterator NeighborIterator;
+    typedef const int* NeighborIterator;
 
 
-    Directed(){
+    Directed() : outEdges(new AdjacencyArena()), inEdges(new AdjacencyArena()),
+        missing(new DyadMissingness()), attributes(new VertexAttributes()){
         cAttrVecPtr cm(new std::vector<ContinAttrib>());
         dAttrVecPtr dm(new std::vector<DiscreteAttrib>());
         contMeta=cm;
@@ -1089,27 +1384,40 @@ public:
     }
 
     Directed(const Directed& net){
-        verts = net.verts;
+        outEdges = net.outEdges;
+        inEdges = net.inEdges;
+        missing = net.missing;
+        attributes = net.attributes;
+        contMeta = net.contMeta;
+        disMeta = net.disMeta;
+        numEdges = net.numEdges;
+    }
+
+    Directed& operator=(const Directed& net){
+        outEdges = net.outEdges;
+        inEdges = net.inEdges;
+        missing = net.missing;
+        attributes = net.attributes;
         contMeta = net.contMeta;
         disMeta = net.disMeta;
         numEdges = net.numEdges;
+        return *this;
     }
 
     Directed(const Directed& net,bool deepCopy){
         if(!deepCopy){
-            verts = net.verts;
+            outEdges = net.outEdges;
+            inEdges = net.inEdges;
+            missing = net.missing;
+            attributes = net.attributes;
             contMeta = net.contMeta;
             disMeta = net.disMeta;
             numEdges = net.numEdges;
         }else{
-            verts.clear();
-            verts.resize(net.verts.size());
-            //cout << verts.size()<<"\n"<<net.contMeta<<" "<<net.disMeta;
-            //cout << net.verts.size()<<"\n";
-            for(int i=0;i<net.verts.size();i++){
-                vertPtr v(new VertType(*(net.verts.at(i))));
-                verts[i] = v;
-            }
+            outEdges = ArenaPtr(new AdjacencyArena(*net.outEdges));
+            inEdges = ArenaPtr(new AdjacencyArena(*net.inEdges));
+            missing = MissingPtr(new DyadMissingness(*net.missing));
+            attributes = AttribPtr(new VertexAttributes(*net.attributes));
             cAttrVecPtr cm(new std::vector<ContinAttrib>(*net.contMeta));
             dAttrVecPtr dm(new std::vector<DiscreteAttrib>(*net.disMeta));
             contMeta = cm;
@@ -1119,14 +1427,12 @@ public:
         }
     }
 
-    Directed(Rcpp::IntegerMatrix edgeList,int numNodes){
-        for(int i=0;i<numNodes;i++){
-            vertPtr ver(new DirectedVertex(numNodes));
-            verts.push_back(ver);
-        }
+    Directed(Rcpp::IntegerMatrix edgeList,int numNodes) :
+        outEdges(new AdjacencyArena(std::max(0, numNodes))), inEdges(new AdjacencyArena(std::max(0, numNodes))),
+        missing(new DyadMissingness(std::max(0, numNodes))),
+        attributes(new VertexAttributes(std::max(0, numNodes))){
         numEdges = boost::shared_ptr<double>(new double);
         (*numEdges) = 0.0;
-        refreshIds();
         for(int i=0;i<edgeList.nrow();i++){
             //cout<< *numEdges <<" \n "<<this->hasEdge(edgeList(i,0)-1,edgeList(i,1)-1);
             int from = edgeList(i,0)-1;
@@ -1148,118 +1454,112 @@ public:
     }
 
     void addVertex(){
-        vertPtr pv(new VertType(size()+1));
-        pv->setId(verts.size());
-        //TODO: make vetex variable length match
-        verts.push_back(pv);
-        for(int i=0;i<size();i++){
-            verts[i]->setNetworkSize(size());
-        }
+        outEdges->addVertex();
+        inEdges->addVertex();
+        missing->addVertex();
+        attributes->addVertex();
     }
 
 
     void removeVertex(int pos){
-        vertPtr pV = verts.at(pos);
-        verts.erase(verts.begin() + pos);
-        refreshIds();
-        (*numEdges) -= pV->indegree();
-        (*numEdges) -= pV->outdegree();
-        //TODO: correct sets to reflect new ids
-        for(int i=0;i<size();i++){
-            verts[i]->setNetworkSize(size());
-        }
+        (*numEdges) -= inEdges->degree(pos);
+        (*numEdges) -= outEdges->degree(pos);
+        outEdges->removeVertex(pos);
+        inEdges->removeVertex(pos);
+        missing->removeVertex(pos);
+        attributes->removeVertex(pos);
     }
 
     void reorderVertices(std::vector<int> order){
-        std::vector<vertPtr> tmp = verts;
-        for(int i=0;i<verts.size();i++)
-            verts[i] = tmp[order[i]];
-        //TODO correct sets to reflect new ids
+        outEdges->relabel(order);
+        inEdges->relabel(order);
+        missing->relabel(order);
+        attributes->relabel(order);
     }
 
     int size() const{
-        return verts.size();
+        return outEdges->size();
     }
 
     bool hasEdge(int from, int to) const{
-        return verts[from]->hasOutedge(to);
+        return outEdges->contains(from, to);
+    }
+
+    void settle() const{
+        outEdges->settle();
+        inEdges->settle();
     }
 
     bool removeEdge(int from,int to){
         bool has = false;
-        has = verts[from]->removeOutedge(to);
+        has = outEdges->erase(from, to);
         if(has){
-            verts[to]->removeInedge(from);
+            inEdges->erase(to, from);
             (*numEdges)--;
         }
         return has;
     }
 
     void emptyGraph(){
-        for(int i=0;i < verts.size();i++){
-            verts[i]->clearOutedges();
-            verts[i]->clearInedges();
-        }
+        outEdges->clearAll();
+        inEdges->clearAll();
         (*numEdges) = 0;
     }
 
+    void assignEdges(const int64_t* outStart, const int* outNbrs,
+            const int64_t* inStart, const int* inNbrs){
+        outEdges->assign(outStart, outNbrs);
+        inEdges->assign(inStart, inNbrs);
+        (*numEdges) = outStart[size()];
+    }
+
     void addEdge(int from,int to){
         if(from==to)
             return;
-        if(verts[from]->addOutedge(to)){
-            verts[to]->addInedge(from);
+        if(outEdges->insert(from, to)){
+            inEdges->insert(to, from);
             (*numEdges)++;
         }
 
     }
 
     bool isMissing(int from,int to) const{
-        return verts[from]->isOutmissing(to);
+        return missing->isMissing(from, to);
     }
 
     int nMissing(int from) const{
-        return verts[from]->nMissing();
+        return missing->nMissing(from);
     }
 
+    void missingAlters(int from, std::vector<int>& out, int lo) const{
+        missing->missingAlters(from, out, lo);
+    }
 
-    bool setMissing(int from,int to, bool value){
-        if(from==to)
-            return false;
-        return verts[from]->setOutmissing(to,value);
 
+    bool setMissing(int from,int to, bool value){
+        return missing->setMissing(from, to, value);
     }
 
     void setAllDyadsMissing(){
-        for(int i=0;i<size();i++){
-            verts[i]->setAllMissing();
-        }
+        missing->setAll(true);
     }
     void setAllDyadsObserved(){
-        for(int i=0;i<size();i++){
-            verts[i]->setAllObserved();
-        }
+        missing->setAll(false);
     }
 
-    void setAllDyadsMissing(std::vector<int> nodes,bool missing){
-        if(missing){
-            for(int i=0;i<nodes.size();i++){
-                verts[nodes[i]]->setAllMissing();
-            }
-        }else{
-            for(int i=0;i<nodes.size();i++){
-                verts[nodes[i]]->setAllObserved();
-            }
-        }
+    void setAllDyadsMissing(std::vector<int> nodes,bool miss){
+        for(int i=0;i<nodes.size();i++)
+            missing->setRow(nodes[i], miss);
     }
 
     boost::shared_ptr< std::vector< std::pair<int,int> > > missingDyads() const{
-        Set s;
         boost::shared_ptr< std::vector< std::pair<int,int> > > vec(new std::vector< std::pair<int,int> >);
+        std::vector<int> alters;
         for(int i=0;i<size();i++){
-            s = verts[i]->outmissing();
-            for(Set::iterator it = s.begin();it!=s.end();it++){
-                vec->push_back(std::make_pair(i,*it));
-            }
+            alters.clear();
+            missing->missingAlters(i, alters);
+            for(int k=0;k<alters.size();k++)
+                vec->push_back(std::make_pair(i, alters[k]));
         }
         return vec;
     }
@@ -1272,48 +1572,46 @@ public:
         return true;
     }
 
+    bool isBipartite() const{
+        return false;
+    }
+
+    int firstModeSize() const{
+        return size();
+    }
+
     int indegree(int which) const{
-        return verts[which]->indegree();
+        return inEdges->degree(which);
     }
 
     template<class Collection>
     Collection inneighbors(int which) const{
-        //Set s = verts[which]->inedges();
-        return Collection(verts[which]->inedges().begin(),verts[which]->inedges().end());
+        return Collection(inEdges->begin(which),inEdges->end(which));
     }
 
     NeighborIterator inBegin(int which) const{
-        return verts[which]->inedges().begin();
+        return inEdges->begin(which);
     }
 
     NeighborIterator inEnd(int which) const{
-        return verts[which]->inedges().end();
-    }
-
-    const Set& inneighbors(int which) const{
-        return verts[which]->inedges();
+        return inEdges->end(which);
     }
 
     int outdegree(int which) const{
-        return verts[which]->outdegree();
+        return outEdges->degree(which);
     }
 
     template<class Collection>
     Collection outneighbors(int which) const{
-        //Set s = verts[which]->outedges();
-        return Collection(verts[which]->outedges().begin(),verts[which]->outedges().end());
+        return Collection(outEdges->begin(which),outEdges->end(which));
     }
 
     NeighborIterator outBegin(int which) const{
-        return verts[which]->outedges().begin();
+        return outEdges->begin(which);
     }
 
     NeighborIterator outEnd(int which) const{
-        return verts[which]->outedges().end();
-    }
-
-    const Set& outneighbors(int which) const{
-        return verts[which]->outedges();
+        return outEdges->end(which);
     }
 
     int degree(int which) const{
@@ -1323,10 +1621,12 @@ public:
 
     NeighborIterator begin(int which) const{
         ::Rf_error("begin not meaningful for directed networks");
+        return NULL;
     }
 
     NeighborIterator end(int which) const{
         ::Rf_error("end not meaningful for directed networks");
+        return NULL;
     }
 
     template<class Collection>
@@ -1334,9 +1634,13 @@ public:
         ::Rf_error("neighbors not meaningful for directed networks");
     }
 
-    const Set& neighbors(int which) const{
-        ::Rf_error("neighbors not meaningful for directed networks");
-        return verts[which]->inedges();
+    int sharedNeighbors(int a,int b) const{
+        ::Rf_error("sharedNeighbors not meaningful for directed networks");
+        return -1;
+    }
+
+    void sharedNeighbors(int a,int b,std::vector<int>& out) const{
+        ::Rf_error("sharedNeighbors not meaningful for directed networks");
     }
 
     std::pair<int,int> randomDyad() const{
@@ -1366,75 +1670,39 @@ public:
         int n= this->nEdges();
         if(n==0)
             ::Rf_error("randomEdge: network has no edges");
-        int c=0;
-        int edgeNumber = floor(Rf_runif(0,(double)n));
-        int degree;
-        for(int i=0;i<verts.size();i++){
-            degree = verts[i]->outdegree();
-            if(c+degree > edgeNumber){
-                const Set* edges = &verts[i]->outedges();
-                Set::const_iterator it = edges->begin();
-                std::advance(it,edgeNumber-c);
-                int to = *(it);
-                return std::make_pair(i,to);
-            }
-            c += degree;
-        }
-        //cout << "edge: "<<edgeNumber<<" total edges: "<<n<<" c:"<<c<<"\n";
-        ::Rf_error("randomEdge: edge not found. ");
-        return std::pair<int,int>(-1,-1);
+        int64_t offset;
+        int64_t edgeNumber = std::min((int64_t) floor(Rf_runif(0,(double)n)), (int64_t) n - 1);
+        int from = outEdges->degrees().findEdge(edgeNumber, offset);
+        return std::make_pair(from, outEdges->begin(from)[offset]);
     }
 
-    int randomDyad(int from,bool missing){
-        if(!missing){
+    int randomDyad(int from,bool miss){
+        if(!miss){
             int index = floor(Rf_runif(0,size()-1.0));
             if(index>=from)
                 index++;
             return index;
         }else
-            return verts[from]->randomMissingDyad();
+            return missing->randomMissing(from);
     }
 
     std::pair<int,int> randomNonEdge() const{
-        ::Rf_error("randomNonEdge unimplemented ");
-
-        //the following only works if set is used, not hashSet
-        /*		int n= this->nEdges();
-		int nVerts = this->size();
-		int m= this->maxEdges();
-		int c=0;
-		int nonEdgeNumber = floor(Rf_runif(0,(double)(m-n)));
-		int degree;
-		for(int i=0;i<verts.size();i++){
-			degree = verts[i]->outdegree();
-			if(c+(nVerts-degree) < nonEdgeNumber){
-				//find the nth (which) non-edge of vertex i
-				int which = nonEdgeNumber - c;
-				Set::iterator currentEdge = verts[i]->outedges().begin();
-				Set::iterator end = verts[i]->outedges().end();
-				while(currentEdge!=end){
-					if(which<(*currentEdge)){
-						return std::make_pair(i,which);
-					}else{
-						which++;
-						currentEdge++;
-					}
-				}
-				return std::make_pair(i,which);
-			}
-			c += (nVerts-degree);
-		}
-		::Rf_error("randomNonEdge: dyad not found");
-         */return std::pair<int,int>(-1,-1);
+        int64_t n = size();
+        int64_t nonEdges = n * (n - 1) - nEdges();
+        if(nonEdges <= 0)
+            ::Rf_error("randomNonEdge: network is complete");
+        int64_t offset;
+        int64_t dyadNumber = std::min((int64_t) floor(Rf_runif(0,(double)nonEdges)), nonEdges - 1);
+        int from = outEdges->degrees().findNonEdge(dyadNumber, n - 1, offset);
+        return std::make_pair(from, outEdges->nthNonNeighbour(from, offset, 0, n));
     }
 
 
     boost::shared_ptr< std::vector< std::pair<int,int> > > edgelist() const{
         boost::shared_ptr< std::vector< std::pair<int,int> > > v(new std::vector<std::pair<int,int> >());
         v->reserve(nEdges());
-        for(int i=0;i<verts.size();i++){
-            const Set* out = &(verts[i]->outedges());
-            for(Set::const_iterator it = out->begin();it!=out->end();it++){
+        for(int i=0;i<size();i++){
+            for(NeighborIterator it = outBegin(i);it!=outEnd(i);it++){
                 std::pair<int,int> p = std::make_pair(i,*it);
                 //cout << p.first << " " << p.second<<"\n";
                 v->push_back(p);
@@ -1478,43 +1746,43 @@ public:
     }
 
     double continVariableValue(int which,int at) const{
-        return verts[at]->continVariable(which);
+        return attributes->continValue(which, at);
+    }
+
+    const double* continVariableColumn(int which) const{
+        return attributes->continColumn(which);
     }
 
     void setContinVariableValue(int which,int at,double newValue){
-        verts[at]->setContinVariable(newValue, which);
+        attributes->setContinValue(which, at, newValue);
     }
 
 
     bool continVariableObserved(int which,int at){
-        return verts[at]->continObserved(which);
+        return attributes->continObserved(which, at);
     }
 
     std::vector<bool> continVariableObserved(int which){
         std::vector<bool> obs(size(),false);
         for(int i=0;i<size();i++){
-            obs[i] = verts[i]->continObserved(which);
+            obs[i] = attributes->continObserved(which, i);
         }
         return obs;
     }
 
 
     void setContinVariableObserved(int which,int at,bool observed){
-        verts[at]->setContinObserved(which,observed);
+        attributes->setContinObserved(which, at, observed);
     }
 
     void removeContinVariable(int which){
         contMeta->erase(contMeta->begin()+which);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->removeContinVariable(which);
-        }
+        attributes->removeContinVariable(which);
     }
 
     void addContinVariable(const std::vector<double>& vals,ContinAttrib& attribs){
         contMeta->push_back(attribs);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->addContinVariable(vals[i]);
-        }
+        attributes->addContinVariable(vals);
     }
 
     std::vector<std::string> discreteVarNames() const{
@@ -1530,61 +1798,59 @@ public:
 
     void removeDiscreteVariable(int which){
         disMeta->erase(disMeta->begin()+which);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->removeDiscreteVariable(which);
-        }
+        attributes->removeDiscreteVariable(which);
     }
 
     std::vector<int> discreteVariableValues(int which) const{
-        std::vector<int> v(verts.size(),0);
-        for(int i=0;i<verts.size();i++)
-            v[i] = verts[i]->discreteVariable(which);
-        return v;
+        const int* col = attributes->discreteColumn(which);
+        return col == NULL ? std::vector<int>() : std::vector<int>(col, col + size());
     }
 
     int discreteVariableValue(int which,int at) const{
-        return verts[at]->discreteVariable(which);
+        return attributes->discreteValue(which, at);
+    }
+
+    const int* discreteVariableColumn(int which) const{
+        return attributes->discreteColumn(which);
     }
 
     void setDiscreteVariableValue(int which,int at,int newValue){
-        verts[at]->setDiscreteVariable(newValue,which);
+        attributes->setDiscreteValue(which, at, newValue);
     }
 
     std::string discreteVariableLabel(int which,int at) const{
-        return disMeta->at(which).labels().at(verts[at]->discreteVariable(which));
+        return disMeta->at(which).labels().at(attributes->discreteValue(which, at));
     }
 
     std::vector<std::string> discreteVariable(int which) const{
-        std::vector<std::string> v(verts.size(),"");
-        for(int i=0;i<verts.size();i++)
-            v[i] = disMeta->at(which).labels().at(verts[i]->discreteVariable(which)-1);
+        std::vector<std::string> v(size(),"");
+        for(int i=0;i<size();i++)
+            v[i] = disMeta->at(which).labels().at(attributes->discreteValue(which, i)-1);
         return v;
     }
 
 
     void addDiscreteVariable(const std::vector<int>& vals,DiscreteAttrib& attribs){
         disMeta->push_back(attribs);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->addDiscreteVariable(vals[i]);
-        }
+        attributes->addDiscreteVariable(vals);
     }
 
     bool discreteVariableObserved(int which,int at){
-        return verts[at]->discreteObserved(which);
+        return attributes->discreteObserved(which, at);
     }
 
 
     std::vector<bool> discreteVariableObserved(int which){
         std::vector<bool> obs(size(),false);
         for(int i=0;i<size();i++){
-            obs[i] = verts[i]->discreteObserved(which);
+            obs[i] = attributes->discreteObserved(which, i);
         }
         return obs;
     }
 
 
     void setDiscreteVariableObserved(int which,int at,bool observed){
-        verts[at]->setDiscreteObserved(which,observed);
+        attributes->setDiscreteObserved(which, at, observed);
     }
 
     void addDiscreteVariableR(SEXP robj,std::string name){
@@ -1724,7 +1990,7 @@ public:
     }
 
     unsigned64_t maxEdges() const{
-        unsigned64_t n = verts.size();
+        unsigned64_t n = size();
         return n*(n-1);
     }
 
@@ -1738,28 +2004,27 @@ typedef BinaryNet<Directed> DirectedNet;
 
 class Undirected{
 protected:
-    typedef UndirectedVertex VertType;
-    typedef boost::shared_ptr<VertType> vertPtr;
     typedef boost::shared_ptr< std::vector<ContinAttrib> > cAttrVecPtr;
     typedef boost::shared_ptr< std::vector<DiscreteAttrib> > dAttrVecPtr;
-    std::vector< vertPtr > verts;
+    typedef boost::shared_ptr<AdjacencyArena> ArenaPtr;
+    typedef boost::shared_ptr<DyadMissingness> MissingPtr;
+    typedef boost::shared_ptr<VertexAttributes> AttribPtr;
+    ArenaPtr edges;         /*!< the neighbours of each vertex */
+    MissingPtr missing;     /*!< the missing dyads, held in both directions */
+    AttribPtr attributes;   /*!< the vertex variables, by column */
     cAttrVecPtr contMeta;
     dAttrVecPtr disMeta;
     boost::shared_ptr<double> numEdges;
-    void refreshIds(){
-        for(int i=0;i<verts.size();i++)
-            verts[i]->setId(i);
-    }
 
 public:
 
-    typedef Set::const_iterator NeighborIterator;
+    typedef const int* NeighborIterator;
 
     NeighborIterator getBeginIterator(int node){
-        return verts[node]->edges().begin();
+        return edges->begin(node);
     }
 
-    Undirected(){
+    Undirected() : edges(new AdjacencyArena()), missing(new DyadMissingness()), attributes(new VertexAttributes()){
         cAttrVecPtr cm(new std::vector<ContinAttrib>());
         dAttrVecPtr dm(new std::vector<DiscreteAttrib>());
         contMeta=cm;
@@ -1769,27 +2034,36 @@ public:
     }
 
     Undirected(const Undirected& net){
-        verts = net.verts;
+        edges = net.edges;
+        missing = net.missing;
+        attributes = net.attributes;
         contMeta = net.contMeta;
         disMeta = net.disMeta;
         numEdges = net.numEdges;
     }
 
+    Undirected& operator=(const Undirected& net){
+        edges = net.edges;
+        missing = net.missing;
+        attributes = net.attributes;
+        contMeta = net.contMeta;
+        disMeta = net.disMeta;
+        numEdges = net.numEdges;
+        return *this;
+    }
+
     Undirected(const Undirected& net,bool deepCopy){
         if(!deepCopy){
-            verts = net.verts;
+            edges = net.edges;
+            missing = net.missing;
+            attributes = net.attributes;
             contMeta = net.contMeta;
             disMeta = net.disMeta;
             numEdges = net.numEdges;
         }else{
-            verts.clear();
-            verts.resize(net.verts.size());
-            //cout << verts.size()<<"\n"<<net.contMeta<<" "<<net.disMeta;
-            //cout << net.verts.size()<<"\n";
-            for(int i=0;i<net.verts.size();i++){
-                vertPtr v(new VertType(*(net.verts.at(i))));
-                verts[i] = v;
-            }
+            edges = ArenaPtr(new AdjacencyArena(*net.edges));
+            missing = MissingPtr(new DyadMissingness(*net.missing));
+            attributes = AttribPtr(new VertexAttributes(*net.attributes));
             cAttrVecPtr cm(new std::vector<ContinAttrib>(*net.contMeta));
             dAttrVecPtr dm(new std::vector<DiscreteAttrib>(*net.disMeta));
             contMeta = cm;
@@ -1799,14 +2073,11 @@ public:
         }
     }
 
-    Undirected(Rcpp::IntegerMatrix edgeList,int numNodes){
-        for(int i=0;i<numNodes;i++){
-            vertPtr ver(new UndirectedVertex(numNodes));
-            verts.push_back(ver);
-        }
+    Undirected(Rcpp::IntegerMatrix edgeList,int numNodes) : edges(new AdjacencyArena(std::max(0, numNodes))),
+        missing(new DyadMissingness(std::max(0, numNodes))),
+        attributes(new VertexAttributes(std::max(0, numNodes))){
         numEdges = boost::shared_ptr<double>(new double);
         (*numEdges) = 0.0;
-        refreshIds();
         for(int i=0;i<edgeList.nrow();i++){
             //cout<< *numEdges <<" \n "<<this->hasEdge(edgeList(i,0)-1,edgeList(i,1)-1);
             int from = edgeList(i,0)-1;
@@ -1828,132 +2099,120 @@ public:
     }
 
     void addVertex(){
-        vertPtr pv(new VertType(size()+1));
-        pv->setId(verts.size());
-        //TODO: make vetex variable length match
-        verts.push_back(pv);
-        for(int i=0;i<size();i++){
-            verts[i]->setNetworkSize(size());
-        }
+        edges->addVertex();
+        missing->addVertex();
+        attributes->addVertex();
+        //vertices with all dyads missing are missing with the new one
+        int last = size() - 1;
+        for(int i=0;i<last;i++)
+            if(missing->isMissing(i, last))
+                missing->setMissing(last, i, true);
     }
 
 
     void removeVertex(int pos){
-        vertPtr pV = verts.at(pos);
-        verts.erase(verts.begin() + pos);
-        refreshIds();
-        (*numEdges) -= pV->degree();
-        //TODO: correct sets to reflect new ids
-        for(int i=0;i<size();i++){
-            verts[i]->setNetworkSize(size());
-        }
+        (*numEdges) -= edges->degree(pos);
+        edges->removeVertex(pos);
+        missing->removeVertex(pos);
+        attributes->removeVertex(pos);
     }
 
     void reorderVertices(std::vector<int> order){
-        std::vector<vertPtr> tmp = verts;
-        for(int i=0;i<verts.size();i++)
-            verts[i] = tmp[order[i]];
+        edges->relabel(order);
+        missing->relabel(order);
+        attributes->relabel(order);
     }
 
     int size() const{
-        return verts.size();
+        return edges->size();
     }
 
     bool hasEdge(int from, int to) const{
-        return verts[from]->hasEdge(to);
+        return edges->contains(from, to);
+    }
+
+    void settle() const{
+        edges->settle();
     }
 
     bool removeEdge(int from,int to){
         bool has = false;
-        has = verts[from]->removeEdge(to);
+        has = edges->erase(from, to);
         if(has){
-            verts[to]->removeEdge(from);
+            edges->erase(to, from);
             (*numEdges)--;
         }
         return has;
     }
 
     void emptyGraph(){
-        for(int i=0;i < verts.size();i++){
-            verts[i]->clearEdges();
-        }
+        edges->clearAll();
         (*numEdges) = 0;
     }
 
+    void assignEdges(const int64_t* outStart, const int* outNbrs,
+            const int64_t* inStart, const int* inNbrs){
+        edges->assign(outStart, outNbrs);
+        (*numEdges) = outStart[size()] / 2;
+    }
+
     void addEdge(int from,int to){
         if(from==to)
             return;
-        if(verts[from]->addEdge(to)){
-            verts[to]->addEdge(from);
+        if(edges->insert(from, to)){
+            edges->insert(to, from);
             (*numEdges)++;
         }
 
     }
 
     bool isMissing(int from,int to) const{
-        return verts[from]->isMissing(to);
+        return missing->isMissing(from, to);
     }
 
     int nMissing(int from) const{
-        return verts[from]->nMissing();
+        return missing->nMissing(from);
+    }
+
+    void missingAlters(int from, std::vector<int>& out, int lo) const{
+        missing->missingAlters(from, out, lo);
     }
 
     bool setMissing(int from,int to, bool value){
-        if(from==to)
-            return false;
-        bool wasMissing;
-        if(value){
-            wasMissing = verts[from]->setMissing(to,true);
-            if(!wasMissing)
-                verts[to]->setMissing(from,true);
-        }else{
-            wasMissing = verts[from]->setMissing(to,false);
-            if(wasMissing)
-                verts[to]->setMissing(from,false);
-        }
+        bool wasMissing = missing->setMissing(from, to, value);
+        missing->setMissing(to, from, value);
         return wasMissing;
     }
 
 
     void setAllDyadsMissing(){
-        for(int i=0;i<size();i++){
-            verts[i]->setAllMissing();
-        }
+        missing->setAll(true);
     }
 
     void setAllDyadsObserved(){
-        for(int i=0;i<size();i++){
-            verts[i]->setAllObserved();
-        }
+        missing->setAll(false);
     }
 
-    void setAllDyadsMissing(std::vector<int> nodes,bool missing){
-        if(missing){
-            for(int i=0;i<nodes.size();i++){
-                verts[nodes[i]]->setAllMissing();
-                for(int j=0;j<size();j++)
-                    if(j!=nodes[i])
-                        verts[j]->setMissing(nodes[i],true);
-            }
-        }else{
-            for(int i=0;i<nodes.size();i++){
-                verts[nodes[i]]->setAllObserved();
-                for(int j=0;j<size();j++)
-                    if(j!=nodes[i])
-                        verts[j]->setMissing(nodes[i],false);
-            }
+    void setAllDyadsMissing(std::vector<int> nodes,bool miss){
+        for(int i=0;i<nodes.size();i++)
+            missing->setRow(nodes[i], miss);
+        //the other side of each dyad, skipping rows that are already all missing
+        for(int j=0;j<size();j++){
+            if(miss && missing->nMissing(j) == size() - 1)
+                continue;
+            for(int i=0;i<nodes.size();i++)
+                missing->setMissing(j, nodes[i], miss);
         }
     }
 
     boost::shared_ptr< std::vector< std::pair<int,int> > > missingDyads() const{
-        Set s;
         boost::shared_ptr< std::vector< std::pair<int,int> > > vec(new std::vector< std::pair<int,int> >);
+        std::vector<int> alters;
         for(int i=0;i<size();i++){
-            s = verts[i]->missing();
-            for(Set::iterator it = s.begin();it!=s.end();it++){
-                if(*it>i)
-                    vec->push_back(std::make_pair(i,*it));
-            }
+            alters.clear();
+            missing->missingAlters(i, alters, i + 1);
+            for(int k=0;k<alters.size();k++)
+                vec->push_back(std::make_pair(i, alters[k]));
         }
         return vec;
     }
@@ -1966,6 +2225,14 @@ public:
         return false;
     }
 
+    bool isBipartite() const{
+        return false;
+    }
+
+    int firstModeSize() const{
+        return size();
+    }
+
     int indegree(int which) const{
         ::Rf_error("indegree not meaningful for undirected networks");
         return -1;
@@ -1978,15 +2245,12 @@ public:
 
     NeighborIterator inBegin(int which) const{
         ::Rf_error("degree not meaningful for directed networks");
+        return NULL;
     }
 
     NeighborIterator inEnd(int which) const{
         ::Rf_error("degree not meaningful for directed networks");
-    }
-
-    const Set& inneighbors(int which) const{
-        ::Rf_error("inneighbors not meaningful for undirected networks");
-
+        return NULL;
     }
 
     int outdegree(int which) const{
@@ -2001,37 +2265,62 @@ public:
 
     NeighborIterator outBegin(int which) const{
         ::Rf_error("degree not meaningful for directed networks");
+        return NULL;
     }
 
     NeighborIterator outEnd(int which) const{
         ::Rf_error("degree not meaningful for directed networks");
-    }
-
-
-    const Set& outneighbors(int which) const{
-        ::Rf_error("outneighbors not meaningful for undirected networks");
-
+        return NULL;
     }
 
     int degree(int which) const{
-        return verts[which]->degree();
+        return edges->degree(which);
     }
 
     template<class Collection>
     Collection neighbors(int which) const{
-        return Collection(verts[which]->edges().begin(),verts[which]->edges().end());
+        return Collection(edges->begin(which),edges->end(which));
     }
 
     NeighborIterator begin(int which) const{
-        return verts[which]->edges().begin();
+        return edges->begin(which);
     }
 
     NeighborIterator end(int which) const{
-        return verts[which]->edges().end();
-    }
-
-    const Set& neighbors(int which) const{
-        return verts[which]->edges();
+        return edges->end(which);
+    }
+
+    int sharedNeighbors(int a,int b) const{
+        NeighborIterator ait = begin(a), aend = end(a);
+        NeighborIterator bit = begin(b), bend = end(b);
+        int shared = 0;
+        while(ait != aend && bit != bend){
+            if(*ait == *bit){
+                shared++;
+                ait++;
+                bit++;
+            }else if(*ait < *bit)
+                ait++;
+            else
+                bit++;
+        }
+        return shared;
+    }
+
+    void sharedNeighbors(int a,int b,std::vector<int>& out) const{
+        out.clear();
+        NeighborIterator ait = begin(a), aend = end(a);
+        NeighborIterator bit = begin(b), bend = end(b);
+        while(ait != aend && bit != bend){
+            if(*ait == *bit){
+                out.push_back(*ait);
+                ait++;
+                bit++;
+            }else if(*ait < *bit)
+                ait = std::lower_bound(ait, aend, *bit);
+            else
+                bit = std::lower_bound(bit, bend, *ait);
+        }
     }
 
     std::pair<int,int> randomDyad() const{
@@ -2058,75 +2347,40 @@ public:
     }
 
     std::pair<int,int> randomEdge() const{
-        int n= this->nEdges()*2.0;
+        int64_t n= 2 * (int64_t) this->nEdges();
         if(n==0)
             ::Rf_error("randomEdge: network has no edges");
-        int c=0;
-        int edgeNumber = floor(Rf_runif(0,(double)n));
-        int degree;
-        for(int i=0;i<verts.size();i++){
-            degree = verts[i]->degree();
-            if(c+degree > edgeNumber){
-                const Set* edges = &verts[i]->edges();
-                Set::const_iterator it = edges->begin();
-                std::advance(it,edgeNumber-c);
-                int to = *(it);
-                return std::make_pair(i,to);
-            }
-            c += degree;
-        }
-        //cout << "edge: "<<edgeNumber<<" total edges: "<<n<<" c:"<<c<<"\n";
-        ::Rf_error("randomEdge: edge not found. ");
-        return std::pair<int,int>(-1,-1);
+        int64_t offset;
+        int64_t edgeNumber = std::min((int64_t) floor(Rf_runif(0,(double)n)), n - 1);
+        int from = edges->degrees().findEdge(edgeNumber, offset);
+        return std::make_pair(from, edges->begin(from)[offset]);
     }
 
-    int randomDyad(int from,bool missing){
-        if(!missing)
+    int randomDyad(int from,bool miss){
+        if(!miss)
             return floor(Rf_runif(0,(double)size()));
         else
-            return verts[from]->randomMissingDyad();
+            return missing->randomMissing(from);
     }
 
     std::pair<int,int> randomNonEdge() const{
-        ::Rf_error("randomNonEdge unimplemented ");
-
-        //the following only works if set is used, not hashSet
-        /*		int n= this->nEdges();
-		int nVerts = this->size();
-		int m= this->maxEdges();
-		int c=0;
-		int nonEdgeNumber = floor(Rf_runif(0,(double)(m-n)));
-		int degree;
-		for(int i=0;i<verts.size();i++){
-			degree = verts[i]->outdegree();
-			if(c+(nVerts-degree) < nonEdgeNumber){
-				//find the nth (which) non-edge of vertex i
-				int which = nonEdgeNumber - c;
-				Set::iterator currentEdge = verts[i]->outedges().begin();
-				Set::iterator end = verts[i]->outedges().end();
-				while(currentEdge!=end){
-					if(which<(*currentEdge)){
-						return std::make_pair(i,which);
-					}else{
-						which++;
-						currentEdge++;
-					}
-				}
-				return std::make_pair(i,which);
-			}
-			c += (nVerts-degree);
-		}
-		::Rf_error("randomNonEdge: dyad not found");
-         */return std::pair<int,int>(-1,-1);
+        //each non-edge is counted once from either end
+        int64_t n = size();
+        int64_t nonEdges = n * (n - 1) - 2 * (int64_t) nEdges();
+        if(nonEdges <= 0)
+            ::Rf_error("randomNonEdge: network is complete");
+        int64_t offset;
+        int64_t dyadNumber = std::min((int64_t) floor(Rf_runif(0,(double)nonEdges)), nonEdges - 1);
+        int from = edges->degrees().findNonEdge(dyadNumber, n - 1, offset);
+        return std::make_pair(from, edges->nthNonNeighbour(from, offset, 0, n));
     }
 
 
     boost::shared_ptr< std::vector< std::pair<int,int> > > edgelist() const{
         boost::shared_ptr< std::vector< std::pair<int,int> > > v(new std::vector<std::pair<int,int> >());
         v->reserve(nEdges());
-        for(int i=0;i<verts.size();i++){
-            const Set* out = &(verts[i]->edges());
-            for(Set::const_iterator it = out->begin();it!=out->end();it++){
+        for(int i=0;i<size();i++){
+            for(NeighborIterator it = begin(i);it!=end(i);it++){
                 if(*it<i)
                     continue;
                 std::pair<int,int> p = std::make_pair(i,*it);
@@ -2172,44 +2426,44 @@ public:
     }
 
     double continVariableValue(int which,int at) const{
-        return verts[at]->continVariable(which);
+        return attributes->continValue(which, at);
+    }
+
+    const double* continVariableColumn(int which) const{
+        return attributes->continColumn(which);
     }
 
 
     void setContinVariableValue(int which,int at,double newValue){
-        verts[at]->setContinVariable(newValue, which);
+        attributes->setContinValue(which, at, newValue);
     }
 
 
     bool continVariableObserved(int which,int at){
-        return verts[at]->continObserved(which);
+        return attributes->continObserved(which, at);
     }
 
     std::vector<bool> continVariableObserved(int which){
         std::vector<bool> obs(size(),false);
         for(int i=0;i<size();i++){
-            obs[i] = verts[i]->continObserved(which);
+            obs[i] = attributes->continObserved(which, i);
         }
         return obs;
     }
 
 
     void setContinVariableObserved(int which,int at,bool observed){
-        verts[at]->setContinObserved(which,observed);
+        attributes->setContinObserved(which, at, observed);
     }
 
     void removeContinVariable(int which){
         contMeta->erase(contMeta->begin()+which);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->removeContinVariable(which);
-        }
+        attributes->removeContinVariable(which);
     }
 
     void addContinVariable(const std::vector<double>& vals,ContinAttrib& attribs){
         contMeta->push_back(attribs);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->addContinVariable(vals[i]);
-        }
+        attributes->addContinVariable(vals);
     }
 
     std::vector<std::string> discreteVarNames() const{
@@ -2225,61 +2479,59 @@ public:
 
     void removeDiscreteVariable(int which){
         disMeta->erase(disMeta->begin()+which);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->removeDiscreteVariable(which);
-        }
+        attributes->removeDiscreteVariable(which);
     }
 
     std::vector<int> discreteVariableValues(int which) const{
-        std::vector<int> v(verts.size(),0);
-        for(int i=0;i<verts.size();i++)
-            v[i] = verts[i]->discreteVariable(which);
-        return v;
+        const int* col = attributes->discreteColumn(which);
+        return col == NULL ? std::vector<int>() : std::vector<int>(col, col + size());
     }
 
     int discreteVariableValue(int which,int at) const{
-        return verts[at]->discreteVariable(which);
+        return attributes->discreteValue(which, at);
+    }
+
+    const int* discreteVariableColumn(int which) const{
+        return attributes->discreteColumn(which);
     }
 
     void setDiscreteVariableValue(int which,int at,int newValue){
-        verts[at]->setDiscreteVariable(newValue,which);
+        attributes->setDiscreteValue(which, at, newValue);
     }
 
     std::string discreteVariableLabel(int which,int at) const{
-        return disMeta->at(which).labels().at(verts[at]->discreteVariable(which));
+        return disMeta->at(which).labels().at(attributes->discreteValue(which, at));
     }
 
     std::vector<std::string> discreteVariable(int which) const{
-        std::vector<std::string> v(verts.size(),"");
-        for(int i=0;i<verts.size();i++)
-            v[i] = disMeta->at(which).labels().at(verts[i]->discreteVariable(which)-1);
+        std::vector<std::string> v(size(),"");
+        for(int i=0;i<size();i++)
+            v[i] = disMeta->at(which).labels().at(attributes->discreteValue(which, i)-1);
         return v;
     }
 
 
     void addDiscreteVariable(const std::vector<int>& vals,DiscreteAttrib& attribs){
         disMeta->push_back(attribs);
-        for(int i=0;i<verts.size();i++){
-            verts[i]->addDiscreteVariable(vals[i]);
-        }
+        attributes->addDiscreteVariable(vals);
     }
 
     bool discreteVariableObserved(int which,int at){
-        return verts[at]->discreteObserved(which);
+        return attributes->discreteObserved(which, at);
     }
 
 
     std::vector<bool> discreteVariableObserved(int which){
         std::vector<bool> obs(size(),false);
         for(int i=0;i<size();i++){
-            obs[i] = verts[i]->discreteObserved(which);
+            obs[i] = attributes->discreteObserved(which, i);
         }
         return obs;
     }
 
 
     void setDiscreteVariableObserved(int which,int at,bool observed){
-        verts[at]->setDiscreteObserved(which,observed);
+        attributes->setDiscreteObserved(which, at, observed);
     }
 
     void addDiscreteVariableR(RObject robj,std::string name){
@@ -2422,7 +2674,7 @@ public:
     }
 
     unsigned64_t maxEdges() const{
-        unsigned64_t n= verts.size();
+        unsigned64_t n = size();
         return n*(n-1LL)/2LL;
     }
 
@@ -2432,8 +2684,588 @@ public:
 typedef BinaryNet<Undirected> UndirectedNet;
 
 
+/*!
+ * An undirected two mode network. Vertices 0 to firstModeSize() - 1 form the
+ * first mode and the remainder the second. Ties are only possible between the
+ * modes; attempts to add a tie within a mode are ignored, as are loops.
+ *
+ * Storage is that of Undirected, so the statistics for undirected networks may
+ * be instantiated with this engine. The generators of LatentOrderLikelihood only
+ * visit the dyads between the modes (see DyadMask).
+ */
+class Bipartite : public Undirected{
+protected:
+    boost::shared_ptr<int> nFirst; /*!< the size of the first mode */
+
+public:
+
+    Bipartite() : Undirected(), nFirst(new int(0)){}
+
+    Bipartite(const Bipartite& net) : Undirected(net), nFirst(net.nFirst){}
+
+    Bipartite& operator=(const Bipartite& net){
+        Undirected::operator=(net);
+        nFirst = net.nFirst;
+        return *this;
+    }
+
+    Bipartite(const Bipartite& net,bool deepCopy) : Undirected(net,deepCopy){
+        if(deepCopy)
+            nFirst = boost::shared_ptr<int>(new int(*net.nFirst));
+        else
+            nFirst = net.nFirst;
+    }
+
+    Bipartite(Rcpp::IntegerMatrix edgeList,int numFirst,int numSecond) :
+        Undirected(Rcpp::IntegerMatrix(0,2),std::max(0, numFirst) + std::max(0, numSecond)),
+        nFirst(new int(numFirst)){
+        if(numFirst < 0 || numSecond < 0)
+            Rf_error("Bipartite: mode sizes must be non-negative");
+        for(int i=0;i<edgeList.nrow();i++){
+            int from = edgeList(i,0)-1;
+            int to = edgeList(i,1)-1;
+            if(from < 0 || from >= size() || to<0 || to >= size())
+                Rf_error("Edgelist indices out of range");
+            if(sameMode(from,to))
+                Rf_error("Edgelist contains a tie within a mode (%d, %d)", from + 1, to + 1);
+            this->addEdge(from,to);
+        }
+    }
+
+    static std::string engineName(){
+        return "Bipartite";
+    }
+
+    bool isBipartite() const{
+        return true;
+    }
+
+    int firstModeSize() const{
+        return *nFirst;
+    }
+
+    /*!
+     * are from and to in the same mode
+     */
+    inline bool sameMode(int from,int to) const{
+        return (from < *nFirst) == (to < *nFirst);
+    }
+
+    /*!
+     * removes a vertex. Vertices are added to the end of the second mode.
+     */
+    void removeVertex(int pos){
+        Undirected::removeVertex(pos);
+        if(pos < *nFirst)
+            (*nFirst)--;
+    }
+
+    /*!
+     * permutes the vertices. Vertices must stay within their mode.
+     */
+    void reorderVertices(std::vector<int> order){
+        for(int i=0;i<order.size();i++)
+            if(!sameMode(i, order[i]))
+                Rf_error("Bipartite: a reordering may not move vertices between modes");
+        Undirected::reorderVertices(order);
+    }
+
+    void addEdge(int from,int to){
+        if(sameMode(from,to))
+            return;
+        Undirected::addEdge(from,to);
+    }
+
+    std::pair<int,int> randomDyad() const{
+        std::pair<int,int> toggle;
+        randomDyad(toggle);
+        return toggle;
+    }
+
+    void randomDyad(std::pair<int,int>& toggle) const{
+        int n1 = *nFirst;
+        int n2 = size() - n1;
+        toggle.first = floor(Rf_runif(0,(double)n1));
+        toggle.second = n1 + floor(Rf_runif(0,(double)n2));
+    }
+
+    int randomDyad(int from,bool missing){
+        if(missing)
+            return Undirected::randomDyad(from,missing);
+        int n1 = *nFirst;
+        if(from < n1)
+            return n1 + floor(Rf_runif(0,(double)(size() - n1)));
+        return floor(Rf_runif(0,(double)n1));
+    }
+
+    /*!
+     * a random dyad between the modes without a tie, with the first mode
+     * vertex first
+     */
+    std::pair<int,int> randomNonEdge() const{
+        int64_t n1 = *nFirst;
+        int64_t n2 = size() - n1;
+        int64_t nonEdges = n1 * n2 - nEdges();
+        if(nonEdges <= 0)
+            ::Rf_error("randomNonEdge: network is complete");
+        //every tie has one end in the first mode, so the first mode vertices
+        //hold all of the non-edges
+        int64_t offset;
+        int64_t dyadNumber = std::min((int64_t) floor(Rf_runif(0,(double)nonEdges)), nonEdges - 1);
+        int from = edges->degrees().findNonEdge(dyadNumber, n2, offset);
+        return std::make_pair(from, edges->nthNonNeighbour(from, offset, n1, size()));
+    }
+
+    unsigned64_t maxEdges() const{
+        unsigned64_t n1 = *nFirst;
+        unsigned64_t n2 = size() - *nFirst;
+        return n1 * n2;
+    }
+
+};
+
+
+typedef BinaryNet<Bipartite> BipartiteNet;
+
+
+/*!
+ * A bidirectional iterator over the set bits of a row of a bit matrix, in
+ * increasing order. Only iterators over the same row may be compared.
+ */
+class BitRowIterator{
+protected:
+    const unsigned64_t* row;
+    int n;      /*!< the number of bits in the row */
+    int pos;    /*!< the current bit, n at the end */
+
+    //the first set bit at or after from, or n
+    int nextSet(int from) const{
+        if(from >= n)
+            return n;
+        int w = from >> 6;
+        int nWords = (n + 63) >> 6;
+        unsigned64_t word = row[w] & (~0ULL << (from & 63));
+        while(word == 0){
+            if(++w >= nWords)
+                return n;
+            word = row[w];
+        }
+        return (w << 6) + lowestBit(word);
+    }
+
+    //the last set bit at or before from, or -1
+    int prevSet(int from) const{
+        if(from < 0)
+            return -1;
+        int w = from >> 6;
+        unsigned64_t word = row[w] & (~0ULL >> (63 - (from & 63)));
+        while(word == 0){
+            if(--w < 0)
+                return -1;
+            word = row[w];
+        }
+        return (w << 6) + highestBit(word);
+    }
+
+public:
+    typedef std::bidirectional_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const int* pointer;
+    typedef int reference;
+
+    BitRowIterator() : row(NULL), n(0), pos(0){}
+
+    /*!
+     * \param r the row
+     * \param size the number of bits in the row
+     * \param start the iterator is positioned at the first set bit at or after start
+     */
+    BitRowIterator(const unsigned64_t* r, int size, int start) : row(r), n(size){
+        pos = nextSet(start);
+    }
+
+    inline int operator*() const{
+        return pos;
+    }
+
+    inline BitRowIterator& operator++(){
+        pos = nextSet(pos + 1);
+        return *this;
+    }
+
+    inline BitRowIterator operator++(int){
+        BitRowIterator tmp(*this);
+        pos = nextSet(pos + 1);
+        return tmp;
+    }
+
+    inline BitRowIterator& operator--(){
+        pos = prevSet(pos - 1);
+        return *this;
+    }
+
+    inline BitRowIterator operator--(int){
+        BitRowIterator tmp(*this);
+        pos = prevSet(pos - 1);
+        return tmp;
+    }
+
+    inline bool operator==(const BitRowIterator& other) const{
+        return pos == other.pos;
+    }
+
+    inline bool operator!=(const BitRowIterator& other) const{
+        return pos != other.pos;
+    }
+};
+
+
+/*!
+ * An undirected network engine holding the ties in a bit matrix, for small or
+ * dense networks.
+ *
+ * hasEdge and toggle are O(1), and the neighbours shared by two vertices are
+ * counted a word at a time. Neighbour iteration scans the bit row, costing
+ * O(n / 64 + degree), and the matrix takes n^2 / 8 bytes, so the engine is
+ * not suited to large sparse networks. Vertex variables and missingness are
+ * held as in Undirected.
+ *
+ * A deep copy shares the rows with the original, and a row is copied the
+ * first time either network writes to it.
+ */
+class Dense : public Undirected{
+protected:
+    typedef boost::shared_ptr< std::vector<unsigned64_t> > RowPtr;
+    typedef boost::shared_ptr< std::vector<RowPtr> > RowsPtr;
+    typedef boost::shared_ptr< std::vector<int> > DegreesPtr;
+    typedef boost::shared_ptr<DegreeIndex> IndexPtr;
+    RowsPtr rows;           /*!< size() rows of words() words */
+    DegreesPtr degrees;
+    IndexPtr degreeIndex;   /*!< partial sums of degrees */
+
+    inline int words() const{
+        return (size() + 63) >> 6;
+    }
+
+    inline const unsigned64_t* row(int which) const{
+        return &(*(*rows)[which])[0];
+    }
+
+    /*!
+     * row which, for writing. Copies it if it is shared.
+     */
+    inline unsigned64_t* row(int which){
+        RowPtr& r = (*rows)[which];
+        if(!r.unique())
+            r = RowPtr(new std::vector<unsigned64_t>(*r));
+        return &(*r)[0];
+    }
+
+    inline void flip(int from,int to){
+        row(from)[to >> 6] ^= 1ULL << (to & 63);
+    }
+
+    /*!
+     * rebuilds the matrix after the vertices have changed
+     * \param oldSize the number of vertices before the change
+     * \param newId the new id of each old vertex, -1 if removed
+     */
+    void rebuild(int oldSize,const std::vector<int>& newId){
+        int w = words();
+        RowsPtr newRows(new std::vector<RowPtr>(size()));
+        for(int i=0;i<size();i++)
+            (*newRows)[i] = RowPtr(new std::vector<unsigned64_t>(w, 0ULL));
+        DegreesPtr newDegrees(new std::vector<int>(size(), 0));
+        double ties = 0.0;
+        for(int i=0;i<oldSize;i++){
+            int from = newId[i];
+            if(from < 0)
+                continue;
+            const unsigned64_t* r = &(*(*rows)[i])[0];
+            BitRowIterator end(r, oldSize, oldSize);
+            for(BitRowIterator it(r, oldSize, 0); it != end; it++){
+                int to = newId[*it];
+                if(to < 0)
+                    continue;
+                (*(*newRows)[from])[to >> 6] |= 1ULL << (to & 63);
+                (*newDegrees)[from]++;
+                ties++;
+            }
+        }
+        rows = newRows;
+        degrees = newDegrees;
+        degreeIndex = IndexPtr(new DegreeIndex());
+        degreeIndex->assign(*degrees);
+        (*numEdges) = ties / 2.0;
+    }
+
+    /*!
+     * the r-th (from 0) neighbour of which or, if complement, the r-th vertex
+     * other than which that is not a neighbour. Scans the row a word at a time.
+     */
+    int nthInRow(int which,int r,bool complement) const{
+        const unsigned64_t* rw = row(which);
+        int n = size();
+        for(int w=0;w<words();w++){
+            unsigned64_t bits = rw[w];
+            if(complement){
+                bits = ~bits;
+                if(w == (which >> 6))
+                    bits &= ~(1ULL << (which & 63));
+                if(n - (w << 6) < 64)
+                    bits &= (1ULL << (n - (w << 6))) - 1ULL;
+            }
+            int c = bitCount(bits);
+            if(r < c){
+                for(int k=0;k<r;k++)
+                    bits &= bits - 1ULL;
+                return (w << 6) + lowestBit(bits);
+            }
+            r -= c;
+        }
+        ::Rf_error("Dense: row entry not found");
+        return -1;
+    }
+
+public:
+
+    typedef BitRowIterator NeighborIterator;
+
+    Dense() : Undirected(), rows(new std::vector<RowPtr>()), degrees(new std::vector<int>()),
+        degreeIndex(new DegreeIndex()){}
+
+    Dense(const Dense& net) : Undirected(net), rows(net.rows), degrees(net.degrees),
+        degreeIndex(net.degreeIndex){}
+
+    Dense& operator=(const Dense& net){
+        Undirected::operator=(net);
+        rows = net.rows;
+        degrees = net.degrees;
+        degreeIndex = net.degreeIndex;
+        return *this;
+    }
+
+    Dense(const Dense& net,bool deepCopy) : Undirected(net,deepCopy){
+        if(deepCopy){
+            rows = RowsPtr(new std::vector<RowPtr>(*net.rows));
+            degrees = DegreesPtr(new std::vector<int>(*net.degrees));
+            degreeIndex = IndexPtr(new DegreeIndex(*net.degreeIndex));
+        }else{
+            rows = net.rows;
+            degrees = net.degrees;
+            degreeIndex = net.degreeIndex;
+        }
+    }
+
+    Dense(Rcpp::IntegerMatrix edgeList,int numNodes) :
+        Undirected(Rcpp::IntegerMatrix(0,2),numNodes),
+        rows(new std::vector<RowPtr>(size())),
+        degrees(new std::vector<int>(size(), 0)),
+        degreeIndex(new DegreeIndex(size())){
+        for(int i=0;i<size();i++)
+            (*rows)[i] = RowPtr(new std::vector<unsigned64_t>(words(), 0ULL));
+        for(int i=0;i<edgeList.nrow();i++){
+            int from = edgeList(i,0)-1;
+            int to = edgeList(i,1)-1;
+            if(from < 0 || from >= size() || to<0 || to >= size())
+                Rf_error("Edgelist indices out of range");
+            this->addEdge(from,to);
+        }
+    }
+
+    static std::string engineName(){
+        return "Dense";
+    }
+
+    void addVertex(){
+        int n = size();
+        Undirected::addVertex();
+        std::vector<int> ids(n);
+        for(int i=0;i<n;i++)
+            ids[i] = i;
+        rebuild(n, ids);
+    }
+
+    void removeVertex(int pos){
+        int n = size();
+        Undirected::removeVertex(pos);
+        std::vector<int> ids(n);
+        for(int i=0;i<n;i++)
+            ids[i] = i < pos ? i : i - 1;
+        ids[pos] = -1;
+        rebuild(n, ids);
+    }
+
+    void reorderVertices(std::vector<int> order){
+        Undirected::reorderVertices(order);
+        std::vector<int> ids(size());
+        for(int i=0;i<size();i++)
+            ids[order[i]] = i;
+        rebuild(size(), ids);
+    }
+
+    bool hasEdge(int from, int to) const{
+        return (row(from)[to >> 6] >> (to & 63)) & 1ULL;
+    }
+
+    bool removeEdge(int from,int to){
+        if(!hasEdge(from,to))
+            return false;
+        flip(from,to);
+        flip(to,from);
+        (*degrees)[from]--;
+        (*degrees)[to]--;
+        degreeIndex->add(from, -1);
+        degreeIndex->add(to, -1);
+        (*numEdges)--;
+        return true;
+    }
+
+    void addEdge(int from,int to){
+        if(from == to || hasEdge(from,to))
+            return;
+        flip(from,to);
+        flip(to,from);
+        (*degrees)[from]++;
+        (*degrees)[to]++;
+        degreeIndex->add(from, 1);
+        degreeIndex->add(to, 1);
+        (*numEdges)++;
+    }
+
+    void emptyGraph(){
+        Undirected::emptyGraph();
+        RowPtr zeros(new std::vector<unsigned64_t>(words(), 0ULL));
+        std::fill(rows->begin(), rows->end(), zeros);
+        std::fill(degrees->begin(), degrees->end(), 0);
+        degreeIndex->clear();
+    }
+
+    void assignEdges(const int64_t* outStart, const int* outNbrs,
+            const int64_t* inStart, const int* inNbrs){
+        emptyGraph();
+        for(int i=0;i<size();i++)
+            for(int64_t k=outStart[i];k<outStart[i + 1];k++)
+                if(outNbrs[k] > i)
+                    addEdge(i, outNbrs[k]);
+    }
+
+    NeighborIterator inBegin(int which) const{
+        ::Rf_error("inBegin not meaningful for undirected networks");
+        return NeighborIterator();
+    }
+
+    NeighborIterator inEnd(int which) const{
+        ::Rf_error("inEnd not meaningful for undirected networks");
+        return NeighborIterator();
+    }
+
+    NeighborIterator outBegin(int which) const{
+        ::Rf_error("outBegin not meaningful for undirected networks");
+        return NeighborIterator();
+    }
+
+    NeighborIterator outEnd(int which) const{
+        ::Rf_error("outEnd not meaningful for undirected networks");
+        return NeighborIterator();
+    }
+
+    int degree(int which) const{
+        return (*degrees)[which];
+    }
+
+    template<class Collection>
+    Collection neighbors(int which) const{
+        return Collection(begin(which), end(which));
+    }
+
+    NeighborIterator begin(int which) const{
+        return NeighborIterator(row(which), size(), 0);
+    }
+
+    NeighborIterator end(int which) const{
+        return NeighborIterator(row(which), size(), size());
+    }
+
+    int sharedNeighbors(int a,int b) const{
+        const unsigned64_t* ra = row(a);
+        const unsigned64_t* rb = row(b);
+        int shared = 0;
+        for(int w=0, nw = words();w<nw;w++)
+            shared += bitCount(ra[w] & rb[w]);
+        return shared;
+    }
+
+    void sharedNeighbors(int a,int b,std::vector<int>& out) const{
+        out.clear();
+        const unsigned64_t* ra = row(a);
+        const unsigned64_t* rb = row(b);
+        for(int w=0, nw = words();w<nw;w++){
+            unsigned64_t word = ra[w] & rb[w];
+            while(word != 0){
+                out.push_back((w << 6) + lowestBit(word));
+                word &= word - 1ULL;
+            }
+        }
+    }
+
+    std::pair<int,int> randomEdge() const{
+        int64_t n = 2 * (int64_t) this->nEdges();
+        if(n==0)
+            ::Rf_error("randomEdge: network has no edges");
+        int64_t offset;
+        int64_t edgeNumber = std::min((int64_t) floor(Rf_runif(0,(double)n)), n - 1);
+        int from = degreeIndex->findEdge(edgeNumber, offset);
+        return std::make_pair(from, nthInRow(from, offset, false));
+    }
+
+    std::pair<int,int> randomNonEdge() const{
+        int64_t n = size();
+        int64_t nonEdges = n * (n - 1) - 2 * (int64_t) nEdges();
+        if(nonEdges <= 0)
+            ::Rf_error("randomNonEdge: network is complete");
+        int64_t offset;
+        int64_t dyadNumber = std::min((int64_t) floor(Rf_runif(0,(double)nonEdges)), nonEdges - 1);
+        int from = degreeIndex->findNonEdge(dyadNumber, n - 1, offset);
+        return std::make_pair(from, nthInRow(from, offset, true));
+    }
+
+    boost::shared_ptr< std::vector< std::pair<int,int> > > edgelist() const{
+        boost::shared_ptr< std::vector< std::pair<int,int> > > v(new std::vector<std::pair<int,int> >());
+        v->reserve(nEdges());
+        for(int i=0;i<size();i++){
+            NeighborIterator last = end(i);
+            for(NeighborIterator it(row(i), size(), i + 1);it != last;it++)
+                v->push_back(std::make_pair(i,*it));
+        }
+        return v;
+    }
+
+    Rcpp::IntegerMatrix edgelistR(bool includeMissing) const{
+        boost::shared_ptr< std::vector< std::pair<int,int> > > v = edgelist();
+        std::vector<int> keep;
+        for(int i=0;i<v->size();i++)
+            if(includeMissing || !isMissing((*v)[i].first,(*v)[i].second))
+                keep.push_back(i);
+        Rcpp::IntegerMatrix rV(keep.size(),2);
+        for(int i=0;i<keep.size();i++){
+            rV(i,0) = (*v)[keep[i]].first+1;
+            rV(i,1) = (*v)[keep[i]].second+1;
+        }
+        return rV;
+    }
+
+};
+
+
+typedef BinaryNet<Dense> DenseNet;
+
+
 
 
 }
 
+#include "NetworkFile.h"
+
 #endif /* NETH_ */
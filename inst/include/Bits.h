@@ -0,0 +1,57 @@
+#ifndef BITSH_
+#define BITSH_
+
+#include <stdint.h>
+
+namespace lolog{
+
+#ifdef _WIN32
+typedef unsigned __int64	unsigned64_t;
+#else
+
+typedef uint64_t			unsigned64_t;
+
+#endif
+
+/*!
+ * the number of set bits in a word
+ */
+inline int bitCount(unsigned64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/*!
+ * the index of the lowest set bit of a non-zero word
+ */
+inline int lowestBit(unsigned64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    return bitCount((x & (~x + 1ULL)) - 1ULL);
+#endif
+}
+
+/*!
+ * the index of the highest set bit of a non-zero word
+ */
+inline int highestBit(unsigned64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(x);
+#else
+    int b = 0;
+    while(x >>= 1)
+        b++;
+    return b;
+#endif
+}
+
+}
+
+#endif /* BITSH_ */
@@ -199,6 +199,16 @@ public:
     bool isDyadIndependent(){
         return false;
     }
+
+    /*!
+     * true if adding the tie (from, to) moves the network further from satisfying
+     * the constraint. Such ties have zero probability, so the generator may skip the
+     * dyad without updating the model. Constraints able to tell this cheaply should
+     * override it. False by default.
+     */
+    bool isDyadBlocked(const BinaryNet<Engine>& net, const int& from, const int& to){
+        return false;
+    }
 };
 
 
@@ -85,6 +85,27 @@ public:
 	}
 
 
+	/*!
+	 * adding a tie is blocked if it increases the distance from the bounds, i.e.
+	 * an endpoint at the upper bound is not offset by an endpoint below the lower bound
+	 */
+	bool isDyadBlocked(const BinaryNet<Engine>& net, const int& from, const int& to){
+		if(net.hasEdge(from,to))
+			return false;
+		int change = 0;
+		int dfrom = net.degree(from);
+		int dto = net.degree(to);
+		if(dfrom<lower)
+			change--;
+		else if(dfrom>=upper)
+			change++;
+		if(dto<lower)
+			change--;
+		else if(dto>=upper)
+			change++;
+		return change > 0;
+	}
+
 	void rollback(const BinaryNet<Engine>& net){
 		dist = lastDist;
 
@@ -109,6 +130,8 @@ public:
 
 typedef Constraint<Directed, BoundedDegree<Directed> > DirectedBoundedDegreeConstraint;
 typedef Constraint<Undirected, BoundedDegree<Undirected> > UndirectedBoundedDegreeConstraint;
+typedef Constraint<Bipartite, BoundedDegree<Bipartite> > BipartiteBoundedDegreeConstraint;
+typedef Constraint<Dense, BoundedDegree<Dense> > DenseBoundedDegreeConstraint;
 
 
 }
@@ -0,0 +1,146 @@
+#ifndef CSRNETWORKH_
+#define CSRNETWORKH_
+
+#include <vector>
+#include <algorithm>
+
+#include "BinaryNet.h"
+
+namespace lolog{
+
+
+/*!
+ * An immutable compressed sparse row snapshot of the ties of a network.
+ *
+ * The neighbours of every vertex are stored sorted in a single contiguous
+ * array, with an offset array marking where each vertex's neighbours start.
+ * Directed networks hold both the out and in neighbours. A lookup is a
+ * binary search over a contiguous range, which avoids the pointer chasing
+ * of the BinaryNet vertex objects.
+ *
+ * The snapshot does not follow later changes to the network it was built
+ * from, and so should only be used where the network is read but not
+ * modified (e.g. the observed network while computing model frames).
+ * It may be shared between threads.
+ */
+class CsrNetwork{
+protected:
+    int n;
+    bool directed;
+    std::vector<int> outStart;      /*!< n + 1 offsets into outNbrs */
+    std::vector<int> outNbrs;       /*!< sorted out neighbours (all neighbours if undirected) */
+    std::vector<int> inStart;       /*!< n + 1 offsets into inNbrs, directed only */
+    std::vector<int> inNbrs;        /*!< sorted in neighbours, directed only */
+
+public:
+
+    CsrNetwork() : n(0), directed(false), outStart(1, 0){}
+
+    /*!
+     * Builds the snapshot in one pass over the vertices of net
+     */
+    template<class Engine>
+    CsrNetwork(const BinaryNet<Engine>& net) : n(net.size()), directed(net.isDirected()){
+        typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+        outStart.resize(n + 1);
+        outStart[0] = 0;
+        outNbrs.reserve(directed ? net.nEdges() : 2 * net.nEdges());
+        if(directed){
+            inStart.resize(n + 1);
+            inStart[0] = 0;
+            inNbrs.reserve(net.nEdges());
+        }
+        for(int i=0;i<n;i++){
+            if(directed){
+                for(NeighborIterator it = net.outBegin(i); it != net.outEnd(i); it++)
+                    outNbrs.push_back(*it);
+                for(NeighborIterator it = net.inBegin(i); it != net.inEnd(i); it++)
+                    inNbrs.push_back(*it);
+                inStart[i + 1] = inNbrs.size();
+            }else{
+                for(NeighborIterator it = net.begin(i); it != net.end(i); it++)
+                    outNbrs.push_back(*it);
+            }
+            outStart[i + 1] = outNbrs.size();
+        }
+    }
+
+    /*!
+     * the number of vertices
+     */
+    int size() const{
+        return n;
+    }
+
+    bool isDirected() const{
+        return directed;
+    }
+
+    /*!
+     * the number of edges
+     */
+    int nEdges() const{
+        return directed ? outNbrs.size() : outNbrs.size() / 2;
+    }
+
+    /*!
+     * test if an edge exists
+     */
+    inline bool hasEdge(int from, int to) const{
+        //search the shorter of the two lists
+        if(directed && inStart[to + 1] - inStart[to] < outStart[from + 1] - outStart[from])
+            return std::binary_search(inBegin(to), inEnd(to), from);
+        if(!directed && outStart[to + 1] - outStart[to] < outStart[from + 1] - outStart[from])
+            std::swap(from, to);
+        return std::binary_search(outBegin(from), outEnd(from), to);
+    }
+
+    /*!
+     * the out neighbours of which, in increasing order
+     */
+    inline const int* outBegin(int which) const{
+        return outNbrs.empty() ? NULL : &outNbrs[0] + outStart[which];
+    }
+
+    inline const int* outEnd(int which) const{
+        return outNbrs.empty() ? NULL : &outNbrs[0] + outStart[which + 1];
+    }
+
+    /*!
+     * the in neighbours of which, in increasing order. Directed only.
+     */
+    inline const int* inBegin(int which) const{
+        return inNbrs.empty() ? NULL : &inNbrs[0] + inStart[which];
+    }
+
+    inline const int* inEnd(int which) const{
+        return inNbrs.empty() ? NULL : &inNbrs[0] + inStart[which + 1];
+    }
+
+    /*!
+     * the neighbours of which, in increasing order. Undirected only.
+     */
+    inline const int* begin(int which) const{
+        return outBegin(which);
+    }
+
+    inline const int* end(int which) const{
+        return outEnd(which);
+    }
+
+    int outdegree(int which) const{
+        return outStart[which + 1] - outStart[which];
+    }
+
+    int indegree(int which) const{
+        return directed ? inStart[which + 1] - inStart[which] : outdegree(which);
+    }
+
+    int degree(int which) const{
+        return outdegree(which);
+    }
+};
+
+}
+
+#endif /* CSRNETWORKH_ */
@@ -0,0 +1,151 @@
+#ifndef DEGREEINDEXH_
+#define DEGREEINDEXH_
+
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+namespace lolog{
+
+
+/*!
+ * A Fenwick (binary indexed) tree over the degrees of the vertices of a
+ * network.
+ *
+ * Supports changing a degree, adding a vertex and prefix sums in O(log n).
+ * It can also find the vertex holding the k-th edge end, or the k-th
+ * non-edge, in O(log n). Random edges and non-edges can then be drawn
+ * without a pass over the vertices.
+ *
+ * The index only holds partial sums. The owner keeps the degrees themselves
+ * and must report every change to them.
+ */
+class DegreeIndex{
+protected:
+    std::vector<int64_t> tree;  /*!< 1 based partial sums */
+
+    static inline int lowBit(int i){
+        return i & -i;
+    }
+
+    /*!
+     * Finds the vertex v whose weight range contains k, where the weight of
+     * a vertex is its degree, or capacity minus its degree if complement
+     *
+     * \param offset set to the position of k within the range of v
+     */
+    int locate(int64_t k, bool complement, int64_t capacity, int64_t& offset) const{
+        int n = size();
+        int top = 1;
+        while(2 * top <= n)
+            top *= 2;
+        int pos = 0;
+        for(int step = top; step > 0; step /= 2){
+            int next = pos + step;
+            if(next > n)
+                continue;
+            int64_t w = complement ? step * capacity - tree[next] : tree[next];
+            if(w <= k){
+                k -= w;
+                pos = next;
+            }
+        }
+        offset = k;
+        return pos;
+    }
+
+public:
+
+    DegreeIndex() : tree(1, 0){}
+
+    /*!
+     * An index of n vertices without edges
+     */
+    DegreeIndex(int n) : tree(n + 1, 0){}
+
+    int size() const{
+        return tree.size() - 1;
+    }
+
+    /*!
+     * rebuilds the index from the degrees, in O(n)
+     */
+    void assign(const std::vector<int>& degrees){
+        int n = degrees.size();
+        tree.assign(n + 1, 0);
+        for(int i=1;i<=n;i++){
+            tree[i] += degrees[i - 1];
+            int parent = i + lowBit(i);
+            if(parent <= n)
+                tree[parent] += tree[i];
+        }
+    }
+
+    /*!
+     * removes all edges
+     */
+    void clear(){
+        std::fill(tree.begin(), tree.end(), 0);
+    }
+
+    /*!
+     * changes the degree of v by delta
+     */
+    inline void add(int v, int delta){
+        for(int i = v + 1; i < tree.size(); i += lowBit(i))
+            tree[i] += delta;
+    }
+
+    /*!
+     * adds a vertex without edges
+     */
+    void addVertex(){
+        int i = tree.size();
+        tree.push_back(prefix(i - 1) - prefix(i - lowBit(i)));
+    }
+
+    /*!
+     * the sum of the degrees of vertices 0 to v - 1
+     */
+    int64_t prefix(int v) const{
+        int64_t sum = 0;
+        for(int i = v; i > 0; i -= lowBit(i))
+            sum += tree[i];
+        return sum;
+    }
+
+    /*!
+     * the sum of all degrees
+     */
+    int64_t total() const{
+        return prefix(size());
+    }
+
+    /*!
+     * Finds the vertex holding the k-th edge end, counting the neighbours of
+     * vertex 0 first, then those of vertex 1 and so on
+     *
+     * \param k between 0 and total() - 1
+     * \param offset set to the position of the edge among the neighbours of
+     *        the vertex
+     */
+    int findEdge(int64_t k, int64_t& offset) const{
+        return locate(k, false, 0, offset);
+    }
+
+    /*!
+     * Finds the vertex holding the k-th non-edge, where each vertex has
+     * capacity minus its degree non-edges
+     *
+     * \param k between 0 and the total number of non-edges - 1
+     * \param offset set to the position of the non-edge among the non-edges
+     *        of the vertex
+     */
+    int findNonEdge(int64_t k, int64_t capacity, int64_t& offset) const{
+        return locate(k, true, capacity, offset);
+    }
+};
+
+}
+
+#endif /* DEGREEINDEXH_ */
@@ -18,6 +18,9 @@ namespace lolog {
  * Has a sparse representation of edges (a binary tree) and a sparse representation
  * of missingness. If all or no out-dyads are missing, the missingness representation
  * takes up no additional space.
+ *
+ * The network engines no longer use it, and it is kept for code written
+ * against earlier versions.
  */
 class DirectedVertex : public Vertex {
 protected:
@@ -0,0 +1,302 @@
+#ifndef DYADCONTEXTH_
+#define DYADCONTEXTH_
+
+#include <vector>
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+#include "BinaryNet.h"
+
+namespace lolog{
+
+
+/*!
+ * Counts shared neighbors of two nodes. type == 4
+ */
+template<class Engine>
+int sharedNbrs(const BinaryNet<Engine>& net, int from, int to){
+     return sharedNbrs(net, from, to, 4);
+}
+
+
+/*!
+ * Counts shared neighbors of two nodes.
+ * type = 1     :   from -> to -> nbr -> from
+ * type = 2     :   from -> to <- nbr <- from (homogeneous)
+ * type = 3     :   either type 1 or 2
+ * type = 4     :   all combinations
+ */
+template<class Engine>
+int sharedNbrs(const BinaryNet<Engine>& net, int from, int to, int type){
+    if(net.isDirected()){
+        if(type == 4)
+            return allDirectedSharedNbrs(net, from, to);
+        return directedSharedNbrs(net, from, to, type);
+    }
+    return undirectedSharedNbrs(net, from, to);
+}
+
+
+
+template<class Engine>
+int undirectedSharedNbrs(const BinaryNet<Engine>& net, int from, int to){
+    return net.sharedNeighbors(from, to);
+}
+
+template<class Engine>
+int allDirectedSharedNbrs(const BinaryNet<Engine>& net, int from, int to){
+    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    NeighborIterator ifit = net.inBegin(from);
+    NeighborIterator ifend = net.inEnd(from);
+    NeighborIterator ofit = net.outBegin(from);
+    NeighborIterator ofend = net.outEnd(from);
+    int shared = 0;
+    while(ifit != ifend){
+        shared += net.hasEdge(*ifit, to);
+        shared += net.hasEdge(to, *ifit);
+        ifit++;
+    }
+    while(ofit != ofend){
+        shared += net.hasEdge(*ofit, to);
+        shared += net.hasEdge(to, *ofit);
+        ofit++;
+    }
+    return shared;
+}
+
+
+/*!
+ * type = 1     :   from -> to -> nbr -> from
+ * type = 2     :   from -> to <- nbr <- from (homogeneous)
+ * type = 3     :   either type 1 or 2
+ */
+template<class Engine>
+int directedSharedNbrs(const BinaryNet<Engine>& net, int from, int to, int type){
+    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    NeighborIterator fit, fend, tit, tend;
+
+    int sn = 0;
+    if(type == 1 || type == 3){
+        fit = net.inBegin(from);
+        fend = net.inEnd(from);
+        tit = net.outBegin(to);
+        tend = net.outEnd(to);
+        while(fit != fend && tit != tend){
+            if(*tit == *fit){
+                sn++;
+                tit++;
+                fit++;
+            }else if(*tit < *fit)
+                tit++;
+            else
+                fit++;
+        }
+    }
+    if(type == 2 || type == 3){
+        fit = net.outBegin(from);
+        fend = net.outEnd(from);
+        tit = net.inBegin(to);
+        tend = net.inEnd(to);
+        while(fit != fend && tit != tend){
+            if(*tit == *fit){
+                if(type == 3){
+                    bool counted = net.hasEdge(to, *tit) && net.hasEdge(*tit, from);
+                    if(!counted)
+                        sn++;
+                }else
+                    sn++;
+                tit++;
+                fit++;
+            }else if(*tit < *fit)
+                tit++;
+            else
+                fit++;
+        }
+    }
+    return sn;
+}
+
+
+/*!
+ * Memoised quantities of the dyad (from, to) being updated.
+ *
+ * Several terms need the same neighbourhood computations for a dyad (e.g.
+ * triangles, gwesp and esp all intersect the neighbours of from and to). A Model
+ * resets its context at the start of each dyad update, so these are computed at
+ * most once per toggle, by whichever term asks first.
+ *
+ * The values describe the network as it was at reset, so the context must be
+ * reset (or cleared) whenever the network changes.
+ */
+template<class Engine>
+class DyadContext{
+protected:
+    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+
+    const BinaryNet<Engine>* net;
+    int from_;
+    int to_;
+    int edge;               /*!< -1 if not yet computed */
+    int fromDeg;
+    int toDeg;
+    int counts[5];          /*!< shared neighbour counts by type (1-4) */
+    bool haveList;
+    std::vector<int> list;
+
+public:
+
+    DyadContext() : net(NULL), from_(-1), to_(-1){
+        invalidate();
+    }
+
+    /*!
+     * starts a new dyad, discarding any memoised values
+     */
+    void reset(const BinaryNet<Engine>& network, int from, int to){
+        net = &network;
+        from_ = from;
+        to_ = to;
+        invalidate();
+    }
+
+    /*!
+     * detaches the context from any dyad
+     */
+    void clear(){
+        net = NULL;
+    }
+
+    /*!
+     * true if the context is for (from, to) in network
+     */
+    inline bool matches(const BinaryNet<Engine>& network, int from, int to) const{
+        return net == &network && from_ == from && to_ == to;
+    }
+
+    inline int from() const{
+        return from_;
+    }
+
+    inline int to() const{
+        return to_;
+    }
+
+    /*!
+     * true if the network has the edge (from, to)
+     */
+    inline bool hasEdge(){
+        if(edge < 0)
+            edge = net->hasEdge(from_, to_);
+        return edge == 1;
+    }
+
+    inline int fromDegree(){
+        if(fromDeg < 0)
+            fromDeg = net->degree(from_);
+        return fromDeg;
+    }
+
+    inline int toDegree(){
+        if(toDeg < 0)
+            toDeg = net->degree(to_);
+        return toDeg;
+    }
+
+    /*!
+     * the neighbours shared by from and to (see sharedNbrs), in increasing
+     * order. In directed networks these are the vertices n with n -> from and
+     * to -> n, i.e. the type 1 shared neighbours.
+     */
+    const std::vector<int>& sharedList(){
+        if(haveList)
+            return list;
+        if(!net->isDirected()){
+            net->sharedNeighbors(from_, to_, list);
+            haveList = true;
+            return list;
+        }
+        list.clear();
+        NeighborIterator fit, fend, tit, tend;
+        fit = net->inBegin(from_);
+        fend = net->inEnd(from_);
+        tit = net->outBegin(to_);
+        tend = net->outEnd(to_);
+        while(fit != fend && tit != tend){
+            if(*tit == *fit){
+                list.push_back(*tit);
+                tit++;
+                fit++;
+            }else if(*tit < *fit)
+                tit = std::lower_bound(tit,tend,*fit);
+            else
+                fit = std::lower_bound(fit,fend,*tit);
+        }
+        haveList = true;
+        return list;
+    }
+
+    /*!
+     * sharedNbrs(net, from, to, type)
+     */
+    int sharedCount(int type = 4){
+        if(counts[type] >= 0)
+            return counts[type];
+        if(!net->isDirected() || type == 1)
+            counts[type] = sharedList().size();
+        else
+            counts[type] = sharedNbrs(*net, from_, to_, type);
+        return counts[type];
+    }
+
+protected:
+    void invalidate(){
+        edge = fromDeg = toDeg = -1;
+        for(int i=0;i<5;i++)
+            counts[i] = -1;
+        haveList = false;
+    }
+};
+
+
+/*!
+ * A term's handle on the dyad context of its model.
+ *
+ * Falls back to a private context when the term is not being updated by a
+ * model (or the model is updating a different dyad), so terms may always use
+ * it. Copies are not bound to any model.
+ */
+template<class Engine>
+class DyadContextRef{
+protected:
+    boost::shared_ptr< DyadContext<Engine> > shared;
+    DyadContext<Engine> local;
+public:
+
+    DyadContextRef(){}
+
+    DyadContextRef(const DyadContextRef& other){}
+
+    DyadContextRef& operator=(const DyadContextRef& other){
+        shared.reset();
+        local.clear();
+        return *this;
+    }
+
+    void bind(const boost::shared_ptr< DyadContext<Engine> >& context){
+        shared = context;
+    }
+
+    /*!
+     * the context for (from, to) in net. Call once per update, as the
+     * private context is reset on each call.
+     */
+    inline DyadContext<Engine>& get(const BinaryNet<Engine>& net, int from, int to){
+        if(shared && shared->matches(net, from, to))
+            return *shared;
+        local.reset(net, from, to);
+        return local;
+    }
+};
+
+}
+
+#endif /* DYADCONTEXTH_ */
@@ -0,0 +1,221 @@
+#ifndef DYADMASKH_
+#define DYADMASKH_
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+
+#include <Rcpp.h>
+
+namespace lolog{
+
+
+/*!
+ * The set of dyads which may hold a tie. Dyads outside of the mask are
+ * structural zeros: generation never visits them (they remain empty) and
+ * they are left out of the model frames.
+ *
+ * A mask is either block structured, where each vertex belongs to a block and
+ * ties are permitted between some pairs of blocks, or a sparse list of permitted
+ * dyads. In both cases the permitted alters of a vertex can be enumerated in time
+ * proportional to their number, so a pass over the permitted dyads costs
+ * O(permitted dyads) rather than O(n^2).
+ *
+ * Masks are immutable once created, and may be shared between threads.
+ */
+class DyadMask{
+protected:
+    int n;
+    bool directed;
+
+    //block structure (empty if a dyad list)
+    int nBlocks;
+    std::vector<int> blocks;                        /*!< the block of each vertex */
+    std::vector<char> blockAllowed;                 /*!< nBlocks x nBlocks, indexed [from * nBlocks + to] */
+    std::vector< std::vector<int> > members;        /*!< the vertices of each block */
+    std::vector< std::vector<int> > blockNbrs;      /*!< blocks sharing a permitted dyad with each block */
+
+    //dyad list
+    std::vector< std::vector<int> > outAllowed;     /*!< sorted permitted alters (from -> to) */
+    std::vector< std::vector<int> > inAllowed;      /*!< sorted permitted alters (to <- from), directed only */
+
+public:
+
+    DyadMask() : n(0), directed(false), nBlocks(0){}
+
+    /*!
+     * A block structured mask
+     *
+     * \param isDirected is the network directed
+     * \param vertexBlocks the block (0 to nBlocks - 1) of each vertex
+     * \param allowed allowed[a][b] is true if ties from block a to block b are
+     *        permitted. Symmetrised for undirected networks.
+     */
+    DyadMask(bool isDirected, const std::vector<int>& vertexBlocks,
+            const std::vector< std::vector<bool> >& allowed) :
+        n(vertexBlocks.size()), directed(isDirected), nBlocks(allowed.size()), blocks(vertexBlocks){
+        blockAllowed.assign(nBlocks * nBlocks, 0);
+        for(int a=0;a<nBlocks;a++){
+            if(allowed[a].size() != nBlocks)
+                Rf_error("DyadMask: the block matrix must be square");
+            for(int b=0;b<nBlocks;b++){
+                if(allowed[a][b]){
+                    blockAllowed[a * nBlocks + b] = 1;
+                    if(!directed)
+                        blockAllowed[b * nBlocks + a] = 1;
+                }
+            }
+        }
+        members.resize(nBlocks);
+        for(int i=0;i<n;i++){
+            if(blocks[i] < 0 || blocks[i] >= nBlocks)
+                Rf_error("DyadMask: vertex block out of range");
+            members[blocks[i]].push_back(i);
+        }
+        blockNbrs.resize(nBlocks);
+        for(int a=0;a<nBlocks;a++)
+            for(int b=0;b<nBlocks;b++)
+                if(blockAllowed[a * nBlocks + b] || blockAllowed[b * nBlocks + a])
+                    blockNbrs[a].push_back(b);
+    }
+
+    /*!
+     * A mask from a list of permitted dyads
+     *
+     * \param size the number of vertices
+     * \param isDirected is the network directed
+     * \param dyads the permitted dyads (0 indexed). Undirected dyads may be given
+     *        in either order.
+     */
+    DyadMask(int size, bool isDirected, const std::vector< std::pair<int,int> >& dyads) :
+        n(size), directed(isDirected), nBlocks(0){
+        outAllowed.resize(n);
+        if(directed)
+            inAllowed.resize(n);
+        for(int i=0;i<dyads.size();i++){
+            int from = dyads[i].first;
+            int to = dyads[i].second;
+            if(from < 0 || from >= n || to < 0 || to >= n)
+                Rf_error("DyadMask: dyad out of range");
+            if(from == to)
+                continue;
+            outAllowed[from].push_back(to);
+            if(directed)
+                inAllowed[to].push_back(from);
+            else
+                outAllowed[to].push_back(from);
+        }
+        for(int i=0;i<n;i++){
+            sortUnique(outAllowed[i]);
+            if(directed)
+                sortUnique(inAllowed[i]);
+        }
+    }
+
+    /*!
+     * the number of vertices
+     */
+    int size() const{
+        return n;
+    }
+
+    bool isDirected() const{
+        return directed;
+    }
+
+    bool isBlockStructured() const{
+        return nBlocks > 0;
+    }
+
+    /*!
+     * is a tie from 'from' to 'to' permitted
+     */
+    inline bool isAllowed(int from, int to) const{
+        if(from == to)
+            return false;
+        if(nBlocks > 0)
+            return blockAllowed[blocks[from] * nBlocks + blocks[to]];
+        return std::binary_search(outAllowed[from].begin(), outAllowed[from].end(), to);
+    }
+
+    /*!
+     * Collects the vertices u for which (vertex, u) or (u, vertex) is permitted and
+     * rank[u] < step, i.e. the permitted alters of vertex which precede it in
+     * a vertex ordering.
+     *
+     * \param vertex the vertex
+     * \param rank the position of each vertex in the ordering
+     * \param step the position of vertex in the ordering
+     * \param alters output
+     */
+    void priorAlters(int vertex, const std::vector<int>& rank, int step, std::vector<int>& alters) const{
+        alters.clear();
+        if(nBlocks > 0){
+            const std::vector<int>& nbrBlocks = blockNbrs[blocks[vertex]];
+            for(int b=0;b<nbrBlocks.size();b++){
+                const std::vector<int>& m = members[nbrBlocks[b]];
+                for(int k=0;k<m.size();k++)
+                    if(rank[m[k]] < step && m[k] != vertex)
+                        alters.push_back(m[k]);
+            }
+            return;
+        }
+        const std::vector<int>& out = outAllowed[vertex];
+        for(int k=0;k<out.size();k++)
+            if(rank[out[k]] < step)
+                alters.push_back(out[k]);
+        if(directed){
+            const std::vector<int>& in = inAllowed[vertex];
+            for(int k=0;k<in.size();k++)
+                if(rank[in[k]] < step && !std::binary_search(out.begin(), out.end(), in[k]))
+                    alters.push_back(in[k]);
+        }
+    }
+
+    /*!
+     * the number of permitted dyads (ordered pairs if directed, unordered otherwise)
+     */
+    double nAllowed() const{
+        double count = 0.0;
+        if(nBlocks > 0){
+            for(int a=0;a<nBlocks;a++){
+                for(int b=0;b<nBlocks;b++){
+                    if(!blockAllowed[a * nBlocks + b])
+                        continue;
+                    double na = members[a].size();
+                    double nb = members[b].size();
+                    count += a == b ? na * (na - 1.0) : na * nb;
+                }
+            }
+        }else{
+            for(int i=0;i<n;i++)
+                count += outAllowed[i].size();
+        }
+        return directed ? count : count / 2.0;
+    }
+
+    /*!
+     * The mask of a two mode network, permitting only the dyads between the
+     * first nFirst vertices and the rest
+     */
+    static boost::shared_ptr<DyadMask> betweenModes(bool isDirected, int size, int nFirst){
+        std::vector<int> modes(size);
+        for(int i=0;i<size;i++)
+            modes[i] = i < nFirst ? 0 : 1;
+        std::vector< std::vector<bool> > between(2, std::vector<bool>(2, false));
+        between[0][1] = between[1][0] = true;
+        return boost::shared_ptr<DyadMask>(new DyadMask(isDirected, modes, between));
+    }
+
+protected:
+
+    static void sortUnique(std::vector<int>& v){
+        std::sort(v.begin(), v.end());
+        v.erase(std::unique(v.begin(), v.end()), v.end());
+    }
+};
+
+}
+
+#endif /* DYADMASKH_ */
@@ -0,0 +1,393 @@
+#ifndef DYADMISSINGNESSH_
+#define DYADMISSINGNESSH_
+
+#include <vector>
+#include <algorithm>
+#include <boost/shared_ptr.hpp>
+#include <Rcpp.h>
+
+#include "Bits.h"
+
+namespace lolog{
+
+
+/*!
+ * The missing dyads of a network, held as one compressed row per vertex.
+ *
+ * Each row is stored in whichever of four forms is smallest:
+ *  - none: no dyads of the vertex are missing
+ *  - all: every dyad of the vertex is missing
+ *  - sparse: a sorted list of the missing alters
+ *  - bitmap: one bit per alter
+ *
+ * A sparse row becomes a bitmap once more than 1 in 32 of its dyads are
+ * missing, and goes back once fewer than 1 in 64 are. Whole rows are set or
+ * cleared in O(1), so marking every dyad of k vertices as missing or observed
+ * costs O(k) rather than O(k n) set inserts. Lookups are O(1) apart from
+ * sparse rows, which are binary searched, and the missing dyads of a vertex
+ * are enumerated in time proportional to their number (or to n / 64 for a
+ * bitmap row).
+ *
+ * The dyad (v, v) is never missing. Rows are directed: for undirected networks
+ * the owner keeps (i, j) and (j, i) in step.
+ *
+ * Copies share the id lists and bitmaps of their rows copy-on-write, so a
+ * copy costs O(n) and a row is only duplicated when one of the copies
+ * changes it.
+ */
+class DyadMissingness{
+protected:
+    enum{ NONE = 0, SPARSE = 1, BITMAP = 2, ALL = 3 };
+
+    typedef boost::shared_ptr< std::vector<int> > IdsPtr;
+    typedef boost::shared_ptr< std::vector<unsigned64_t> > BitsPtr;
+
+    struct Row{
+        unsigned char mode;
+        int count;      /*!< the number of missing dyads */
+        IdsPtr ids;     /*!< sorted missing alters, sparse rows only */
+        BitsPtr bits;   /*!< missing alters, bitmap rows only */
+        Row() : mode(NONE), count(0){}
+    };
+
+    int n;
+    std::vector<Row> rows;
+
+    int words() const{
+        return (n + 63) >> 6;
+    }
+
+    /*!
+     * the id list of a row, for writing. Copies it if it is shared.
+     */
+    static std::vector<int>& writableIds(Row& r){
+        if(!r.ids)
+            r.ids = IdsPtr(new std::vector<int>());
+        else if(!r.ids.unique())
+            r.ids = IdsPtr(new std::vector<int>(*r.ids));
+        return *r.ids;
+    }
+
+    /*!
+     * the bitmap of a row, for writing. Copies it if it is shared.
+     */
+    static std::vector<unsigned64_t>& writableBits(Row& r){
+        if(!r.bits.unique())
+            r.bits = BitsPtr(new std::vector<unsigned64_t>(*r.bits));
+        return *r.bits;
+    }
+
+    void makeBitmap(int v){
+        Row& r = rows[v];
+        BitsPtr b(new std::vector<unsigned64_t>(words(), 0ULL));
+        if(r.mode == ALL){
+            std::fill(b->begin(), b->end(), ~0ULL);
+            if(n & 63)
+                b->back() = (1ULL << (n & 63)) - 1ULL;
+            (*b)[v >> 6] &= ~(1ULL << (v & 63));
+        }else if(r.ids){
+            const std::vector<int>& ids = *r.ids;
+            for(int k=0;k<ids.size();k++)
+                (*b)[ids[k] >> 6] |= 1ULL << (ids[k] & 63);
+        }
+        r.bits = b;
+        r.ids.reset();
+        r.mode = BITMAP;
+    }
+
+    void makeSparse(int v){
+        Row& r = rows[v];
+        IdsPtr ids(new std::vector<int>());
+        ids->reserve(r.count);
+        missingAlters(v, *ids);
+        r.ids = ids;
+        r.bits.reset();
+        r.mode = SPARSE;
+    }
+
+    /*!
+     * picks the form of row v after its count has changed
+     */
+    void rebalance(int v){
+        Row& r = rows[v];
+        if(r.count == 0)
+            clearRow(v);
+        else if(r.count == n - 1)
+            fillRow(v);
+        else if(r.mode == SPARSE && r.count > n / 32)
+            makeBitmap(v);
+        else if(r.mode == BITMAP && r.count < n / 64)
+            makeSparse(v);
+    }
+
+    void fillRow(int v){
+        Row& r = rows[v];
+        r.ids.reset();
+        r.bits.reset();
+        r.mode = ALL;
+        r.count = n - 1;
+    }
+
+    void clearRow(int v){
+        Row& r = rows[v];
+        r.ids.reset();
+        r.bits.reset();
+        r.mode = NONE;
+        r.count = 0;
+    }
+
+    /*!
+     * replaces row v with the sorted missing alters ids
+     */
+    void assignRow(int v, std::vector<int>& ids){
+        Row& r = rows[v];
+        clearRow(v);
+        if(ids.empty())
+            return;
+        r.ids = IdsPtr(new std::vector<int>());
+        r.ids->swap(ids);
+        r.mode = SPARSE;
+        r.count = r.ids->size();
+        rebalance(v);
+    }
+
+public:
+
+    DyadMissingness() : n(0){}
+
+    /*!
+     * n vertices without missing dyads
+     */
+    DyadMissingness(int size) : n(size), rows(size){}
+
+    /*!
+     * the number of vertices
+     */
+    int size() const{
+        return n;
+    }
+
+    /*!
+     * is the dyad (from, to) missing
+     */
+    inline bool isMissing(int from, int to) const{
+        const Row& r = rows[from];
+        switch(r.mode){
+        case NONE:
+            return false;
+        case ALL:
+            return from != to;
+        case BITMAP:
+            return ((*r.bits)[to >> 6] >> (to & 63)) & 1ULL;
+        default:
+            return std::binary_search(r.ids->begin(), r.ids->end(), to);
+        }
+    }
+
+    /*!
+     * sets the missingness of the dyad (from, to)
+     *
+     * \returns true if the dyad was missing
+     */
+    bool setMissing(int from, int to, bool value){
+        if(from == to)
+            return false;
+        bool was = isMissing(from, to);
+        if(was == value)
+            return was;
+        Row& r = rows[from];
+        if(r.mode == ALL)
+            makeBitmap(from);
+        if(r.mode == BITMAP){
+            writableBits(r)[to >> 6] ^= 1ULL << (to & 63);
+        }else{
+            r.mode = SPARSE;
+            std::vector<int>& ids = writableIds(r);
+            std::vector<int>::iterator it = std::lower_bound(ids.begin(), ids.end(), to);
+            if(value)
+                ids.insert(it, to);
+            else
+                ids.erase(it);
+        }
+        r.count += value ? 1 : -1;
+        rebalance(from);
+        return was;
+    }
+
+    /*!
+     * the number of missing dyads of vertex v
+     */
+    int nMissing(int v) const{
+        return rows[v].count;
+    }
+
+    /*!
+     * marks every dyad of vertex v as missing or observed, in O(1)
+     */
+    void setRow(int v, bool missing){
+        if(missing)
+            fillRow(v);
+        else
+            clearRow(v);
+    }
+
+    /*!
+     * marks every dyad as missing or observed
+     */
+    void setAll(bool missing){
+        for(int i=0;i<n;i++)
+            setRow(i, missing);
+    }
+
+    /*!
+     * appends the missing alters of v which are at least lo to out, in
+     * increasing order
+     */
+    void missingAlters(int v, std::vector<int>& out, int lo = 0) const{
+        const Row& r = rows[v];
+        switch(r.mode){
+        case NONE:
+            return;
+        case ALL:
+            for(int j=std::max(lo, 0);j<n;j++)
+                if(j != v)
+                    out.push_back(j);
+            return;
+        case BITMAP:
+            for(int w=std::max(lo, 0) >> 6;w<r.bits->size();w++){
+                unsigned64_t word = (*r.bits)[w];
+                if(w == (lo >> 6) && lo > 0)
+                    word &= ~0ULL << (lo & 63);
+                while(word){
+                    out.push_back((w << 6) + lowestBit(word));
+                    word &= word - 1ULL;
+                }
+            }
+            return;
+        default:
+            out.insert(out.end(), std::lower_bound(r.ids->begin(), r.ids->end(), lo), r.ids->end());
+        }
+    }
+
+    /*!
+     * the k-th missing alter of v (0 indexed, in increasing order)
+     */
+    int nthMissing(int v, int k) const{
+        const Row& r = rows[v];
+        switch(r.mode){
+        case ALL:
+            return k < v ? k : k + 1;
+        case SPARSE:
+            return (*r.ids)[k];
+        case BITMAP:
+            for(int w=0;w<r.bits->size();w++){
+                unsigned64_t word = (*r.bits)[w];
+                int c = bitCount(word);
+                if(k < c){
+                    while(k-- > 0)
+                        word &= word - 1ULL;
+                    return (w << 6) + lowestBit(word);
+                }
+                k -= c;
+            }
+        }
+        ::Rf_error("DyadMissingness: missing dyad out of range");
+        return -1;
+    }
+
+    /*!
+     * a uniformly drawn missing alter of v. v must have missing dyads.
+     */
+    int randomMissing(int v) const{
+        const Row& r = rows[v];
+        if(r.count == 0)
+            ::Rf_error("randomMissingDyad: no missing dyads");
+        if(r.mode == BITMAP && r.count > 0.05 * (n - 1)){
+            for(int i=0;i<15;i++){
+                int alter = floor(Rf_runif(0, n - 1.0));
+                if(alter >= v)
+                    alter++;
+                if(isMissing(v, alter))
+                    return alter;
+            }
+        }
+        int k = std::min((int) floor(Rf_runif(0, (double) r.count)), r.count - 1);
+        return nthMissing(v, k);
+    }
+
+    /*!
+     * adds a vertex without missing dyads. Rows with all dyads missing also
+     * treat their dyad with the new vertex as missing.
+     */
+    void addVertex(){
+        n++;
+        int w = words();
+        for(int i=0;i<rows.size();i++){
+            Row& r = rows[i];
+            if(r.mode == BITMAP && r.bits->size() < w)
+                writableBits(r).resize(w, 0ULL);
+            else if(r.mode == ALL)
+                r.count = n - 1;
+        }
+        rows.push_back(Row());
+    }
+
+    /*!
+     * removes vertex v. Vertices above v move down by one.
+     */
+    void removeVertex(int v){
+        rows.erase(rows.begin() + v);
+        n--;
+        std::vector<int> ids;
+        for(int i=0;i<n;i++){
+            Row& r = rows[i];
+            if(r.mode == NONE)
+                continue;
+            if(r.mode == ALL){
+                r.count = n - 1;
+                continue;
+            }
+            ids.clear();
+            missingAlters(i, ids);
+            std::vector<int> kept;
+            kept.reserve(ids.size());
+            for(int k=0;k<ids.size();k++){
+                if(ids[k] != v)
+                    kept.push_back(ids[k] > v ? ids[k] - 1 : ids[k]);
+            }
+            assignRow(i, kept);
+        }
+    }
+
+    /*!
+     * renumbers the vertices so that new vertex i is old vertex order[i]
+     */
+    void relabel(const std::vector<int>& order){
+        std::vector<int> newId(n);
+        for(int i=0;i<n;i++)
+            newId[order[i]] = i;
+        std::vector<Row> old;
+        old.swap(rows);
+        rows.resize(n);
+        std::vector<int> ids;
+        for(int i=0;i<n;i++){
+            Row& r = old[order[i]];
+            if(r.mode == NONE || r.mode == ALL){
+                std::swap(rows[i], r);
+                continue;
+            }
+            std::swap(rows[i], r);
+            ids.clear();
+            missingAlters(i, ids);
+            std::vector<int> mapped(ids.size());
+            for(int k=0;k<ids.size();k++)
+                mapped[k] = newId[ids[k]];
+            std::sort(mapped.begin(), mapped.end());
+            assignRow(i, mapped);
+        }
+    }
+};
+
+}
+
+#endif /* DYADMISSINGNESSH_ */
@@ -0,0 +1,161 @@
+#ifndef GENERATIONCHECKPOINT_H_
+#define GENERATIONCHECKPOINT_H_
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <utility>
+#include <iterator>
+#include <boost/random/mersenne_twister.hpp>
+
+#include <Rcpp.h>
+
+#include "SnapshotCodec.h"
+#include "util.h"
+
+namespace lolog{
+
+
+/*!
+ * The state of a latent order network generation, sufficient to continue
+ * the generation from where it left off.
+ *
+ * The model terms are not stored directly. Instead, the accepted edges are
+ * kept in the order they were added, together with the step at which each
+ * was added, so that the terms can be rebuilt exactly by replaying them
+ * (including terms that depend on the order of edge addition).
+ */
+struct GenerationCheckpoint{
+
+    static const int version = 1;
+
+    int n;                          /*!< number of vertices */
+    int step;                       /*!< the current vertex index in the ordering */
+    int alter;                      /*!< the next alter index within the current step */
+    std::vector<int> vertOrder;     /*!< the vertex ordering */
+    std::vector<int> workingOrder;  /*!< the (partially shuffled) working ordering */
+    std::vector<int> edgeFrom;      /*!< accepted edges, in the order they were added */
+    std::vector<int> edgeTo;
+    std::vector<int> edgeStep;      /*!< the step at which each edge was added */
+    std::vector<double> thetas;     /*!< the parameter values used */
+    std::vector<double> emptyStats; /*!< statistics of the empty network */
+    std::vector<double> stats;      /*!< accumulated change statistics of accepted edges */
+    std::vector<double> eStats;     /*!< accumulated expected change statistics */
+    boost::random::mt19937 rng;     /*!< the uniform stream */
+
+    GenerationCheckpoint() : n(0), step(0), alter(0){}
+
+    void addEdge(int from, int to, int st){
+        edgeFrom.push_back(from);
+        edgeTo.push_back(to);
+        edgeStep.push_back(st);
+    }
+
+    /*!
+     * Writes the checkpoint to file. The file is first written to a temporary
+     * location and then renamed, so an interruption while writing does not
+     * destroy the previous checkpoint.
+     */
+    void save(const std::string& file) const{
+        std::string tmpFile = file + ".tmp";
+        std::ofstream stream(tmpFile.c_str(), std::ios::binary | std::ios::trunc);
+        if(!stream)
+            Rcpp::stop("GenerationCheckpoint: unable to open " + tmpFile + " for writing");
+        SnapshotWriter out(stream);
+        out.writeRaw("LOLOGGEN", 8);
+        out.writeInt(version);
+        out.writeInt(n);
+        out.writeInt(step);
+        out.writeInt(alter);
+        out.writeVector(vertOrder);
+        out.writeVector(workingOrder);
+        out.writeVector(edgeFrom);
+        out.writeVector(edgeTo);
+        out.writeVector(edgeStep);
+        out.writeVector(thetas);
+        out.writeVector(emptyStats);
+        out.writeVector(stats);
+        out.writeVector(eStats);
+        std::stringstream ss;
+        ss << rng;
+        out.writeString(ss.str());
+        stream.close();
+        if(!stream)
+            Rcpp::stop("GenerationCheckpoint: error writing " + tmpFile);
+        std::remove(file.c_str());
+        if(std::rename(tmpFile.c_str(), file.c_str()) != 0)
+            Rcpp::stop("GenerationCheckpoint: unable to move checkpoint to " + file);
+    }
+
+    /*!
+     * Reads a checkpoint from file, checking that it is consistent with a
+     * model of nVertices vertices and nStats statistics
+     */
+    void load(const std::string& file, int nVertices, int nStats){
+        std::ifstream stream(file.c_str(), std::ios::binary);
+        if(!stream)
+            Rcpp::stop("GenerationCheckpoint: unable to open " + file);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(stream)),
+                std::istreambuf_iterator<char>());
+        SnapshotReader in(bytes, "Generation checkpoint");
+        char magic[8];
+        in.readRaw(magic, 8);
+        if(std::string(magic, 8) != "LOLOGGEN")
+            Rcpp::stop("GenerationCheckpoint: " + file + " is not a generation checkpoint");
+        int v = in.readInt();
+        if(v != version)
+            Rcpp::stop("GenerationCheckpoint: unsupported checkpoint version " + asString(v));
+        n = in.readInt();
+        if(n != nVertices)
+            Rcpp::stop("GenerationCheckpoint: the checkpoint has " + asString(n) +
+                    " vertices, but the network has " + asString(nVertices));
+        step = in.readInt();
+        alter = in.readInt();
+        if(step < 0 || step > n || alter < 0 || alter > step || (step == n && alter != 0))
+            in.corrupt();
+        vertOrder = in.readVector<int>();
+        workingOrder = in.readVector<int>();
+        if(!isPermutation(vertOrder) || !isPermutation(workingOrder))
+            in.corrupt();
+        edgeFrom = in.readVector<int>();
+        edgeTo = in.readVector<int>();
+        edgeStep = in.readVector<int>();
+        if(edgeTo.size() != edgeFrom.size() || edgeStep.size() != edgeFrom.size())
+            in.corrupt();
+        for(int k=0;k<edgeFrom.size();k++)
+            if(edgeFrom[k] < 0 || edgeFrom[k] >= n || edgeTo[k] < 0 || edgeTo[k] >= n ||
+                    edgeFrom[k] == edgeTo[k] || edgeStep[k] < 0 || edgeStep[k] > step)
+                in.corrupt();
+        thetas = in.readVector<double>();
+        emptyStats = in.readVector<double>();
+        stats = in.readVector<double>();
+        eStats = in.readVector<double>();
+        if(thetas.size() != nStats || emptyStats.size() != nStats ||
+                stats.size() != nStats || eStats.size() != nStats)
+            Rcpp::stop("GenerationCheckpoint: the checkpoint was written by a different model");
+        std::stringstream ss(in.readString());
+        if(!in.atEnd())
+            in.corrupt();
+        ss >> rng;
+    }
+
+protected:
+    //true if vec holds each of 0 to n - 1 once
+    bool isPermutation(const std::vector<int>& vec) const{
+        if(vec.size() != n)
+            return false;
+        std::vector<bool> seen(n, false);
+        for(int i=0;i<n;i++){
+            if(vec[i] < 0 || vec[i] >= n || seen[vec[i]])
+                return false;
+            seen[vec[i]] = true;
+        }
+        return true;
+    }
+};
+
+}
+
+#endif /* GENERATIONCHECKPOINT_H_ */
@@ -4,12 +4,18 @@
 #include "Model.h"
 #include "ShallowCopyable.h"
 #include "Ranker.h"
+#include "GenerationCheckpoint.h"
+#include "DyadMask.h"
+#include "CsrNetwork.h"
 
 #include <cmath>
 #include <Rcpp.h>
 #include <assert.h>
 #include <vector>
 #include <iterator>
+#include <algorithm>
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_01.hpp>
 
 namespace lolog{
 
@@ -45,18 +51,9 @@ protected:
   //VectorPtr order;
   
   /**
-   * Fisher-Yates shuffle of elements up to offset
+   * The dyads which may hold ties. NULL if all dyads are permitted.
    */
-  template<class T>
-  void shuffle(std::vector<T>& vec, long offset){
-    for( int i=0; i < offset - 1.0; i++){
-      //long ind = floor(Rf_runif(0.0,1.0)*offset);
-      long ind = floor(Rf_runif(i,offset));
-      T tmp = vec[i];
-      vec[i] = vec[ind];
-      vec[ind] = tmp;
-    }
-  }
+  boost::shared_ptr<DyadMask> mask;
   
   /**
    * Generates a vertex ordering 'vertexOrder' conditional upon a possibly
@@ -80,8 +77,199 @@ protected:
   void removeEdges(ModelPtr mod){
     mod->network()->emptyGraph();
   }
+  
+  /**
+   * The position of each vertex in vert_order
+   */
+  static std::vector<int> ranks(const std::vector<int>& vert_order){
+    std::vector<int> rankOrder(vert_order.size());
+    for(int i=0;i<vert_order.size();i++)
+      rankOrder[vert_order[i]] = i;
+    return rankOrder;
+  }
+
+  /**
+   * Grows a network from the empty graph in runningModel, using a private
+   * uniform stream seeded with 'seed' in place of R's RNG. Two calls with the same
+   * seed and order consume identical uniforms, so draws at different parameter
+   * values are coupled. Does not touch the R API, so may be run off the main thread.
+   */
+  static void generateCoupledNetwork(ModelPtr runningModel, const std::vector<int>& vert_order,
+                                     unsigned int seed, std::vector<double>& stats,
+                                     std::vector<double>& eStats, const DyadMask* mask){
+    boost::random::mt19937 rng(seed);
+    boost::random::uniform_01<double> unif;
+    long n = vert_order.size();
+    int nStats = stats.size();
+    bool directedGraph = runningModel->network()->isDirected();
+    std::vector<double> change(nStats);
+    std::vector<int> workingVertOrder = vert_order;
+    std::vector<int> order = vert_order;
+    std::vector<int> rankOrder, maskAlters;
+    if(mask != NULL)
+      rankOrder = ranks(vert_order);
+    double llikChange, probTie;
+    for(int i=0; i < n; i++){
+      int vertex = workingVertOrder[i];
+      //the alters of vertex, in random order
+      std::vector<int>& alters = mask != NULL ? maskAlters : workingVertOrder;
+      if(mask != NULL)
+        mask->priorAlters(vertex, rankOrder, i, maskAlters);
+      int nAlters = mask != NULL ? maskAlters.size() : i;
+      for(int k=0; k < nAlters - 1; k++){
+        long ind = floor(k + (nAlters - k) * unif(rng));
+        std::swap(alters[k], alters[ind]);
+      }
+      for(int j=0; j < nAlters; j++){
+        int alter = alters[j];
+        for(int d=0; d < (directedGraph ? 2 : 1); d++){
+          int from = d == 0 ? vertex : alter;
+          int to = d == 0 ? alter : vertex;
+          if(mask != NULL && !mask->isAllowed(from, to))
+            continue;
+          if(runningModel->isDyadBlocked(from, to)){
+            //a tie with zero probability. The uniform keeps the draws coupled
+            unif(rng);
+            continue;
+          }
+          llikChange = runningModel->dyadUpdateChange(from, to, order, i, change);
+          probTie = 1.0 / (1.0 + exp(-llikChange));
+          bool hasEdge = unif(rng) < probTie;
+          if(hasEdge)
+            runningModel->network()->toggle(from, to);
+          else
+            runningModel->rollback();
+          for(int m=0; m<nStats; m++){
+            eStats[m] += change[m] * probTie;
+            if(hasEdge)
+              stats[m] += change[m];
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Continues the generation described by cp with runningModel, whose terms must
+   * already reflect the edges in cp. Dyads ruled out by the dyad mask are
+   * skipped. The checkpoint is written to file every
+   * checkpointEvery dyads and whenever an interrupt is caught. If maxDyads > 0
+   * the generation stops after that many dyads, writing a checkpoint and
+   * returning NULL.
+   */
+  Rcpp::RObject runCheckpointedGeneration(GenerationCheckpoint& cp, ModelPtr runningModel,
+                                          std::string file, long checkpointEvery,
+                                          long interruptEvery, bool verbose, long maxDyads){
+    int n = cp.n;
+    int nStats = cp.stats.size();
+    bool directedGraph = runningModel->network()->isDirected();
+    boost::random::uniform_01<double> unif;
+    std::vector<double> change(nStats);
+    double llikChange, probTie;
+    long sinceCheckpoint = 0;
+    long sinceInterrupt = 0;
+    long drawn = 0;
+    for(int i=cp.step; i < n; i++){
+      int vertex = cp.workingOrder[i];
+      if(cp.alter == 0){
+        for(int k=0; k < i - 1; k++){
+          long ind = floor(k + (i - k) * unif(cp.rng));
+          std::swap(cp.workingOrder[k], cp.workingOrder[ind]);
+        }
+      }
+      for(int j=cp.alter; j < i; j++){
+        int alter = cp.workingOrder[j];
+        for(int d=0; d < (directedGraph ? 2 : 1); d++){
+          int from = d == 0 ? vertex : alter;
+          int to = d == 0 ? alter : vertex;
+          if((mask && !mask->isAllowed(from, to)) || runningModel->isDyadBlocked(from, to)){
+            //a structural zero or a tie with zero probability (see growNetwork). The
+            //uniform keeps the stream aligned with generation without a mask
+            unif(cp.rng);
+            continue;
+          }
+          llikChange = runningModel->dyadUpdateChange(from, to, cp.vertOrder, i, change);
+          probTie = 1.0 / (1.0 + exp(-llikChange));
+          bool hasEdge = unif(cp.rng) < probTie;
+          if(hasEdge){
+            runningModel->network()->toggle(from, to);
+            cp.addEdge(from, to, i);
+          }else
+            runningModel->rollback();
+          for(int m=0; m<nStats; m++){
+            cp.eStats[m] += change[m] * probTie;
+            if(hasEdge)
+              cp.stats[m] += change[m];
+          }
+        }
+        sinceCheckpoint++;
+        sinceInterrupt++;
+        if(interruptEvery > 0 && sinceInterrupt >= interruptEvery){
+          sinceInterrupt = 0;
+          try{
+            Rcpp::checkUserInterrupt();
+          }catch(...){
+            cp.step = i;
+            cp.alter = j + 1;
+            if(file.size() > 0)
+              cp.save(file);
+            throw;
+          }
+        }
+        if(checkpointEvery > 0 && sinceCheckpoint >= checkpointEvery && file.size() > 0){
+          sinceCheckpoint = 0;
+          cp.step = i;
+          cp.alter = j + 1;
+          cp.save(file);
+          if(verbose)
+            Rcpp::Rcout << "Checkpoint: vertex " << i + 1 << " of " << n << ", "
+                        << cp.edgeFrom.size() << " edges\n";
+        }
+        drawn++;
+        if(maxDyads > 0 && drawn >= maxDyads){
+          cp.step = i;
+          cp.alter = j + 1;
+          if(file.size() > 0)
+            cp.save(file);
+          return R_NilValue;
+        }
+      }
+      cp.alter = 0;
+    }
+    cp.step = n;
+    cp.alter = 0;
+    if(file.size() > 0)
+      cp.save(file);
+
+    std::vector<int> rankOrder = cp.vertOrder;
+    for(int i=0;i<cp.vertOrder.size();i++)
+      rankOrder[cp.vertOrder[i]] = i;
+    DiscreteAttrib attr = DiscreteAttrib();
+    attr.setName("__order__");
+    runningModel->network()->addDiscreteVariable(rankOrder, attr);
+    List result;
+    result["network"] = runningModel->network()->cloneR();
+    result["emptyNetworkStats"] = wrap(cp.emptyStats);
+    result["stats"] = wrap(cp.stats);
+    result["expectedStats"] = wrap(cp.eStats);
+    return result;
+  }
 public:
   
+  /**
+   * Fisher-Yates shuffle of elements up to offset
+   */
+  template<class T>
+  static void shuffle(std::vector<T>& vec, long offset){
+    for( int i=0; i < offset - 1.0; i++){
+      //long ind = floor(Rf_runif(0.0,1.0)*offset);
+      long ind = floor(Rf_runif(i,offset));
+      T tmp = vec[i];
+      vec[i] = vec[ind];
+      vec[ind] = tmp;
+    }
+  }
+  
   LatentOrderLikelihood(){}
   
   LatentOrderLikelihood(Model<Engine> mod){
@@ -91,6 +279,8 @@ public:
     removeEdges(noTieModel);
     if(model->hasVertexOrder() && model->getVertexOrder()->size() != model->network()->size())
       Rf_error("Vertex ordering does not have the same number of elements as there are vertices in the network 95.");
+    if(model->network()->isBipartite())
+      mask = modeMask();
   }
   
   /*!
@@ -102,6 +292,7 @@ public:
     model = xp->model;
     noTieModel = xp->noTieModel;
     order = xp->order;
+    mask = xp->mask;
   }
   
   /*!
@@ -123,6 +314,10 @@ public:
     noTieModel->setNetwork(mod.network()->clone());
     removeEdges(noTieModel);
     noTieModel->calculate();
+    if(mask)
+      setDyadMask(mask);
+    else if(model->network()->isBipartite())
+      mask = modeMask();
   }
   
   
@@ -131,6 +326,102 @@ public:
     noTieModel->setThetas(newThetas);
   }
   
+  /*!
+   * Restricts ties to the dyads permitted by m. The observed network must not
+   * have ties outside of the mask.
+   */
+  void setDyadMask(boost::shared_ptr<DyadMask> m){
+    BinaryNet<Engine>& net = *model->network();
+    if(m->size() != net.size() || m->isDirected() != net.isDirected())
+      Rf_error("setDyadMask: the mask does not match the network");
+    for(typename BinaryNet<Engine>::EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++)
+      if(!m->isAllowed(it->first, it->second))
+        Rf_error("setDyadMask: the network has a tie between %d and %d, which the mask does not permit",
+                 it->first + 1, it->second + 1);
+    mask = m;
+  }
+  
+  /*!
+   * The mask of a bipartite network, permitting only the dyads between modes
+   */
+  boost::shared_ptr<DyadMask> modeMask(){
+    BinaryNet<Engine>& net = *model->network();
+    return DyadMask::betweenModes(net.isDirected(), net.size(), net.firstModeSize());
+  }
+  
+  /*!
+   * Sets a block structured dyad mask (see DyadMask). For bipartite networks
+   * the blocks are further split by mode, so that only dyads between the modes
+   * are permitted.
+   *
+   * \param blocks the block (1 to nrow(allowed)) of each vertex
+   * \param allowed a square matrix, true where ties from the row block to the
+   *        column block are permitted
+   */
+  void setDyadMaskBlocks(IntegerVector blocks, LogicalMatrix allowed){
+    if(allowed.nrow() != allowed.ncol())
+      Rf_error("setDyadMaskBlocks: allowed must be a square matrix");
+    std::vector<int> b(blocks.size());
+    for(int i=0; i<blocks.size(); i++)
+      b[i] = blocks[i] - 1;
+    std::vector< std::vector<bool> > a(allowed.nrow(), std::vector<bool>(allowed.ncol()));
+    for(int i=0; i<allowed.nrow(); i++)
+      for(int j=0; j<allowed.ncol(); j++)
+        a[i][j] = allowed(i, j) == 1;
+    BinaryNet<Engine>& net = *model->network();
+    if(net.isBipartite() && b.size() == net.size()){
+      //block (k, mode) becomes block 2 * k + mode
+      int nb = a.size();
+      for(int i=0; i<b.size(); i++)
+        b[i] = 2 * b[i] + (i < net.firstModeSize() ? 0 : 1);
+      std::vector< std::vector<bool> > split(2 * nb, std::vector<bool>(2 * nb, false));
+      for(int k=0; k<nb; k++)
+        for(int l=0; l<nb; l++)
+          split[2 * k][2 * l + 1] = split[2 * k + 1][2 * l] = a[k][l];
+      a = split;
+    }
+    setDyadMask(boost::shared_ptr<DyadMask>(
+        new DyadMask(model->network()->isDirected(), b, a)));
+  }
+  
+  /*!
+   * Sets a dyad mask from a two column matrix of (1-indexed) permitted dyads
+   */
+  void setDyadMaskDyads(IntegerMatrix dyads){
+    if(dyads.ncol() != 2)
+      Rf_error("setDyadMaskDyads: dyads must have two columns");
+    BinaryNet<Engine>& net = *model->network();
+    std::vector< std::pair<int,int> > d;
+    d.reserve(dyads.nrow());
+    for(int i=0; i<dyads.nrow(); i++){
+      int from = dyads(i, 0) - 1;
+      int to = dyads(i, 1) - 1;
+      //dyads within a mode of a bipartite network can not hold ties
+      if(net.isBipartite() && (from < net.firstModeSize()) == (to < net.firstModeSize()))
+        continue;
+      d.push_back(std::make_pair(from, to));
+    }
+    setDyadMask(boost::shared_ptr<DyadMask>(
+        new DyadMask(model->network()->size(), model->network()->isDirected(), d)));
+  }
+  
+  /*!
+   * Removes the dyad mask, so that all dyads are permitted (all dyads between
+   * the modes for bipartite networks)
+   */
+  void clearDyadMask(){
+    mask.reset();
+    if(model->network()->isBipartite())
+      mask = modeMask();
+  }
+  
+  /*!
+   * The number of permitted dyads
+   */
+  double nPermittedDyads(){
+    return mask ? mask->nAllowed() : (double) model->network()->maxEdges();
+  }
+  
   ModelPtr getModel(){
     return model;
   }
@@ -142,6 +433,22 @@ public:
   Rcpp::RObject getModelR(){
     return wrap(*model);
   }
+
+  /*!
+   * Turns term instrumentation on or off. The model and the models used to
+   * generate networks share a single set of counters.
+   */
+  void setProfiling(bool on){
+    model->setProfiling(on);
+    noTieModel->setProfiler(model->getProfiler());
+  }
+
+  /*!
+   * The instrumentation counters for R
+   */
+  Rcpp::List profile(){
+    return model->profileR();
+  }
   
   List variationalModelFrame(int nOrders, double downsampleRate){
     List result;
@@ -182,16 +489,23 @@ public:
     ModelPtr runningModel = noTieModel->clone();
     runningModel->setNetwork(noTieModel->network()->clone());
     runningModel->calculate();
+    //the observed network is only read, so query a flat copy of it
+    CsrNetwork observed(*model->network());
     List samples;
-    std::vector<double> terms = runningModel->statistics();
-    std::vector<double>  newTerms = runningModel->statistics();
+    std::vector<double> change(runningModel->statistics().size());
+    //terms that can compute change statistics without an update need no rollback
+    bool readOnly = runningModel->hasChangeStats();
     
     std::vector<int> workingVertOrder = vert_order;
+    std::vector<int> rankOrder, maskAlters;
+    if(mask)
+      rankOrder = ranks(vert_order);
     
     std::vector<int> outcome;
-    std::vector< std::vector<double> > predictors(terms.size());
+    std::vector< std::vector<double> > predictors(change.size());
+    double nDyads = mask ? mask->nAllowed() : noTieModel->network()->maxEdges();
     for(int i=0;i<predictors.size();i++){
-      predictors.at(i).reserve(floor(downsampleRate * noTieModel->network()->maxEdges()) + 1000);
+      predictors.at(i).reserve(floor(downsampleRate * nDyads) + 1000);
     }
     
     bool sample;
@@ -199,25 +513,36 @@ public:
     //double lpartition = 0.0;
     for(int i=0; i < n; i++){
       int vertex = workingVertOrder[i];
-      this->shuffle(workingVertOrder,i);
-      for(int j=0; j < i; j++){
-        int alter = workingVertOrder[j];
+      //the alters of vertex, in random order
+      std::vector<int>& alters = mask ? maskAlters : workingVertOrder;
+      if(mask)
+        mask->priorAlters(vertex, rankOrder, i, maskAlters);
+      int nAlters = mask ? maskAlters.size() : i;
+      this->shuffle(alters,nAlters);
+      for(int j=0; j < nAlters; j++){
+        int alter = alters[j];
         sample = Rf_runif(0.0,1.0) < downsampleRate;
         assert(!runningModel->network()->hasEdge(vertex, alter));
-        bool hasEdge = model->network()->hasEdge(vertex, alter);
-        if(sample){
-          runningModel->statistics(terms);
-          runningModel->dyadUpdate(vertex, alter, vert_order, i);
-          runningModel->statistics(newTerms);
-          
-          if(hasEdge){
-            runningModel->network()->toggle(vertex, alter);
+        bool hasEdge = observed.hasEdge(vertex, alter);
+        if(mask && !mask->isAllowed(vertex, alter)){
+          //a structural zero, which is never part of the frame
+        }else if(sample){
+          if(readOnly){
+            runningModel->changeStatistics(vertex, alter, vert_order, i, change);
+            if(hasEdge)
+              runningModel->commitDyad(vertex, alter, vert_order, i);
           }else{
-            runningModel->rollback();
+            runningModel->dyadUpdateChange(vertex, alter, vert_order, i, change);
+            
+            if(hasEdge){
+              runningModel->network()->toggle(vertex, alter);
+            }else{
+              runningModel->rollback();
+            }
           }
           outcome.push_back(hasEdge);
-          for(int k=0; k<terms.size(); k++){
-            predictors[k].push_back(newTerms[k] - terms[k]);
+          for(int k=0; k<change.size(); k++){
+            predictors[k].push_back(change[k]);
           }
         }else{
           if(hasEdge){
@@ -226,21 +551,25 @@ public:
           }
         }
         
-        if(runningModel->network()->isDirected()){
-          hasEdge = model->network()->hasEdge(alter, vertex);
+        if(runningModel->network()->isDirected() && (!mask || mask->isAllowed(alter, vertex))){
+          hasEdge = observed.hasEdge(alter, vertex);
           if(sample){
-            runningModel->statistics(terms);
-            runningModel->dyadUpdate(alter, vertex, vert_order, i);
-            runningModel->statistics(newTerms);
-            
-            if(hasEdge){
-              runningModel->network()->toggle(alter, vertex);
+            if(readOnly){
+              runningModel->changeStatistics(alter, vertex, vert_order, i, change);
+              if(hasEdge)
+                runningModel->commitDyad(alter, vertex, vert_order, i);
             }else{
-              runningModel->rollback();
+              runningModel->dyadUpdateChange(alter, vertex, vert_order, i, change);
+              
+              if(hasEdge){
+                runningModel->network()->toggle(alter, vertex);
+              }else{
+                runningModel->rollback();
+              }
             }
             outcome.push_back(hasEdge);
-            for(int k=0; k<terms.size(); k++){
-              predictors[k].push_back(newTerms[k] - terms[k]);
+            for(int k=0; k<change.size(); k++){
+              predictors[k].push_back(change[k]);
             }
           }else{
             if(hasEdge){
@@ -295,7 +624,122 @@ public:
   
   
   
+  /**
+   * Grows a network from the empty graph in runningModel following the vertex
+   * order, drawing ties with R's RNG. Accumulates the statistics of the draw
+   * and their expectations into stats and eStats. If changeStats is not NULL,
+   * the change statistics of each dyad are stored in it.
+   *
+   * Templated on the model so that statically composed models (see StaticModel)
+   * can use the same generator. Must be called between GetRNGstate and PutRNGstate.
+   *
+   * If mask is not NULL, only the permitted dyads are visited. Change statistics
+   * can not be stored with a mask. Only the dyads between the modes of a
+   * bipartite network are visited.
+   */
+  template<class ModelType>
+  static void growNetwork(ModelType& runningModel, const std::vector<int>& vert_order,
+                          std::vector<double>& stats, std::vector<double>& eStats,
+                          Rcpp::List* changeStats, const DyadMask* mask = NULL){
+    long n = vert_order.size();
+    long nStats = stats.size();
+    bool directedGraph = runningModel.network()->isDirected();
+    std::vector<int> order = vert_order;
+    boost::shared_ptr<DyadMask> modes;
+    if(mask == NULL && runningModel.network()->isBipartite()){
+      if(changeStats != NULL)
+        Rf_error("growNetwork: change statistics can not be stored for a bipartite network");
+      modes = DyadMask::betweenModes(directedGraph, n, runningModel.network()->firstModeSize());
+      mask = modes.get();
+    }
+    
+    //change statistics for the current dyad
+    std::vector<double> change(nStats);
+    
+    std::vector<int> workingVertOrder = vert_order;
+    std::vector<int> rankOrder, maskAlters;
+    if(mask != NULL)
+      rankOrder = ranks(vert_order);
+    
+    
+    double llikChange, probTie;//, ldenom;
+    bool hasEdge = false;
+    for(int i=0; i < n; i++){
+      int vertex = workingVertOrder[i];
+      //the alters of vertex, in random order
+      std::vector<int>& alters = mask != NULL ? maskAlters : workingVertOrder;
+      if(mask != NULL)
+        mask->priorAlters(vertex, rankOrder, i, maskAlters);
+      int nAlters = mask != NULL ? maskAlters.size() : i;
+      shuffle(alters,nAlters);
+      for(int j=0; j < nAlters; j++){
+        int alter = alters[j];
+        if(mask == NULL || mask->isAllowed(vertex, alter)){
+          assert(!runningModel.network()->hasEdge(vertex, alter));
+          if(changeStats == NULL && runningModel.isDyadBlocked(vertex, alter)){
+            //a tie with zero probability. The terms are not updated, but the uniform
+            //is still drawn so that the draw matches generation without pruning
+            Rf_runif(0.0, 1.0);
+          }else{
+            llikChange = runningModel.dyadUpdateChange(vertex, alter, order, i, change);
+            probTie = 1.0 / (1.0 + exp(-llikChange));
+            hasEdge = false;
+            if(Rf_runif(0.0, 1.0) < probTie){
+              runningModel.network()->toggle(vertex, alter);
+              hasEdge = true;
+            }else
+              runningModel.rollback();
+        
+            //update the generated network statistics and expected statistics
+            for(int m=0; m<nStats; m++){
+              eStats[m] += change[m] * probTie;
+              if(hasEdge)
+                stats[m] += change[m];
+            }
+            if(changeStats != NULL){
+              if(directedGraph){
+                (*changeStats)[((i-1)*(i) + (2*j))] = change; //make sure we get the right one if directed
+              }else{
+                (*changeStats)[((i-1)*(i)*0.5 + j)] = change;
+              }
+            }
+          }
+        }
+        
+        
+        
+        if(directedGraph && (mask == NULL || mask->isAllowed(alter, vertex))){
+          assert(!runningModel.network()->hasEdge(alter, vertex));
+          if(changeStats == NULL && runningModel.isDyadBlocked(alter, vertex)){
+            Rf_runif(0.0, 1.0);
+          }else{
+            llikChange = runningModel.dyadUpdateChange(alter, vertex, order, i, change);
+            probTie = 1.0 / (1.0 + exp(-llikChange));
+            hasEdge=false;
+            if(Rf_runif(0.0, 1.0) < probTie){
+              runningModel.network()->toggle(alter, vertex);
+              hasEdge=true;
+            }else
+              runningModel.rollback();
+          
+          
+            for(int m=0; m<nStats; m++){
+              eStats[m] += change[m] * probTie;
+              if(hasEdge)
+                stats[m] += change[m];
+            }
+            if(changeStats != NULL){
+              (*changeStats)[((i-1)*(i) + (2*j +1))] = change; //make sure we get the right one if directed
+            }
+          }
+        }
+      }
+    }
+  }
+  
   Rcpp::RObject generateNetworkWithOrder(std::vector<int> vert_order,bool storeChangeStats=false){
+    if(storeChangeStats && mask)
+      Rf_error("generateNetworkWithOrder: change statistics can not be stored with a dyad mask");
     GetRNGstate();
     long n = model->network()->size();
     long nStats = model->thetas().size();
@@ -320,88 +764,10 @@ public:
     
     std::vector<double> eStats = std::vector<double>(nStats, 0.0);//runningModel->statistics();
     std::vector<double> stats = std::vector<double>(nStats, 0.0);
-    std::vector<double> auxStats = std::vector<double>(nStats, 0.0);
-    std::vector<double> terms = runningModel->statistics();
-    std::vector<double>  newTerms = runningModel->statistics();
     std::vector<double>  emptyStats = runningModel->statistics();
     
-    std::vector<int> workingVertOrder = vert_order;
-    
-    
-    double llik = runningModel->logLik();
-    double llikChange, probTie;//, ldenom;
-    bool hasEdge = false;
-    for(int i=0; i < n; i++){
-      int vertex = workingVertOrder[i];
-      this->shuffle(workingVertOrder,i);
-      for(int j=0; j < i; j++){
-        int alter = workingVertOrder[j];
-        assert(!runningModel->network()->hasEdge(vertex, alter));
-        llik = runningModel->logLik();
-        runningModel->dyadUpdate(vertex, alter, vert_order, i);
-        runningModel->statistics(newTerms);
-        llikChange = runningModel->logLik() - llik;
-        probTie = 1.0 / (1.0 + exp(-llikChange));
-        hasEdge = false;
-        if(Rf_runif(0.0, 1.0) < probTie){
-          runningModel->network()->toggle(vertex, alter);
-          hasEdge = true;
-        }else
-          runningModel->rollback();
-        
-        //update the generated network statistics and expected statistics
-        //Initiate change stats
-        std::vector<double> change(terms.size());
-        
-        for(int m=0; m<terms.size(); m++){
-          double diff = newTerms[m] - terms[m];\
-          eStats[m] += diff * probTie;
-          change[m] = diff;
-          if(hasEdge){
-            stats[m] += diff;
-            terms[m] += diff;
-          }
-        }
-        if(storeChangeStats){
-          if(directedGraph){
-            changeStats[((i-1)*(i) + (2*j))] = change; //make sure we get the right one if directed
-          }else{
-            changeStats[((i-1)*(i)*0.5 + j)] = change;
-          }
-        }
-        
-        
-        
-        if(directedGraph){
-          assert(!runningModel->network()->hasEdge(alter, vertex));
-          llik = runningModel->logLik();
-          runningModel->dyadUpdate(alter, vertex, vert_order, i);
-          runningModel->statistics(newTerms);
-          llikChange = runningModel->logLik() - llik;
-          probTie = 1.0 / (1.0 + exp(-llikChange));
-          hasEdge=false;
-          if(Rf_runif(0.0, 1.0) < probTie){
-            runningModel->network()->toggle(alter, vertex);
-            hasEdge=true;
-          }else
-            runningModel->rollback();
-          
-          
-          for(int m=0; m<terms.size(); m++){
-            double diff = newTerms[m] - terms[m];
-            eStats[m] += diff * probTie;
-            change[m] = diff;
-            if(hasEdge){
-              stats[m] += diff;
-              terms[m] += diff;
-            }
-          }
-          if(storeChangeStats){
-            changeStats[((i-1)*(i) + (2*j +1))] = change; //make sure we get the right one if directed
-          }
-        }
-      }
-    }
+    growNetwork(*runningModel, vert_order, stats, eStats, storeChangeStats ? &changeStats : NULL,
+                mask.get());
     std::vector<int> rankOrder = vert_order;
     for(int i=0;i<vert_order.size();i++)
       rankOrder[vert_order[i]] = i;
@@ -419,10 +785,378 @@ public:
     return result;
   }
   
+  /*!
+   * Conditional simulation. The observed dyads of the model network are held fixed
+   * and only the missing dyads are redrawn, in an order drawn from the latent order
+   * process.
+   */
+  Rcpp::RObject generateConditionalNetwork(){
+    boost::shared_ptr< std::vector< std::pair<int,int> > > dyads = model->network()->missingDyads();
+    GetRNGstate();
+    long n = model->network()->size();
+    std::vector<int> vertices(n);
+    if(model->hasVertexOrder()){
+      this->generateOrder(vertices, model->getVertexOrder());
+    }else{
+      for(int i=0; i<n;i++){
+        vertices[i] = i;
+      }
+      this->shuffle(vertices, n);
+    }
+    PutRNGstate();
+    return this->generateConditionalNetworkWithOrder(vertices, *dyads);
+  }
+
+  /*!
+   * Conditional simulation over a designated set of free dyads.
+   *
+   * \param freeDyads a two column matrix of (1-indexed) dyads to be redrawn
+   */
+  Rcpp::RObject generateConditionalNetworkWithDyads(IntegerMatrix freeDyads){
+    if(freeDyads.ncol() != 2)
+      Rf_error("generateConditionalNetworkWithDyads: freeDyads must have two columns");
+    long n = model->network()->size();
+    std::vector< std::pair<int,int> > dyads(freeDyads.nrow());
+    for(int i=0; i<freeDyads.nrow(); i++){
+      int from = freeDyads(i, 0) - 1;
+      int to = freeDyads(i, 1) - 1;
+      if(from < 0 || from >= n || to < 0 || to >= n)
+        Rf_error("generateConditionalNetworkWithDyads: dyad out of range");
+      dyads[i] = std::make_pair(from, to);
+    }
+    GetRNGstate();
+    std::vector<int> vertices(n);
+    if(model->hasVertexOrder()){
+      this->generateOrder(vertices, model->getVertexOrder());
+    }else{
+      for(int i=0; i<n;i++){
+        vertices[i] = i;
+      }
+      this->shuffle(vertices, n);
+    }
+    PutRNGstate();
+    return this->generateConditionalNetworkWithOrder(vertices, dyads);
+  }
+
+  /*!
+   * Redraws the free dyads of the model network, holding all other dyads fixed.
+   *
+   * Each free dyad is assigned to the step of its later vertex in vert_order
+   * and the dyads are visited step by step (randomly within a step), each being
+   * drawn given the observed dyads and the free dyads already visited. The
+   * calculated model is updated in place and restored afterwards, so only the
+   * free dyads are updated and the cost is proportional to their number rather
+   * than to the number of dyads in the network.
+   *
+   * \param vert_order the vertex ordering
+   * \param freeDyads the dyads to be redrawn (0-indexed)
+   */
+  Rcpp::RObject generateConditionalNetworkWithOrder(std::vector<int> vert_order,
+                                                    std::vector< std::pair<int,int> > freeDyads){
+    std::vector<double> observedStats, stats, eStats;
+    int nFree;
+    boost::shared_ptr< BinaryNet<Engine> > drawn =
+      drawConditionalNetwork(vert_order, freeDyads, observedStats, stats, eStats, nFree);
+    List result;
+    result["network"] = drawn->cloneR();
+    result["observedStats"] = wrap(observedStats);
+    result["stats"] = wrap(stats);
+    result["expectedStats"] = wrap(eStats);
+    result["nFreeDyads"] = wrap(nFree);
+    return result;
+  }
+
+  /*!
+   * Redraws the free dyads of the model network, as generateConditionalNetworkWithOrder.
+   * The model and its network are left as they were.
+   *
+   * \param vert_order the vertex ordering
+   * \param freeDyads the dyads to be redrawn (0-indexed)
+   * \param observedStats set to the statistics of the network with the free dyads cleared
+   * \param stats set to the statistics of the drawn network
+   * \param eStats set to the expected statistics
+   * \param nFree set to the number of free dyads, less loops, structural zeros and repeats
+   * \returns the drawn network, whose __order__ variable holds the rank of each
+   * vertex in vert_order
+   */
+  boost::shared_ptr< BinaryNet<Engine> > drawConditionalNetwork(std::vector<int> vert_order,
+                                  const std::vector< std::pair<int,int> >& freeDyads,
+                                  std::vector<double>& observedStats, std::vector<double>& stats,
+                                  std::vector<double>& eStats, int& nFree){
+    long n = model->network()->size();
+    long nStats = model->thetas().size();
+    if(vert_order.size() != n)
+      Rf_error("generateConditionalNetworkWithOrder: vertex order of wrong length");
+    BinaryNet<Engine>& net = *model->network();
+    bool directedGraph = net.isDirected();
+
+    std::vector<int> rankOrder = vert_order;
+    for(int i=0;i<vert_order.size();i++)
+      rankOrder[vert_order[i]] = i;
+
+    //drop loops, structural zeros and duplicates. undirected dyads are stored with the later vertex first
+    std::vector< std::pair<int,int> > dyads;
+    dyads.reserve(freeDyads.size());
+    for(int i=0; i<freeDyads.size(); i++){
+      int from = freeDyads[i].first;
+      int to = freeDyads[i].second;
+      if(from == to)
+        continue;
+      if(mask && !mask->isAllowed(from, to))
+        continue;
+      if(!directedGraph && rankOrder[from] < rankOrder[to])
+        std::swap(from, to);
+      dyads.push_back(std::make_pair(from, to));
+    }
+    std::sort(dyads.begin(), dyads.end());
+    dyads.erase(std::unique(dyads.begin(), dyads.end()), dyads.end());
+
+    std::vector<int> steps(dyads.size());
+    for(int i=0; i<dyads.size(); i++)
+      steps[i] = std::max(rankOrder[dyads[i].first], rankOrder[dyads[i].second]);
+
+    //clear the free dyads of the model, recording the observed ties
+    std::vector<bool> observed(dyads.size());
+    for(int i=0; i<dyads.size(); i++){
+      int from = dyads[i].first;
+      int to = dyads[i].second;
+      observed[i] = net.hasEdge(from, to);
+      if(observed[i]){
+        model->dyadUpdate(from, to, vert_order, steps[i]);
+        net.toggle(from, to);
+      }
+    }
+
+    GetRNGstate();
+
+    //order the free dyads by step, ties broken randomly
+    std::vector<int> dyadOrder(dyads.size());
+    for(int i=0; i<dyads.size(); i++)
+      dyadOrder[i] = i;
+    this->shuffle(dyadOrder, dyadOrder.size());
+    std::stable_sort(dyadOrder.begin(), dyadOrder.end(), IdxCompare(steps));
+
+    observedStats = model->statistics();
+    eStats = observedStats;
+    std::vector<double> change(nStats);
+    double llikChange, probTie;
+    for(int k=0; k<dyadOrder.size(); k++){
+      int from = dyads[dyadOrder[k]].first;
+      int to = dyads[dyadOrder[k]].second;
+      int step = steps[dyadOrder[k]];
+      if(model->isDyadBlocked(from, to)){
+        //a tie with zero probability (see growNetwork)
+        Rf_runif(0.0, 1.0);
+        continue;
+      }
+      llikChange = model->dyadUpdateChange(from, to, vert_order, step, change);
+      probTie = 1.0 / (1.0 + exp(-llikChange));
+      if(Rf_runif(0.0, 1.0) < probTie)
+        net.toggle(from, to);
+      else
+        model->rollback();
+      for(int m=0; m<nStats; m++)
+        eStats[m] += change[m] * probTie;
+    }
+    PutRNGstate();
+
+    stats = model->statistics();
+    boost::shared_ptr< BinaryNet<Engine> > drawn = net.clone();
+    int oldOrder = indexOf(std::string("__order__"), drawn->discreteVarNames());
+    if(oldOrder >= 0)
+      drawn->removeDiscreteVariable(oldOrder);
+    DiscreteAttrib attr = DiscreteAttrib();
+    attr.setName("__order__");
+    drawn->addDiscreteVariable(rankOrder, attr);
+
+    //restore the observed free dyads
+    for(int i=0; i<dyads.size(); i++){
+      int from = dyads[i].first;
+      int to = dyads[i].second;
+      if(net.hasEdge(from, to) != observed[i]){
+        model->dyadUpdate(from, to, vert_order, steps[i]);
+        net.toggle(from, to);
+      }
+    }
+    nFree = dyads.size();
+    return drawn;
+  }
+
+  /*!
+   * Draws one network for each row of a parameter matrix.
+   *
+   * The vertex ordering and the uniform stream are shared across rows, so the
+   * draws are coupled (common random numbers). This makes differences between
+   * rows much less noisy than independent draws.
+   *
+   * Rows are distributed over nThreads threads. The worker threads do not call
+   * the R API. Any user-registered terms must therefore avoid R calls in dyadUpdate
+   * and rollback when nThreads > 1.
+   *
+   * \param thetaMatrix a matrix with one row of parameter values per draw
+   * \param nThreads the number of threads to use
+   * \return a list containing the networks, the empty network statistics and a
+   * rows x statistics x 2 array of the generated ([,,1]) and expected ([,,2]) statistics
+   */
+  Rcpp::RObject generateNetworksWithThetas(NumericMatrix thetaMatrix, int nThreads){
+    long n = model->network()->size();
+    int nRows = thetaMatrix.nrow();
+    int nStats = model->thetas().size();
+    if(thetaMatrix.ncol() != nStats)
+      Rf_error("generateNetworksWithThetas: thetaMatrix must have one column per parameter");
+    if(nThreads < 1)
+      nThreads = 1;
+
+    GetRNGstate();
+    std::vector<int> vertices(n);
+    if(model->hasVertexOrder()){
+      this->generateOrder(vertices, model->getVertexOrder());
+    }else{
+      for(int i=0; i<n;i++){
+        vertices[i] = i;
+      }
+      this->shuffle(vertices, n);
+    }
+    unsigned int seed = floor(Rf_runif(0.0, 4294967295.0));
+    PutRNGstate();
+
+    //set up the running models on the main thread, as calculate may call into R
+    std::vector<ModelPtr> runningModels(nRows);
+    std::vector< std::vector<double> > stats(nRows, std::vector<double>(nStats, 0.0));
+    std::vector< std::vector<double> > eStats(nRows, std::vector<double>(nStats, 0.0));
+    for(int r=0; r<nRows; r++){
+      std::vector<double> th(nStats);
+      for(int m=0; m<nStats; m++)
+        th[m] = thetaMatrix(r, m);
+      runningModels[r] = noTieModel->clone();
+      runningModels[r]->setNetwork(noTieModel->network()->clone());
+      runningModels[r]->setThetas(th);
+      runningModels[r]->calculate();
+    }
+    std::vector<double> emptyStats = runningModels.size() > 0 ?
+      runningModels[0]->statistics() : noTieModel->statistics();
+
+    if(nThreads == 1 || nRows <= 1){
+      for(int r=0; r<nRows; r++)
+        generateCoupledNetwork(runningModels[r], vertices, seed, stats[r], eStats[r], mask.get());
+    }else{
+      //profile counters are not thread safe, so each row counts separately
+      boost::shared_ptr<ModelProfile> profiler = noTieModel->getProfiler();
+      if(profiler)
+        for(int r=0; r<nRows; r++)
+          runningModels[r]->setProfiler(boost::shared_ptr<ModelProfile>(new ModelProfile()));
+      parallelRanges(nRows, nThreads, [&](int t, int begin, int end){
+        for(int r=begin; r<end; r++)
+          generateCoupledNetwork(runningModels[r], vertices, seed, stats[r], eStats[r], mask.get());
+      });
+      if(profiler)
+        for(int r=0; r<nRows; r++)
+          profiler->merge(*runningModels[r]->getProfiler());
+    }
+
+    std::vector<int> rankOrder = vertices;
+    for(int i=0;i<vertices.size();i++)
+      rankOrder[vertices[i]] = i;
+    List networks;
+    NumericVector statArray(nRows * nStats * 2);
+    for(int r=0; r<nRows; r++){
+      DiscreteAttrib attr = DiscreteAttrib();
+      attr.setName("__order__");
+      runningModels[r]->network()->addDiscreteVariable(rankOrder, attr);
+      networks.push_back(runningModels[r]->network()->cloneR());
+      for(int m=0; m<nStats; m++){
+        statArray[r + m * nRows] = stats[r][m];
+        statArray[r + m * nRows + nRows * nStats] = eStats[r][m];
+      }
+    }
+    IntegerVector dims(3);
+    dims[0] = nRows;
+    dims[1] = nStats;
+    dims[2] = 2;
+    statArray.attr("dim") = dims;
+    List result;
+    result["networks"] = networks;
+    result["emptyNetworkStats"] = wrap(emptyStats);
+    result["stats"] = statArray;
+    return result;
+  }
+
+  /*!
+   * Generates a network, periodically saving the state of the generation to file
+   * so that it may be continued with resumeNetworkGeneration if interrupted.
+   *
+   * \param file the checkpoint file
+   * \param checkpointEvery the number of dyads between checkpoints (<= 0 for none)
+   * \param interruptEvery the number of dyads between checks for a user interrupt.
+   *        A checkpoint is written before an interrupt is passed on.
+   * \param verbose print progress at each checkpoint
+   * \param maxDyads stop after this many dyads, leaving the checkpoint to be
+   *        resumed, and return NULL (<= 0 to run to the end)
+   */
+  Rcpp::RObject generateNetworkCheckpointed(std::string file, double checkpointEvery,
+                                            double interruptEvery, bool verbose, double maxDyads){
+    long n = model->network()->size();
+    GenerationCheckpoint cp;
+    GetRNGstate();
+    std::vector<int> vertices(n);
+    if(model->hasVertexOrder()){
+      this->generateOrder(vertices, model->getVertexOrder());
+    }else{
+      for(int i=0; i<n;i++){
+        vertices[i] = i;
+      }
+      this->shuffle(vertices, n);
+    }
+    cp.rng.seed((unsigned int) floor(Rf_runif(0.0, 4294967295.0)));
+    PutRNGstate();
+
+    ModelPtr runningModel = noTieModel->clone();
+    runningModel->setNetwork(noTieModel->network()->clone());
+    runningModel->calculate();
+
+    cp.n = n;
+    cp.vertOrder = vertices;
+    cp.workingOrder = vertices;
+    cp.thetas = runningModel->thetas();
+    cp.emptyStats = runningModel->statistics();
+    cp.stats = std::vector<double>(cp.emptyStats.size(), 0.0);
+    cp.eStats = std::vector<double>(cp.emptyStats.size(), 0.0);
+    if(file.size() > 0)
+      cp.save(file);
+    return runCheckpointedGeneration(cp, runningModel, file, checkpointEvery, interruptEvery, verbose, maxDyads);
+  }
+
+  /*!
+   * Continues a generation from a checkpoint written by generateNetworkCheckpointed.
+   * The likelihood must have the same model (terms and parameter values) as the
+   * one which wrote the checkpoint. The parameters are as generateNetworkCheckpointed.
+   */
+  Rcpp::RObject resumeNetworkGeneration(std::string file, double checkpointEvery,
+                                        double interruptEvery, bool verbose, double maxDyads){
+    ModelPtr runningModel = noTieModel->clone();
+    runningModel->setNetwork(noTieModel->network()->clone());
+    runningModel->calculate();
+    std::vector<double> th = runningModel->thetas();
+    GenerationCheckpoint cp;
+    cp.load(file, model->network()->size(), th.size());
+    for(int i=0; i<th.size(); i++)
+      if(th[i] != cp.thetas[i])
+        Rcpp::stop("resumeNetworkGeneration: checkpoint was written with different parameter values");
+
+    //replay the accepted edges so that the terms are in the same state as when the checkpoint was written
+    for(int k=0; k<cp.edgeFrom.size(); k++){
+      runningModel->dyadUpdate(cp.edgeFrom[k], cp.edgeTo[k], cp.vertOrder, cp.edgeStep[k]);
+      runningModel->network()->toggle(cp.edgeFrom[k], cp.edgeTo[k]);
+    }
+    return runCheckpointedGeneration(cp, runningModel, file, checkpointEvery, interruptEvery, verbose, maxDyads);
+  }
+
   //Based on generate model from vertex order - generate network based on edge ordering
   //Also returns the change stats used to generate the network
   Rcpp::RObject generateNetworkWithEdgeOrder(std::vector<int> perm_heads,
                                              std::vector<int> perm_tails){
+    if(mask)
+      Rf_error("generateNetworkWithEdgeOrder: not supported with a dyad mask");
     GetRNGstate();
     long n = model->network()->size();
     long nStats = model->thetas().size();
@@ -466,16 +1200,13 @@ public:
     
     std::vector<double> eStats = std::vector<double>(nStats, 0.0);//runningModel->statistics();
     std::vector<double> stats = std::vector<double>(nStats, 0.0);
-    std::vector<double> auxStats = std::vector<double>(nStats, 0.0);
-    std::vector<double> terms = runningModel->statistics();
-    std::vector<double>  newTerms = runningModel->statistics();
     std::vector<double>  emptyStats = runningModel->statistics();
+    std::vector<double> change(nStats);
     int actorIndex = 1;
     
     //std::vector<int> workingVertOrder = vert_order;
     
     bool directedGraph = runningModel->network()->isDirected();
-    double llik = runningModel->logLik();
     double llikChange, probTie;//, ldenom;
     bool hasEdge = false;
     for(int i=0; i < e; i++){
@@ -485,8 +1216,7 @@ public:
       //Don't need to assert this, to speed up
       //assert(!runningModel->network()->hasEdge(vertex, alter));
       
-      llik = runningModel->logLik();
-      
+
       //Find which actor the vertex correponds to
       for(int k =0; k<n;k++){
         if(vert_order[k] == vertex){
@@ -495,9 +1225,7 @@ public:
         }
       }
       
-      runningModel->dyadUpdate(vertex, alter, vert_order, actorIndex);
-      runningModel->statistics(newTerms);
-      llikChange = runningModel->logLik() - llik;
+      llikChange = runningModel->dyadUpdateChange(vertex, alter, vert_order, actorIndex, change);
       probTie = 1.0 / (1.0 + exp(-llikChange));
       hasEdge = false;
       if(Rf_runif(0.0, 1.0) < probTie){
@@ -507,16 +1235,10 @@ public:
         runningModel->rollback();
       
       //update the generated network statistics and expected statistics
-      //Initiate change stats
-      std::vector<double> change(terms.size());
-      for(int m=0; m<terms.size(); m++){
-        double diff = newTerms[m] - terms[m];\
-        change[m] = diff;
-        eStats[m] += diff * probTie;
-        if(hasEdge){
-          stats[m] += diff;
-          terms[m] += diff;
-        }
+      for(int m=0; m<nStats; m++){
+        eStats[m] += change[m] * probTie;
+        if(hasEdge)
+          stats[m] += change[m];
       }
       changeStats[i] = change;
     }
@@ -584,8 +1306,10 @@ public:
     std::vector<double> terms = runningModel->statistics();
     std::vector<double>  newTerms = runningModel->statistics();
     std::vector<double>  emptyStats = runningModel->statistics();
+    std::vector<int> rankOrder = ranks(vert_order);
     int actorIndex = 1;
     Rcpp::List result(e);
+    CsrNetwork observed(*model->network());
     
     
     //bool directedGraph = runningModel->network()->isDirected();
@@ -595,25 +1319,18 @@ public:
       int vertex = perm_tails[i];
       int alter = perm_heads[i];
       assert(!runningModel->network()->hasEdge(vertex, alter));
-      //llik = runningModel->logLik();
-      std::vector<double> stat = runningModel->statistics();
+      
+      //structural zeros have no change statistics, and are left NULL
+      if(mask && !mask->isAllowed(vertex, alter))
+        continue;
       
       //Find which actor the vertex correponds to
-      for(int k =0; k<n;k++){
-        if(vert_order[k] == vertex){
-          actorIndex = k;
-          break;
-        }
-      }
+      actorIndex = rankOrder[vertex];
       
-      runningModel->dyadUpdate(vertex, alter, vert_order, actorIndex);
-      //runningModel->statistics(newTerms);
-      std::vector<double> statNew(nStats);
-      runningModel->statistics(statNew);
       std::vector<double> changeStat(nStats);
-      std::transform(statNew.begin(), statNew.end(),stat.begin(),changeStat.begin(),std::minus<double>());
+      runningModel->dyadUpdateChange(vertex, alter, vert_order, actorIndex, changeStat);
       result[i] = changeStat;
-      if(model->network()->hasEdge(vertex,alter)){
+      if(observed.hasEdge(vertex,alter)){
         runningModel->network()->toggle(vertex,alter);
       }else{runningModel->rollback();}
     }
@@ -7,14 +7,87 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <chrono>
+#include <cstring>
 #include <boost/shared_ptr.hpp>
 #include <Rcpp.h>
 #include <RcppCommon.h>
 #include "ShallowCopyable.h"
+#include "StatArena.h"
+#include "DyadContext.h"
+#include "ModelSnapshot.h"
 
 namespace lolog{
 
 
+/*!
+ * Call counts and timings (in seconds) for one model term
+ */
+struct TermProfile{
+    long dyadUpdates;
+    double dyadUpdateTime;
+    long rollbacks;
+    double rollbackTime;
+    long calculates;
+    double calculateTime;
+
+    TermProfile() : dyadUpdates(0), dyadUpdateTime(0.0), rollbacks(0), rollbackTime(0.0),
+            calculates(0), calculateTime(0.0){}
+};
+
+/*!
+ * Instrumentation counters for a Model. Terms are indexed with the statistics
+ * first, followed by the offsets.
+ */
+class ModelProfile{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<TermProfile> terms;
+    long logLiks;
+    double logLikTime;
+
+    ModelProfile() : logLiks(0), logLikTime(0.0){}
+
+    static Clock::time_point now(){
+        return Clock::now();
+    }
+
+    static double elapsed(const Clock::time_point& start){
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    TermProfile& term(int i){
+        if(i >= terms.size())
+            terms.resize(i + 1);
+        return terms[i];
+    }
+
+    /*!
+     * adds the counts of another profile to this one
+     */
+    void merge(const ModelProfile& other){
+        for(int i=0;i<other.terms.size();i++){
+            TermProfile& t = term(i);
+            t.dyadUpdates += other.terms[i].dyadUpdates;
+            t.dyadUpdateTime += other.terms[i].dyadUpdateTime;
+            t.rollbacks += other.terms[i].rollbacks;
+            t.rollbackTime += other.terms[i].rollbackTime;
+            t.calculates += other.terms[i].calculates;
+            t.calculateTime += other.terms[i].calculateTime;
+        }
+        logLiks += other.logLiks;
+        logLikTime += other.logLikTime;
+    }
+
+    void reset(){
+        terms.clear();
+        logLiks = 0;
+        logLikTime = 0.0;
+    }
+};
+
+
 /*!
  * a representation of an lolog model
  */
@@ -38,15 +111,50 @@ protected:
      */
     VectorPtr vertexOrder;
 
+    /**
+     * Instrumentation counters. NULL when profiling is off. Shared by copies and clones
+     * of the model, so that the work done by the models used during simulation is
+     * recorded.
+     */
+    boost::shared_ptr<ModelProfile> profiler;
+
+    /**
+     * Contiguous storage for the statistics and parameters of the terms. Built
+     * lazily, and rebuilt whenever the terms change shape.
+     */
+    boost::shared_ptr<StatArena> state;
+
+    /**
+     * Memoised neighbourhood quantities of the dyad being updated, shared by the
+     * terms. Created with the arena.
+     */
+    boost::shared_ptr< DyadContext<Engine> > context;
+
+    /**
+     * The number of threads used by calculate
+     */
+    int nThreads;
+
+    /**
+     * The names and parameters the statistics and offsets were created from,
+     * used by snapshot. Unnamed for terms added as objects.
+     */
+    std::vector<TermSpec> statSpecs;
+    std::vector<TermSpec> offsetSpecs;
+
+    static double* slice(std::vector<double>& v, int offset){
+        return v.size() > 0 ? &v[0] + offset : NULL;
+    }
+
 public:
-    Model(){
+    Model() : nThreads(1){
         //std::cout << "m1";
         boost::shared_ptr< BinaryNet<Engine> > n(new BinaryNet<Engine>());
         net=n;
         vertexOrder = VectorPtr(new std::vector<int>());
     }
 
-    Model(BinaryNet<Engine>& network){
+    Model(BinaryNet<Engine>& network) : nThreads(1){
         //std::cout << "m2";
         boost::shared_ptr< BinaryNet<Engine> > n(new BinaryNet<Engine>(network));
         net = n;
@@ -57,8 +165,14 @@ public:
         //std::cout << "m3";
         stats = mod.stats;
         offsets = mod.offsets;
+        statSpecs = mod.statSpecs;
+        offsetSpecs = mod.offsetSpecs;
         net = mod.net;
         vertexOrder = mod.vertexOrder;
+        profiler = mod.profiler;
+        nThreads = mod.nThreads;
+        state = mod.state;
+        context = mod.context;
     }
 
     /*!
@@ -68,8 +182,12 @@ public:
         //std::cout << "m4";
         stats = mod.stats;
         offsets = mod.offsets;
+        statSpecs = mod.statSpecs;
+        offsetSpecs = mod.offsetSpecs;
         net = mod.net;
         vertexOrder = mod.vertexOrder;
+        profiler = mod.profiler;
+        nThreads = mod.nThreads;
         if(deep){
             for(int i=0;i<stats.size();i++)
                 stats[i] = stats[i]->vClone();
@@ -77,6 +195,9 @@ public:
                 offsets[i] = offsets[i]->vClone();
             vertexOrder = boost::shared_ptr< std::vector<int> >(new std::vector<int>);
             *vertexOrder = *mod.vertexOrder;
+        }else{
+            state = mod.state;
+            context = mod.context;
         }
     }
 
@@ -91,8 +212,14 @@ public:
         boost::shared_ptr<Model> xp = unwrapRobject< Model<Engine> >(sexp);
         stats = xp->stats;
         offsets = xp->offsets;
+        statSpecs = xp->statSpecs;
+        offsetSpecs = xp->offsetSpecs;
         net = xp->net;
         vertexOrder = xp->vertexOrder;
+        profiler = xp->profiler;
+        nThreads = xp->nThreads;
+        state = xp->state;
+        context = xp->context;
     }
 
     virtual ShallowCopyable* vShallowCopyUnsafe() const{
@@ -121,12 +248,23 @@ public:
     void copy(Model<Engine>& mod){
         stats = mod.stats;
         offsets = mod.offsets;
+        statSpecs = mod.statSpecs;
+        offsetSpecs = mod.offsetSpecs;
         net = mod.net;
         vertexOrder = mod.vertexOrder;
+        profiler = mod.profiler;
+        nThreads = mod.nThreads;
+        state = mod.state;
+        context = mod.context;
     }
 
     void copy(Model<Engine>& mod,bool deep){
         net = mod.net;
+        profiler = mod.profiler;
+        nThreads = mod.nThreads;
+        statSpecs = mod.statSpecs;
+        offsetSpecs = mod.offsetSpecs;
+        state.reset();
         if(deep){
             stats.resize(mod.stats.size());
             offsets.resize(mod.offsets->vSize());
@@ -140,6 +278,8 @@ public:
             stats = mod.stats;
             offsets = mod.offsets;
             vertexOrder = mod.vertexOrder;
+            state = mod.state;
+            context = mod.context;
         }
     }
 
@@ -174,81 +314,82 @@ public:
     }
 
     /*!
-     * the model parameters
+     * Lays the statistics and parameters of the terms out contiguously in a
+     * new arena, and binds the terms to it and to a new dyad context.
      */
-    std::vector<double> thetas(){
-        int n=0;
+    void bindState(){
+        boost::shared_ptr<StatArena> arena(new StatArena());
+        int ns = 0, nt = 0;
         for(int i=0;i<stats.size();i++){
-            n += stats.at(i)->vTheta().size();
+            int s = stats[i]->vStatistics().size();
+            int t = stats[i]->vTheta().size();
+            if(s != t)
+                ::Rf_error("Model: term %s has %d statistics but %d parameters",
+                        stats[i]->vName().c_str(), s, t);
+            ns += s;
+            nt += t;
         }
-        std::vector<double> v(n,0.0);
-        int c=0;
+        arena->stats.resize(ns);
+        arena->lastStats.resize(ns);
+        arena->thetas.resize(nt);
+        int c = 0;
         for(int i=0;i<stats.size();i++){
-            std::vector<double> vals = stats.at(i)->vTheta();
-            for(int j=0;j<vals.size();j++){
-                v[c] = vals[j];
-                //cout << stats.at(i)->theta()[j];
-                c++;
-            }
+            int s = stats[i]->vStatistics().size();
+            stats[i]->vBindArena(arena, slice(arena->stats, c), slice(arena->lastStats, c),
+                    slice(arena->thetas, c));
+            c += s;
         }
-        return v;
+        context = boost::shared_ptr< DyadContext<Engine> >(new DyadContext<Engine>());
+        for(int i=0;i<stats.size();i++)
+            stats[i]->vBindDyadContext(context);
+        arena->setValid(true);
+        state = arena;
+    }
+
+    /*!
+     * the arena, rebuilding it if it is out of date
+     */
+    inline StatArena& ensureState(){
+        if(!state || !state->isValid())
+            bindState();
+        return *state;
+    }
+
+    /*!
+     * the model parameters
+     */
+    const std::vector<double>& thetas(){
+        return ensureState().thetas;
     }
 
     /*!
      * set the model paramters
      */
     void  setThetas(std::vector<double> newThetas){
-        int n=0;
-        for(int i=0;i<stats.size();i++){
-            n += stats.at(i)->vTheta().size();
-        }
-        if(newThetas.size()!= n){
+        StatArena& arena = ensureState();
+        if(newThetas.size()!= arena.thetas.size()){
             //Rcpp::Rcout << n  << " " << newThetas.size() << " ";
             ::Rf_error("Model.setThetas: size mismatch:");
         }
-        int c=0;
-        for(int i=0;i<stats.size();i++){
-            std::vector<double>* vals = &stats.at(i)->vTheta();
-            for(int j=0;j<vals->size();j++){
-                (*vals)[j] = newThetas[c];
-                //cout << stats.at(i)->theta()[j];
-                c++;
-            }
-        }
+        if(newThetas.size() > 0)
+            std::memcpy(&arena.thetas[0], &newThetas[0], newThetas.size() * sizeof(double));
     }
 
 
     /*!
      * the model statistics
      */
-    std::vector<double> statistics(){
-        int n=0;
-        for(int i=0;i<stats.size();i++){
-            n += stats.at(i)->vSize();
-        }
-        std::vector<double> v(n,0.0);
-        int c=0;
-        for(int i=0;i<stats.size();i++){
-            //std::vector<double> vals = stats.at(i)->vStatistics();
-            for(int j=0;j<stats.at(i)->vStatistics().size();j++){
-                v[c] = stats.at(i)->vStatistics()[j];
-                c++;
-            }
-        }
-        return v;
+    const std::vector<double>& statistics(){
+        return ensureState().stats;
     }
+
     /*!
      * Copy model statistics into v
      */
     void statistics(std::vector<double>& v){
-        int c=0;
-        for(int i=0;i<stats.size();i++){
-            //std::vector<double> vals = stats.at(i)->vStatistics();
-            for(int j=0;j<stats[i]->vStatistics().size();j++){
-                v[c] = stats[i]->vStatistics()[j];
-                c++;
-            }
-        }
+        StatArena& arena = ensureState();
+        if(arena.stats.size() > 0)
+            std::memcpy(&v[0], &arena.stats[0], arena.stats.size() * sizeof(double));
     }
 
     /*!
@@ -316,6 +457,9 @@ public:
      * the log likelihood of the model
      */
     double logLik(){
+        ModelProfile::Clock::time_point start;
+        if(profiler)
+            start = ModelProfile::now();
         double ll = 0.0;
         for(int i=0;i<stats.size();i++){
             ll += stats[i]->vLogLik();
@@ -323,6 +467,10 @@ public:
         for(int i=0;i<offsets.size();i++){
             ll += offsets[i]->vLogLik();
         }
+        if(profiler){
+            profiler->logLiks++;
+            profiler->logLikTime += ModelProfile::elapsed(start);
+        }
         return ll;
     }
 
@@ -335,7 +483,10 @@ public:
      */
     void addStatPtr(StatPtr  s){
         stats.push_back(s);
+        statSpecs.push_back(TermSpec());
+        s->vSetCalculateThreads(nThreads);
         s->vCalculate(*net);
+        state.reset();
     }
 
     /*!
@@ -343,8 +494,11 @@ public:
      */
     void addStat(const AbstractStat<Engine>&  s){
         StatPtr ps((&s)->clone());
+        ps->vSetCalculateThreads(nThreads);
         ps->vCalculate(*net);
         stats.push_back(ps);
+        statSpecs.push_back(TermSpec());
+        state.reset();
     }
 
     /*!
@@ -352,6 +506,7 @@ public:
      */
     void addOffsetPtr(OffsetPtr  o){
         offsets.push_back(o);
+        offsetSpecs.push_back(TermSpec());
         o->vCalculate(*net);
     }
 
@@ -362,6 +517,7 @@ public:
         OffsetPtr ps((&o)->vClone());
         ps->vCalculate(*net);
         offsets.push_back(ps);
+        offsetSpecs.push_back(TermSpec());
     }
 
     /*!
@@ -373,8 +529,11 @@ public:
             ::Rf_error("Invalid stat");
             return;
         }
+        ps->vSetCalculateThreads(nThreads);
         ps->vCalculate(*net);
         stats.push_back(StatPtr(ps));
+        statSpecs.push_back(TermSpec(name, params));
+        state.reset();
     }
 
     /*!
@@ -388,6 +547,7 @@ public:
         }
         ps->vCalculate(*net);
         offsets.push_back(OffsetPtr(ps));
+        offsetSpecs.push_back(TermSpec(name, params));
     }
 
     /*!
@@ -402,31 +562,426 @@ public:
      * calculate the statistics
      */
     void calculateStatistics(){
+        if(nThreads > 1 && !profiler){
+            parallelCalculateStatistics();
+            return;
+        }
+        if(profiler){
+            for(int i=0;i<stats.size();i++){
+                ModelProfile::Clock::time_point start = ModelProfile::now();
+                stats[i]->vCalculate(*net);
+                TermProfile& tp = profiler->term(i);
+                tp.calculates++;
+                tp.calculateTime += ModelProfile::elapsed(start);
+            }
+            return;
+        }
         for(int i=0;i<stats.size();i++){
             stats[i]->vCalculate(*net);
         }
     }
 
+    /*!
+     * calculates the statistics using nThreads threads. Statistics whose calculate
+     * may call R are calculated first on this thread, each with all of the threads
+     * available for its own work. The thread safe ones are then spread over the
+     * threads.
+     */
+    void parallelCalculateStatistics(){
+        net->settle();
+        std::vector<int> safe;
+        for(int i=0;i<stats.size();i++){
+            if(stats[i]->vIsCalculateThreadSafe()){
+                safe.push_back(i);
+            }else{
+                stats[i]->vSetCalculateThreads(nThreads);
+                stats[i]->vCalculate(*net);
+            }
+        }
+        int nSafe = safe.size();
+        if(nSafe == 0)
+            return;
+        int nWorkers = std::min(nThreads, nSafe);
+        int inner = std::max(1, nThreads / nWorkers);
+        for(int i=0;i<nSafe;i++)
+            stats[safe[i]]->vSetCalculateThreads(inner);
+        const BinaryNet<Engine>& network = *net;
+        std::exception_ptr error;
+        try{
+            parallelRanges(nSafe, nWorkers, [&](int t, int begin, int end){
+                for(int i=begin;i<end;i++)
+                    stats[safe[i]]->vCalculate(network);
+            });
+        }catch(...){
+            error = std::current_exception();
+        }
+        for(int i=0;i<nSafe;i++)
+            stats[safe[i]]->vSetCalculateThreads(nThreads);
+        if(error)
+            std::rethrow_exception(error);
+    }
+
+    /*!
+     * the number of threads used to calculate the statistics
+     */
+    int getThreads() const{
+        return nThreads;
+    }
+
+    /*!
+     * sets the number of threads used to calculate the statistics. Terms that
+     * support it (see BaseOffset::isCalculateThreadSafe) are calculated
+     * concurrently, and the edge loops of the heavier terms are split over
+     * the threads.
+     */
+    void setThreads(int n){
+        nThreads = std::max(1, n);
+        for(int i=0;i<stats.size();i++)
+            stats[i]->vSetCalculateThreads(nThreads);
+    }
+
+    /*!
+     * Serialises the calculated model to a binary blob: the network, the vertex
+     * order, the name and parameters of each term, the statistics, the thetas and
+     * the state of the statistics that support it (see BaseOffset::saveSnapshot).
+     * Only terms added by name (addStatistic, addOffset) can be saved.
+     *
+     * The blob is in native byte order, and is read with restoreSnapshot.
+     */
+    std::vector<unsigned char> snapshot(){
+        for(int i=0;i<stats.size();i++)
+            if(!statSpecs[i].isNamed())
+                ::Rf_error("Model.snapshot: the statistic %s was not added by name and cannot be saved",
+                        stats[i]->vName().c_str());
+        for(int i=0;i<offsets.size();i++)
+            if(!offsetSpecs[i].isNamed())
+                ::Rf_error("Model.snapshot: the offset %s was not added by name and cannot be saved",
+                        offsets[i]->vName().c_str());
+        SnapshotWriter out;
+        out.writeRaw(snapshotMagic(), 8);
+        out.writeInt(snapshotByteOrder());
+        out.writeInt(snapshotVersion());
+        out.writeString(Engine::engineName());
+        writeSnapshotNetwork(out, *net);
+        out.writeVector(*vertexOrder);
+        out.writeInt(stats.size());
+        for(int i=0;i<stats.size();i++){
+            out.writeString(statSpecs[i].name);
+            out.writeVector(statSpecs[i].params);
+            out.writeVector(std::vector<double>(stats[i]->vStatistics()));
+            out.writeVector(std::vector<double>(stats[i]->vTheta()));
+            std::vector<double> termState;
+            bool hasState = stats[i]->vHasSnapshot();
+            if(hasState)
+                stats[i]->vSaveSnapshot(termState);
+            out.writeInt(hasState);
+            out.writeVector(termState);
+        }
+        out.writeInt(offsets.size());
+        for(int i=0;i<offsets.size();i++){
+            out.writeString(offsetSpecs[i].name);
+            out.writeVector(offsetSpecs[i].params);
+        }
+        return out.bytes;
+    }
+
+    /*!
+     * Replaces the network and terms with those of a snapshot. Statistics that
+     * saved their state are restored without being recalculated, the others
+     * (and the offsets) are calculated.
+     */
+    void restoreSnapshot(const std::vector<unsigned char>& bytes){
+        SnapshotReader in(bytes);
+        char magic[8];
+        in.readRaw(magic, 8);
+        if(std::string(magic, 8) != std::string(snapshotMagic(), 8))
+            ::Rf_error("Model.restoreSnapshot: not a model snapshot");
+        if(in.readInt() != snapshotByteOrder())
+            ::Rf_error("Model.restoreSnapshot: the snapshot was written with a different byte order");
+        int version = in.readInt();
+        if(version < 1 || version > snapshotVersion())
+            ::Rf_error("Model.restoreSnapshot: unsupported snapshot version %d", version);
+        std::string engine = in.readString();
+        if(engine != Engine::engineName())
+            ::Rf_error("Model.restoreSnapshot: the snapshot is of a %s model", engine.c_str());
+
+        boost::shared_ptr< BinaryNet<Engine> > newNet = readSnapshotNetwork<Engine>(in, version);
+        VectorPtr newOrder(new std::vector<int>(in.readVector<int>()));
+        StatVector newStats;
+        std::vector<TermSpec> newStatSpecs;
+        int ns = in.readInt();
+        for(int i=0;i<ns;i++){
+            TermSpec spec;
+            spec.name = in.readString();
+            spec.params = in.readVector<unsigned char>();
+            std::vector<double> st = in.readVector<double>();
+            std::vector<double> th = in.readVector<double>();
+            bool hasState = in.readInt();
+            std::vector<double> termState = in.readVector<double>();
+            AbstractStat<Engine>* ps = StatController<Engine>::getStat(spec.name, spec.parameters());
+            if(ps==NULL)
+                ::Rf_error("Invalid stat");
+            StatPtr s(ps);
+            s->vSetCalculateThreads(nThreads);
+            if(hasState && s->vHasSnapshot()){
+                s->vSetStatistics(st);
+                s->vLoadSnapshot(*newNet, termState);
+            }else
+                s->vCalculate(*newNet);
+            s->vSetTheta(th);
+            newStats.push_back(s);
+            newStatSpecs.push_back(spec);
+        }
+        OffsetVector newOffsets;
+        std::vector<TermSpec> newOffsetSpecs;
+        int no = in.readInt();
+        for(int i=0;i<no;i++){
+            TermSpec spec;
+            spec.name = in.readString();
+            spec.params = in.readVector<unsigned char>();
+            AbstractOffset<Engine>* po = StatController<Engine>::getOffset(spec.name, spec.parameters());
+            if(po==NULL)
+                ::Rf_error("Invalid offset");
+            OffsetPtr o(po);
+            o->vCalculate(*newNet);
+            newOffsets.push_back(o);
+            newOffsetSpecs.push_back(spec);
+        }
+        if(!in.atEnd())
+            ::Rf_error("Model snapshot is truncated or corrupt");
+
+        net = newNet;
+        vertexOrder = newOrder;
+        stats = newStats;
+        statSpecs = newStatSpecs;
+        offsets = newOffsets;
+        offsetSpecs = newOffsetSpecs;
+        state.reset();
+        context.reset();
+    }
+
     /*!
      * calculate the statistics
      */
     void calculateOffsets(){
+        if(profiler){
+            for(int i=0;i<offsets.size();i++){
+                ModelProfile::Clock::time_point start = ModelProfile::now();
+                offsets[i]->vCalculate(*net);
+                TermProfile& tp = profiler->term(stats.size() + i);
+                tp.calculates++;
+                tp.calculateTime += ModelProfile::elapsed(start);
+            }
+            return;
+        }
         for(int i=0;i<offsets.size();i++){
             offsets[i]->vCalculate(*net);
         }
     }
 
+    /*!
+     * Updates the model with a hypothetical dyad toggle. The statistics prior to
+     * the update are saved in one step for all terms, so rollback() can restore
+     * them. Terms bound to the arena must only be updated through the model.
+     */
     void dyadUpdate(int &from, int &to, std::vector<int> &order, int &actorIndex){
+        ensureState().checkpoint();
+        context->reset(*net, from, to);
+        if(profiler){
+            profiledDyadUpdate(from, to, order, actorIndex);
+        }else{
+            for(int k=0;k<stats.size();k++){
+                stats[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+            }
+            for(int k=0;k<offsets.size();k++){
+                offsets[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+            }
+        }
+        context->clear();
+    }
+
+    /*!
+     * dyadUpdate, recording the calls and time of each term
+     */
+    void profiledDyadUpdate(int &from, int &to, std::vector<int> &order, int &actorIndex){
         for(int k=0;k<stats.size();k++){
+            ModelProfile::Clock::time_point start = ModelProfile::now();
             stats[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+            TermProfile& tp = profiler->term(k);
+            tp.dyadUpdates++;
+            tp.dyadUpdateTime += ModelProfile::elapsed(start);
         }
         for(int k=0;k<offsets.size();k++){
+            ModelProfile::Clock::time_point start = ModelProfile::now();
             offsets[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+            TermProfile& tp = profiler->term(stats.size() + k);
+            tp.dyadUpdates++;
+            tp.dyadUpdateTime += ModelProfile::elapsed(start);
         }
     }
 
+    /*!
+     * true if an offset rules out adding the tie (from, to) given the current
+     * network (see BaseOffset::isDyadBlocked). The tie has zero probability, so the
+     * generators skip the dyad without calling dyadUpdate.
+     */
+    bool isDyadBlocked(int from, int to){
+        for(int k=0;k<offsets.size();k++)
+            if(offsets[k]->vIsDyadBlocked(*net, from, to))
+                return true;
+        return false;
+    }
+
+    /*!
+     * Updates the model with a hypothetical dyad toggle and returns the
+     * change in the log likelihood (i.e. the log odds of the tie).
+     *
+     * The change statistics are written into delta, which must have one element
+     * per model statistic. Terms may not change their number of statistics
+     * during the update. The log odds are computed as theta . delta plus the
+     * change in the offsets, so no full logLik() pass is needed before or after
+     * the update.
+     *
+     * \param delta an output buffer of length statistics().size()
+     */
+    double dyadUpdateChange(int &from, int &to, std::vector<int> &order, int &actorIndex,
+            std::vector<double>& delta){
+        StatArena* arena = &ensureState();
+        arena->checkpoint();
+        boost::shared_ptr< DyadContext<Engine> > ctx = context;
+        ctx->reset(*net, from, to);
+        for(int k=0;k<stats.size();k++){
+            if(profiler){
+                ModelProfile::Clock::time_point start = ModelProfile::now();
+                stats[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+                TermProfile& tp = profiler->term(k);
+                tp.dyadUpdates++;
+                tp.dyadUpdateTime += ModelProfile::elapsed(start);
+            }else
+                stats[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+        }
+        //a term that changed shape has detached its statistics from the
+        //checkpoint, and delta no longer has one element per statistic
+        if(!arena->isValid()){
+            ctx->clear();
+            Rcpp::stop("Model.dyadUpdateChange: a term changed its number of statistics during a dyad update");
+        }
+        double lo = 0.0;
+        int n = arena->stats.size();
+        const double* st = slice(arena->stats, 0);
+        const double* last = slice(arena->lastStats, 0);
+        const double* th = slice(arena->thetas, 0);
+        for(int j=0;j<n;j++){
+            delta[j] = st[j] - last[j];
+            lo += th[j] * delta[j];
+        }
+        for(int k=0;k<offsets.size();k++){
+            double ll = offsets[k]->vLogLik();
+            if(profiler){
+                ModelProfile::Clock::time_point start = ModelProfile::now();
+                offsets[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+                TermProfile& tp = profiler->term(stats.size() + k);
+                tp.dyadUpdates++;
+                tp.dyadUpdateTime += ModelProfile::elapsed(start);
+            }else
+                offsets[k]->vDyadUpdate(*net, from, to, order, actorIndex);
+            lo += offsets[k]->vLogLik() - ll;
+        }
+        ctx->clear();
+        return lo;
+    }
+
+
+    /*!
+     * true if every term can compute change statistics without modifying itself
+     * (see BaseOffset::changeStat). Offsets do not support this.
+     */
+    bool hasChangeStats() const{
+        if(offsets.size() > 0)
+            return false;
+        for(int k=0;k<stats.size();k++)
+            if(!stats[k]->vHasChangeStat())
+                return false;
+        return true;
+    }
+
+    /*!
+     * The change statistics and log odds of toggling (from, to), computed without
+     * modifying the model or the network. Requires hasChangeStats(). Safe to call
+     * from several threads at once, provided nothing modifies the model meanwhile.
+     *
+     * \param delta an output buffer of length statistics().size()
+     */
+    double changeStatistics(const int &from, const int &to, const std::vector<int> &order,
+            const int &actorIndex, std::vector<double>& delta) const{
+        double lo = 0.0;
+        int c = 0;
+        for(int k=0;k<stats.size();k++){
+            stats[k]->vChangeStat(*net, from, to, order, actorIndex, &delta[c]);
+            StatBuffer& th = stats[k]->vTheta();
+            for(int j=0;j<th.size();j++)
+                lo += th[j] * delta[c + j];
+            c += th.size();
+        }
+        return lo;
+    }
+
+    /*!
+     * Applies an accepted toggle of (from, to) to the terms and the network
+     */
+    void commitDyad(int from, int to, std::vector<int> &order, int actorIndex){
+        dyadUpdate(from, to, order, actorIndex);
+        net->toggle(from, to);
+    }
+
+    /*!
+     * Change statistics for a set of dyads against the current network, as a
+     * matrix with one row per dyad. If every term supports change statistics, the
+     * dyads are split over nThreads threads, otherwise they are evaluated serially
+     * by update and rollback.
+     *
+     * \param dyads a two column matrix of (1-indexed) vertex pairs
+     */
+    NumericMatrix changeStatisticsR(IntegerMatrix dyads, int nThreads){
+        if(dyads.ncol() != 2)
+            ::Rf_error("Model.changeStatistics: dyads must have two columns");
+        int nDyads = dyads.nrow();
+        int n = net->size();
+        std::vector<int> from(nDyads), to(nDyads);
+        for(int i=0;i<nDyads;i++){
+            from[i] = dyads(i, 0) - 1;
+            to[i] = dyads(i, 1) - 1;
+            if(from[i] < 0 || from[i] >= n || to[i] < 0 || to[i] >= n || from[i] == to[i])
+                ::Rf_error("Model.changeStatistics: invalid dyad in row %d", i + 1);
+        }
+        int nStats = statistics().size();
+        NumericMatrix result(nDyads, nStats);
+        std::vector<int> order = getVertexOrderVector();
+        int actorIndex = 0;
+        if(!hasChangeStats()){
+            std::vector<double> delta(nStats);
+            for(int i=0;i<nDyads;i++){
+                dyadUpdateChange(from[i], to[i], order, actorIndex, delta);
+                rollback();
+                for(int j=0;j<nStats;j++)
+                    result(i, j) = delta[j];
+            }
+            return result;
+        }
+        std::vector< std::vector<double> > changes(nDyads, std::vector<double>(nStats));
+        net->settle();
+        parallelRanges(nDyads, nThreads, [&](int t, int begin, int end){
+            for(int i=begin;i<end;i++)
+                changeStatistics(from[i], to[i], order, actorIndex, changes[i]);
+        });
+        for(int i=0;i<nDyads;i++)
+            for(int j=0;j<nStats;j++)
+                result(i, j) = changes[i][j];
+        return result;
+    }
 
     void discreteVertexUpdate(int vertex, int variable, int newValue, std::vector<int> &order, int &actorIndex){
+        ensureState().checkpoint();
         for(int k=0;k<stats.size();k++)
             stats[k]->vDiscreteVertexUpdate(*net,vertex, variable, newValue);
         for(int k=0;k<offsets.size();k++)
@@ -434,19 +989,105 @@ public:
     }
 
     void continVertexUpdate(int vertex, int variable, double newValue, std::vector<int> &order, int &actorIndex){
+        ensureState().checkpoint();
         for(int k=0;k<stats.size();k++)
             stats[k]->vContinVertexUpdate(*net,vertex, variable, newValue, order, actorIndex);
         for(int k=0;k<offsets.size();k++)
             offsets[k]->vContinVertexUpdate(*net,vertex, variable, newValue, order, actorIndex);
     }
 
+    /*!
+     * rolls back the last update. The terms restore any internal state, and
+     * the statistics of all terms are then restored in one step.
+     */
     void rollback(){
+        boost::shared_ptr<StatArena> arena = state;
+        if(!arena || !arena->isValid()){
+            bindState();
+            arena = state;
+        }
+        rollbackTerms();
+        arena->restore();
+    }
+
+protected:
+    void rollbackTerms(){
+        if(profiler){
+            for(int k=0;k<stats.size() + offsets.size();k++){
+                ModelProfile::Clock::time_point start = ModelProfile::now();
+                if(k < stats.size())
+                    stats[k]->vRollback(*net);
+                else
+                    offsets[k - stats.size()]->vRollback(*net);
+                TermProfile& tp = profiler->term(k);
+                tp.rollbacks++;
+                tp.rollbackTime += ModelProfile::elapsed(start);
+            }
+            return;
+        }
         for(int k=0;k<stats.size();k++)
             stats[k]->vRollback(*net);
         for(int k=0;k<offsets.size();k++)
             offsets[k]->vRollback(*net);
     }
 
+public:
+
+    /*!
+     * turns instrumentation of the terms on or off. Turning it on resets the counters.
+     */
+    void setProfiling(bool on){
+        if(on)
+            profiler = boost::shared_ptr<ModelProfile>(new ModelProfile());
+        else
+            profiler.reset();
+    }
+
+    bool isProfiling() const{
+        return (bool) profiler;
+    }
+
+    boost::shared_ptr<ModelProfile> getProfiler() const{
+        return profiler;
+    }
+
+    void setProfiler(boost::shared_ptr<ModelProfile> prof){
+        profiler = prof;
+    }
+
+    /*!
+     * The profiling counters for R. Term rows are statistics followed by offsets.
+     */
+    Rcpp::List profileR(){
+        if(!profiler)
+            ::Rf_error("Model.profile: profiling is not enabled. Call setProfiling(TRUE) first.");
+        int nTerms = stats.size() + offsets.size();
+        std::vector<std::string> termNames(nTerms);
+        std::vector<double> dyadUpdates(nTerms), dyadUpdateTime(nTerms), rollbacks(nTerms),
+                rollbackTime(nTerms), calculates(nTerms), calculateTime(nTerms);
+        for(int k=0;k<nTerms;k++){
+            termNames[k] = k < stats.size() ? stats[k]->vName() : offsets[k - stats.size()]->vName();
+            TermProfile& tp = profiler->term(k);
+            dyadUpdates[k] = tp.dyadUpdates;
+            dyadUpdateTime[k] = tp.dyadUpdateTime;
+            rollbacks[k] = tp.rollbacks;
+            rollbackTime[k] = tp.rollbackTime;
+            calculates[k] = tp.calculates;
+            calculateTime[k] = tp.calculateTime;
+        }
+        Rcpp::List result;
+        result["term"] = wrap(termNames);
+        result["dyadUpdateCalls"] = wrap(dyadUpdates);
+        result["dyadUpdateTime"] = wrap(dyadUpdateTime);
+        result["rollbackCalls"] = wrap(rollbacks);
+        result["rollbackTime"] = wrap(rollbackTime);
+        result["calculateCalls"] = wrap(calculates);
+        result["calculateTime"] = wrap(calculateTime);
+        result["logLikCalls"] = wrap((double) profiler->logLiks);
+        result["logLikTime"] = wrap(profiler->logLikTime);
+        return result;
+    }
+
     /*!
      * get the network
      */
@@ -0,0 +1,208 @@
+#ifndef MODELSNAPSHOTH_
+#define MODELSNAPSHOTH_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <utility>
+#include <boost/shared_ptr.hpp>
+
+#include <Rcpp.h>
+
+#include "BinaryNet.h"
+#include "VarAttrib.h"
+#include "SnapshotCodec.h"
+
+namespace lolog{
+
+
+/*!
+ * The first eight bytes of a model snapshot
+ */
+inline const char* snapshotMagic(){
+    return "LOLOGMDL";
+}
+
+/*!
+ * Written after the magic number, to detect snapshots from machines with a
+ * different byte order
+ */
+inline int snapshotByteOrder(){
+    return 0x01020304;
+}
+
+/*!
+ * The snapshot format version. Increment when the layout changes.
+ *
+ * 2: the size of the first mode follows the network directedness
+ */
+inline int snapshotVersion(){
+    return 2;
+}
+
+
+/*!
+ * The name and parameters a model term was created from (see
+ * StatController). The parameters are held as an R serialised list, so
+ * that models may be copied without touching R objects.
+ */
+struct TermSpec{
+    std::string name;
+    std::vector<unsigned char> params;
+
+    TermSpec(){}
+
+    TermSpec(const std::string& n, Rcpp::List p) : name(n){
+        Rcpp::Function serialize("serialize");
+        params = Rcpp::as< std::vector<unsigned char> >(serialize(p, R_NilValue));
+    }
+
+    /*!
+     * false if the term was not created by name
+     */
+    bool isNamed() const{
+        return name.size() > 0;
+    }
+
+    Rcpp::List parameters() const{
+        Rcpp::Function unserialize("unserialize");
+        return Rcpp::as<Rcpp::List>(unserialize(Rcpp::wrap(params)));
+    }
+};
+
+
+/*!
+ * Writes the edges, missing dyads and vertex variables of a network
+ */
+template<class Engine>
+void writeSnapshotNetwork(SnapshotWriter& out, BinaryNet<Engine>& net){
+    out.writeInt(net.size());
+    out.writeInt(net.isDirected());
+    out.writeInt(net.firstModeSize());
+    std::vector<int> edges;
+    edges.reserve(2 * net.nEdges());
+    for(typename BinaryNet<Engine>::EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+        edges.push_back(it->first);
+        edges.push_back(it->second);
+    }
+    out.writeVector(edges);
+    boost::shared_ptr< std::vector< std::pair<int,int> > > miss = net.missingDyads();
+    std::vector<int> missing(2 * miss->size());
+    for(int i=0;i<miss->size();i++){
+        missing[2 * i] = (*miss)[i].first;
+        missing[2 * i + 1] = (*miss)[i].second;
+    }
+    out.writeVector(missing);
+
+    std::vector<std::string> dnames = net.discreteVarNames();
+    out.writeInt(dnames.size());
+    for(int i=0;i<dnames.size();i++){
+        DiscreteAttrib attr = net.discreteVariableAttributes(i);
+        out.writeString(attr.getName());
+        out.writeStrings(attr.labels());
+        out.writeInt(attr.hasLowerBound());
+        out.writeInt(attr.lowerBound());
+        out.writeInt(attr.hasUpperBound());
+        out.writeInt(attr.upperBound());
+        out.writeVector(net.discreteVariableValues(i));
+        out.writeBools(net.discreteVariableObserved(i));
+    }
+
+    std::vector<std::string> cnames = net.continVarNames();
+    out.writeInt(cnames.size());
+    for(int i=0;i<cnames.size();i++){
+        ContinAttrib attr = net.continVariableAttributes(i);
+        out.writeString(attr.getName());
+        out.writeInt(attr.hasLowerBound());
+        out.writeDouble(attr.lowerBound());
+        out.writeInt(attr.hasUpperBound());
+        out.writeDouble(attr.upperBound());
+        std::vector<double> vals(net.size());
+        for(int j=0;j<net.size();j++)
+            vals[j] = net.continVariableValue(i, j);
+        out.writeVector(vals);
+        out.writeBools(net.continVariableObserved(i));
+    }
+}
+
+
+/*!
+ * Reads a network written by writeSnapshotNetwork
+ *
+ * \param version the snapshot format version
+ */
+template<class Engine>
+boost::shared_ptr< BinaryNet<Engine> > readSnapshotNetwork(SnapshotReader& in, int version){
+    int n = in.readInt();
+    bool directed = in.readInt();
+    int nFirst = version >= 2 ? in.readInt() : n;
+    if(n < 0 || nFirst < 0 || nFirst > n)
+        in.corrupt();
+    boost::shared_ptr< BinaryNet<Engine> > net(emptyNetwork<Engine>(n, nFirst));
+    if(directed != net->isDirected())
+        Rf_error("Model snapshot: the network directedness does not match the engine");
+    std::vector<int> edges = in.readVector<int>();
+    for(int i=0;i + 1 < edges.size();i += 2){
+        if(edges[i] < 0 || edges[i] >= n || edges[i + 1] < 0 || edges[i + 1] >= n)
+            in.corrupt();
+        net->addEdge(edges[i], edges[i + 1]);
+    }
+    std::vector<int> missing = in.readVector<int>();
+    for(int i=0;i + 1 < missing.size();i += 2){
+        if(missing[i] < 0 || missing[i] >= n || missing[i + 1] < 0 || missing[i + 1] >= n)
+            in.corrupt();
+        net->setMissing(missing[i], missing[i + 1], true);
+    }
+
+    int nd = in.readInt();
+    for(int i=0;i<nd;i++){
+        DiscreteAttrib attr;
+        attr.setName(in.readString());
+        attr.setLabels(in.readStrings());
+        bool hasLb = in.readInt();
+        int lb = in.readInt();
+        bool hasUb = in.readInt();
+        int ub = in.readInt();
+        if(hasLb)
+            attr.setLowerBound(lb);
+        if(hasUb)
+            attr.setUpperBound(ub);
+        std::vector<int> vals = in.readVector<int>();
+        std::vector<bool> observed = in.readBools();
+        if(vals.size() != n || observed.size() != n)
+            in.corrupt();
+        net->addDiscreteVariable(vals, attr);
+        int which = net->discreteVarNames().size() - 1;
+        for(int j=0;j<n;j++)
+            if(!observed[j])
+                net->setDiscreteVariableObserved(which, j, false);
+    }
+
+    int nc = in.readInt();
+    for(int i=0;i<nc;i++){
+        ContinAttrib attr;
+        attr.setName(in.readString());
+        bool hasLb = in.readInt();
+        double lb = in.readDouble();
+        bool hasUb = in.readInt();
+        double ub = in.readDouble();
+        if(hasLb)
+            attr.setLowerBound(lb);
+        if(hasUb)
+            attr.setUpperBound(ub);
+        std::vector<double> vals = in.readVector<double>();
+        std::vector<bool> observed = in.readBools();
+        if(vals.size() != n || observed.size() != n)
+            in.corrupt();
+        net->addContinVariable(vals, attr);
+        int which = net->continVarNames().size() - 1;
+        for(int j=0;j<n;j++)
+            if(!observed[j])
+                net->setContinVariableObserved(which, j, false);
+    }
+    return net;
+}
+
+}
+
+#endif /* MODELSNAPSHOTH_ */
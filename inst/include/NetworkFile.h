@@ -0,0 +1,468 @@
+#ifndef NETWORKFILEH_
+#define NETWORKFILEH_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <Rcpp.h>
+
+#include "BinaryNet.h"
+#include "VarAttrib.h"
+#include "SnapshotCodec.h"
+
+namespace lolog{
+
+
+/*
+ * The binary network file format.
+ *
+ * A file holds one network in native byte order:
+ *  - the magic number "LOLOGNET", networkFileByteOrder() and
+ *    networkFileVersion() as ints, and the engine name as an int length
+ *    followed by its characters
+ *  - directedness, the number of vertices, the size of the first mode and
+ *    the number of edges
+ *  - the adjacency in compressed sparse row form: n + 1 int64 offsets and the
+ *    sorted neighbour ids of each vertex, for the out neighbours and then
+ *    (directed networks only) the in neighbours. Undirected networks list
+ *    each edge under both ends.
+ *  - the missing dyads: a flag for each vertex with all of its dyads missing,
+ *    followed by the missing alters of the other vertices in compressed
+ *    sparse row form. Undirected networks only list alters above the vertex.
+ *  - the discrete and then the continuous vertex variables, each with its
+ *    name, labels and bounds, followed by its values and observed flags
+ *
+ * Values are written with SnapshotWriter and read with SnapshotReader. Arrays
+ * are a length followed by their elements, and start on 8 byte boundaries,
+ * so a memory mapped file can be read in place. The adjacency
+ * is copied straight from the map into the network.
+ */
+
+
+/*!
+ * The first eight bytes of a network file
+ */
+inline const char* networkFileMagic(){
+    return "LOLOGNET";
+}
+
+/*!
+ * Written after the magic number, to detect files from machines with a
+ * different byte order
+ */
+inline int networkFileByteOrder(){
+    return 0x01020304;
+}
+
+/*!
+ * The network file format version. Increment when the layout changes.
+ */
+inline int networkFileVersion(){
+    return 1;
+}
+
+
+/*!
+ * An empty network of n vertices, nFirst of which are in the first mode
+ */
+template<class Engine>
+BinaryNet<Engine>* emptyNetwork(int n, int nFirst){
+    return new BinaryNet<Engine>(Rcpp::IntegerMatrix(0, 2), n);
+}
+
+template<>
+inline BinaryNet<Bipartite>* emptyNetwork<Bipartite>(int n, int nFirst){
+    return new BinaryNet<Bipartite>(Rcpp::IntegerMatrix(0, 2), nFirst, n - nFirst);
+}
+
+
+/*!
+ * A file mapped read only into memory. Where memory mapping is not
+ * available (Windows) the file is read into memory instead.
+ *
+ * Errors while reading a mapped file must be thrown (Rcpp::stop) rather than
+ * raised with Rf_error, which would skip the destructor and leak the mapping.
+ */
+class MappedFile{
+protected:
+    const char* bytes;
+    size_t length;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+    MappedFile(const MappedFile& other);
+    MappedFile& operator=(const MappedFile& other);
+
+public:
+
+    MappedFile(const std::string& file) : bytes(NULL), length(0){
+#ifndef _WIN32
+        int fd = open(file.c_str(), O_RDONLY);
+        if(fd < 0)
+            Rcpp::stop("Unable to open " + file);
+        struct stat st;
+        if(fstat(fd, &st) != 0){
+            close(fd);
+            Rcpp::stop("Unable to read " + file);
+        }
+        length = st.st_size;
+        if(length > 0){
+            void* map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(map == MAP_FAILED){
+                close(fd);
+                Rcpp::stop("Unable to map " + file);
+            }
+            bytes = static_cast<const char*>(map);
+        }
+        close(fd);
+#else
+        std::ifstream in(file.c_str(), std::ios::binary | std::ios::ate);
+        if(!in)
+            Rcpp::stop("Unable to open " + file);
+        length = in.tellg();
+        buffer.resize(length);
+        in.seekg(0);
+        if(length > 0 && !in.read(&buffer[0], length))
+            Rcpp::stop("Unable to read " + file);
+        bytes = length > 0 ? &buffer[0] : NULL;
+#endif
+    }
+
+    ~MappedFile(){
+#ifndef _WIN32
+        if(bytes != NULL)
+            munmap(const_cast<char*>(bytes), length);
+#endif
+    }
+
+    const char* data() const{
+        return bytes;
+    }
+
+    size_t size() const{
+        return length;
+    }
+};
+
+
+/*!
+ * Writes the neighbour lists of a network in compressed sparse row form
+ *
+ * \param in write the in neighbours rather than the out neighbours
+ */
+template<class Engine>
+void writeNetworkAdjacency(SnapshotWriter& out, const BinaryNet<Engine>& net, bool in){
+    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    int n = net.size();
+    bool directed = net.isDirected();
+    std::vector<int64_t> start(n + 1, 0);
+    for(int i=0;i<n;i++){
+        int d = !directed ? net.degree(i) : (in ? net.indegree(i) : net.outdegree(i));
+        start[i + 1] = start[i] + d;
+    }
+    out.writeArray(start);
+    out.beginArray(start[n]);
+    std::vector<int> nbrs;
+    for(int i=0;i<n;i++){
+        NeighborIterator it = !directed ? net.begin(i) : (in ? net.inBegin(i) : net.outBegin(i));
+        NeighborIterator end = !directed ? net.end(i) : (in ? net.inEnd(i) : net.outEnd(i));
+        nbrs.assign(it, end);
+        out.writeRaw(nbrs.empty() ? NULL : &nbrs[0], nbrs.size() * sizeof(int));
+    }
+    out.align();
+}
+
+
+/*!
+ * Writes a network in the binary network file format
+ */
+template<class Engine>
+void writeNetwork(std::ostream& stream, BinaryNet<Engine>& net){
+    SnapshotWriter out(stream);
+    int n = net.size();
+    bool directed = net.isDirected();
+    out.writeRaw(networkFileMagic(), 8);
+    out.writeInt(networkFileByteOrder());
+    out.writeInt(networkFileVersion());
+    out.writeString(Engine::engineName());
+    out.align();
+    out.writeInt(directed);
+    out.writeInt(n);
+    out.writeInt(net.firstModeSize());
+    out.align();
+    out.writeInt64(net.nEdges());
+
+    writeNetworkAdjacency(out, net, false);
+    if(directed)
+        writeNetworkAdjacency(out, net, true);
+
+    std::vector<char> all(n, 0);
+    for(int i=0;i<n;i++)
+        all[i] = n > 1 && net.nMissing(i) == n - 1;
+    std::vector<int64_t> missStart(n + 1, 0);
+    std::vector<int> missing, alters;
+    for(int i=0;i<n;i++){
+        if(!all[i]){
+            alters.clear();
+            net.missingAlters(i, alters, directed ? 0 : i + 1);
+            for(int k=0;k<alters.size();k++)
+                if(directed || !all[alters[k]])
+                    missing.push_back(alters[k]);
+        }
+        missStart[i + 1] = missing.size();
+    }
+    out.writeArray(all);
+    out.writeArray(missStart);
+    out.writeArray(missing);
+
+    std::vector<std::string> dnames = net.discreteVarNames();
+    out.writeInt(dnames.size());
+    for(int i=0;i<dnames.size();i++){
+        DiscreteAttrib attr = net.discreteVariableAttributes(i);
+        out.writeString(attr.getName());
+        out.writeStrings(attr.labels());
+        out.writeInt(attr.hasLowerBound());
+        out.writeInt(attr.lowerBound());
+        out.writeInt(attr.hasUpperBound());
+        out.writeInt(attr.upperBound());
+        out.writeArray(net.discreteVariableColumn(i), n);
+        std::vector<bool> observed = net.discreteVariableObserved(i);
+        out.writeArray(std::vector<char>(observed.begin(), observed.end()));
+    }
+
+    std::vector<std::string> cnames = net.continVarNames();
+    out.writeInt(cnames.size());
+    for(int i=0;i<cnames.size();i++){
+        ContinAttrib attr = net.continVariableAttributes(i);
+        out.writeString(attr.getName());
+        out.writeInt(attr.hasLowerBound());
+        out.writeDouble(attr.lowerBound());
+        out.writeInt(attr.hasUpperBound());
+        out.writeDouble(attr.upperBound());
+        out.writeArray(net.continVariableColumn(i), n);
+        std::vector<bool> observed = net.continVariableObserved(i);
+        out.writeArray(std::vector<char>(observed.begin(), observed.end()));
+    }
+}
+
+
+/*!
+ * Writes a network to file in the binary network file format. The file is
+ * first written to a temporary location and then renamed, so an
+ * interruption while writing does not leave a partial file behind.
+ */
+template<class Engine>
+void writeNetworkFile(BinaryNet<Engine>& net, const std::string& file){
+    std::string tmpFile = file + ".tmp";
+    std::ofstream out(tmpFile.c_str(), std::ios::binary | std::ios::trunc);
+    if(!out)
+        Rcpp::stop("writeNetworkFile: unable to open " + tmpFile + " for writing");
+    writeNetwork(out, net);
+    out.close();
+    if(!out)
+        Rcpp::stop("writeNetworkFile: error writing " + tmpFile);
+    std::remove(file.c_str());
+    if(std::rename(tmpFile.c_str(), file.c_str()) != 0)
+        Rcpp::stop("writeNetworkFile: unable to move network file to " + file);
+}
+
+
+/*!
+ * Checks that compressed sparse row neighbour lists are in increasing order,
+ * in range and without loops (or, for bipartite networks, ties within a mode)
+ */
+template<class Engine>
+void checkNetworkAdjacency(const SnapshotReader& in, const BinaryNet<Engine>& net,
+        const int64_t* start, const int* nbrs, int64_t length){
+    int n = net.size();
+    if(start[0] != 0 || start[n] != length)
+        in.corrupt();
+    for(int i=0;i<n;i++){
+        if(start[i + 1] < start[i])
+            in.corrupt();
+        for(int64_t k=start[i];k<start[i + 1];k++){
+            int j = nbrs[k];
+            if(j < 0 || j >= n || j == i || (k > start[i] && j <= nbrs[k - 1]))
+                in.corrupt();
+            if(net.isBipartite() && (i < net.firstModeSize()) == (j < net.firstModeSize()))
+                in.corrupt();
+        }
+    }
+}
+
+
+/*!
+ * Checks that the lists in (inStart, inNbrs) are the transpose of those in
+ * (outStart, outNbrs), given that both have the same number of entries and
+ * neither has repeats. For undirected networks the two are the same, and the
+ * lists must be symmetric.
+ */
+inline void checkNetworkTranspose(const SnapshotReader& in, int n,
+        const int64_t* outStart, const int* outNbrs, const int64_t* inStart, const int* inNbrs){
+    for(int i=0;i<n;i++){
+        for(int64_t k=outStart[i];k<outStart[i + 1];k++){
+            int j = outNbrs[k];
+            if(!std::binary_search(inNbrs + inStart[j], inNbrs + inStart[j + 1], i))
+                in.corrupt();
+        }
+    }
+}
+
+
+/*!
+ * Reads a network in the binary network file format. The edges are copied
+ * directly from the neighbour lists in the file after they have been checked.
+ * The network must take up the whole of the input.
+ */
+template<class Engine>
+boost::shared_ptr< BinaryNet<Engine> > readNetwork(SnapshotReader& in){
+    char magic[8];
+    in.readRaw(magic, 8);
+    if(std::string(magic, 8) != networkFileMagic())
+        Rcpp::stop("Not a network file");
+    if(in.readInt() != networkFileByteOrder())
+        Rcpp::stop("Network file was written on a machine with a different byte order");
+    int version = in.readInt();
+    if(version != networkFileVersion())
+        Rcpp::stop("Unsupported network file version " + asString(version));
+    std::string engine = in.readString();
+    if(engine != Engine::engineName())
+        Rcpp::stop("Network file holds a " + engine + " network, not a " +
+                Engine::engineName() + " network");
+    in.align();
+    bool directed = in.readInt();
+    int n = in.readInt();
+    int nFirst = in.readInt();
+    in.align();
+    int64_t nEdges = in.readInt64();
+    //the n + 1 offsets of the neighbour lists must fit in the file
+    if(n < 0 || (size_t) n >= in.remaining() / sizeof(int64_t) ||
+            nFirst < 0 || nFirst > n || nEdges < 0)
+        in.corrupt();
+    boost::shared_ptr< BinaryNet<Engine> > net(emptyNetwork<Engine>(n, nFirst));
+    if(directed != net->isDirected())
+        Rcpp::stop("Network file: the network directedness does not match the engine");
+
+    int64_t nOut, nIn;
+    const int64_t* outStart = in.readArray<int64_t>(n + 1);
+    const int* outNbrs = in.readArray<int>(-1, nOut);
+    checkNetworkAdjacency(in, *net, outStart, outNbrs, nOut);
+    if(directed){
+        const int64_t* inStart = in.readArray<int64_t>(n + 1);
+        const int* inNbrs = in.readArray<int>(-1, nIn);
+        checkNetworkAdjacency(in, *net, inStart, inNbrs, nIn);
+        if(nIn != nOut || nOut != nEdges)
+            in.corrupt();
+        checkNetworkTranspose(in, n, outStart, outNbrs, inStart, inNbrs);
+        net->assignEdges(outStart, outNbrs, inStart, inNbrs);
+    }else{
+        if(nOut != 2 * nEdges)
+            in.corrupt();
+        checkNetworkTranspose(in, n, outStart, outNbrs, outStart, outNbrs);
+        net->assignEdges(outStart, outNbrs);
+    }
+
+    int64_t nMissing;
+    const char* all = in.readArray<char>(n);
+    const int64_t* missStart = in.readArray<int64_t>(n + 1);
+    const int* missing = in.readArray<int>(-1, nMissing);
+    if(missStart[0] != 0 || missStart[n] != nMissing)
+        in.corrupt();
+    std::vector<int> allRows;
+    for(int i=0;i<n;i++)
+        if(all[i])
+            allRows.push_back(i);
+    net->setAllDyadsMissing(allRows, true);
+    for(int i=0;i<n;i++){
+        if(missStart[i + 1] < missStart[i])
+            in.corrupt();
+        for(int64_t k=missStart[i];k<missStart[i + 1];k++){
+            if(missing[k] < 0 || missing[k] >= n)
+                in.corrupt();
+            net->setMissing(i, missing[k], true);
+        }
+    }
+
+    int nd = in.readInt();
+    if(nd < 0)
+        in.corrupt();
+    for(int i=0;i<nd;i++){
+        DiscreteAttrib attr;
+        attr.setName(in.readString());
+        attr.setLabels(in.readStrings());
+        bool hasLb = in.readInt();
+        int lb = in.readInt();
+        bool hasUb = in.readInt();
+        int ub = in.readInt();
+        if(hasLb)
+            attr.setLowerBound(lb);
+        if(hasUb)
+            attr.setUpperBound(ub);
+        const int* vals = in.readArray<int>(n);
+        const char* observed = in.readArray<char>(n);
+        int nLabels = attr.labels().size();
+        for(int j=0;j<n;j++)
+            if(vals[j] < 1 || vals[j] > nLabels)
+                in.corrupt();
+        net->addDiscreteVariable(std::vector<int>(vals, vals + n), attr);
+        int which = net->discreteVarNames().size() - 1;
+        for(int j=0;j<n;j++)
+            if(!observed[j])
+                net->setDiscreteVariableObserved(which, j, false);
+    }
+
+    int nc = in.readInt();
+    if(nc < 0)
+        in.corrupt();
+    for(int i=0;i<nc;i++){
+        ContinAttrib attr;
+        attr.setName(in.readString());
+        bool hasLb = in.readInt();
+        double lb = in.readDouble();
+        bool hasUb = in.readInt();
+        double ub = in.readDouble();
+        if(hasLb)
+            attr.setLowerBound(lb);
+        if(hasUb)
+            attr.setUpperBound(ub);
+        const double* vals = in.readArray<double>(n);
+        const char* observed = in.readArray<char>(n);
+        net->addContinVariable(std::vector<double>(vals, vals + n), attr);
+        int which = net->continVarNames().size() - 1;
+        for(int j=0;j<n;j++)
+            if(!observed[j])
+                net->setContinVariableObserved(which, j, false);
+    }
+    if(!in.atEnd())
+        in.corrupt();
+    return net;
+}
+
+
+/*!
+ * Reads a network file written by writeNetworkFile, memory mapping it
+ * rather than reading it through a stream
+ */
+template<class Engine>
+boost::shared_ptr< BinaryNet<Engine> > readNetworkFile(const std::string& file){
+    MappedFile map(file);
+    SnapshotReader in(map.data(), map.size(), "Network file");
+    return readNetwork<Engine>(in);
+}
+
+}
+
+#endif /* NETWORKFILEH_ */
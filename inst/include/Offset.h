@@ -3,6 +3,8 @@
 
 #include <string>
 #include "BinaryNet.h"
+#include "StatArena.h"
+#include "DyadContext.h"
 #include <memory>
 #include <boost/shared_ptr.hpp>
 #include <math.h>
@@ -116,6 +118,13 @@ public:
      */
     virtual bool vIsOrderIndependent() = 0;
 
+    /*!
+     * Is adding the tie (from, to) certain to be rejected, i.e. does it have zero
+     * probability whatever the other terms. Blocked dyads may be skipped by the
+     * generator without being updated.
+     */
+    virtual bool vIsDyadBlocked(const BinaryNet<Engine>& net, const int& from, const int& to) = 0;
+
 };
 
 
@@ -318,6 +327,14 @@ public:
     inline bool isOrderIndependent(){
         return off.isOrderIndependent();
     }
+
+    virtual bool vIsDyadBlocked(const BinaryNet<NetworkEngine>& net, const int& from, const int& to){
+        return isDyadBlocked(net, from, to);
+    }
+
+    inline bool isDyadBlocked(const BinaryNet<NetworkEngine>& net, const int& from, const int& to){
+        return off.isDyadBlocked(net, from, to);
+    }
 };
 
 
@@ -329,14 +346,17 @@ public:
 template<class Engine>
 class BaseOffset {
 protected:
-    std::vector<double> stats; /*!< the statistics */
+    StatBuffer stats; /*!< the statistics */
+
+    StatBuffer lastStats; /*!< the value of the statistics before last update*/
 
-    std::vector<double> lastStats; /*!< the value of the statistics before last update*/
+    DyadContextRef<Engine> context; /*!< the dyad context of the model */
 
+    int nCalcThreads; /*!< the number of threads calculate may use */
 
 public:
 
-    BaseOffset() {};
+    BaseOffset() : nCalcThreads(1){};
 
     virtual ~BaseOffset(){};
 
@@ -405,6 +425,26 @@ public:
         resetLastStats();
     }
 
+    /*!
+     * true if the term implements changeStat
+     */
+    bool hasChangeStat() const{
+        return false;
+    }
+
+    /*!
+     * Computes the change in the statistics from toggling the dyad (from, to)
+     * without modifying the term, writing one value per statistic to out.
+     *
+     * Optional. Terms that implement it must also override hasChangeStat. As it
+     * does not modify any state, it may be called from several threads on the same
+     * network. An accepted toggle is committed with dyadUpdate.
+     */
+    void changeStat(const BinaryNet<Engine>& net, const int &from, const int &to,
+            const std::vector<int> &order, const int &actorIndex, double* out) const{
+        Rf_error("changeStat is not implemented for this term");
+    }
+
     /*!
      * updates the statistic at index i with change changeStatistic
      */
@@ -412,18 +452,94 @@ public:
         stats[index] += changeStatistic;
     }
 
+    /*!
+     * saves the statistics prior to an update. When the statistics live in
+     * a model arena, the model saves them for all terms at once.
+     */
     void resetLastStats(){
+        if(stats.isBound() && lastStats.isBound())
+            return;
         for(int i=0;i<stats.size();i++){
             lastStats[i] = stats[i];
         }
     }
 
     void rollback(const BinaryNet<Engine>& net){
+        if(stats.isBound() && lastStats.isBound())
+            return;
         for(int i=0;i<stats.size();i++){
             stats[i] = lastStats[i];
         }
     }
 
+    /*!
+     * sets the number of threads calculate may use for its own work
+     * (see parallelSum)
+     */
+    void setCalculateThreads(int n){
+        nCalcThreads = std::max(1, n);
+    }
+
+    int calculateThreads() const{
+        return nCalcThreads;
+    }
+
+    /*!
+     * true if calculate may be run concurrently with the calculate of other
+     * terms, i.e. it never calls the R API (including Rf_error). False by default.
+     */
+    bool isCalculateThreadSafe() const{
+        return false;
+    }
+
+    /*!
+     * true if the term implements saveSnapshot and loadSnapshot
+     */
+    bool hasSnapshot() const{
+        return false;
+    }
+
+    /*!
+     * Appends the state computed by calculate (other than the statistics) to out.
+     *
+     * Optional. Together with loadSnapshot, this allows a calculated term to be
+     * saved and restored without recalculating (see Model::snapshot). Terms that
+     * implement it must also override hasSnapshot.
+     */
+    void saveSnapshot(std::vector<double>& out) const{}
+
+    /*!
+     * Restores the state written by saveSnapshot for the network net. The
+     * statistics have already been set.
+     */
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){}
+
+    /*!
+     * shares the model's dyad context with the term
+     */
+    void bindDyadContext(const boost::shared_ptr< DyadContext<Engine> >& ctx){
+        context.bind(ctx);
+    }
+
+    /*!
+     * memoised quantities (shared neighbours, degrees, hasEdge) of the dyad being
+     * updated. When the term is updated by a model, these are shared with the
+     * other terms of the model.
+     */
+    inline DyadContext<Engine>& dyadContext(const BinaryNet<Engine>& net, const int& from, const int& to){
+        return context.get(net, from, to);
+    }
+
+    /*!
+     * binds the statistics to slices of a model arena
+     */
+    void bindStatistics(const boost::shared_ptr<StatArena>& arena, double* st, double* last){
+        if(lastStats.size() != stats.size())
+            lastStats = stats;
+        stats.bind(arena, st);
+        lastStats.bind(arena, last);
+    }
+
     /*!
      * number of statistics
      */
@@ -441,7 +557,7 @@ public:
     /*!
      * returns the models statistics
      */
-    std::vector<double>& statistics(){
+    StatBuffer& statistics(){
         return this->stats;
     }
 
@@ -477,6 +593,14 @@ public:
         return false;
     }
 
+    /*!
+     * true if adding the tie (from, to) to net has zero probability under this
+     * offset, so that the dyad may be skipped during generation. False by default.
+     */
+    bool isDyadBlocked(const BinaryNet<Engine>& net, const int& from, const int& to){
+        return false;
+    }
+
 };
 
 
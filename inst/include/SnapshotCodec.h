@@ -0,0 +1,255 @@
+#ifndef SNAPSHOTCODECH_
+#define SNAPSHOTCODECH_
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <ostream>
+#include <stdint.h>
+
+#include <Rcpp.h>
+
+namespace lolog{
+
+
+/*!
+ * Writes values in native byte order, either to an in memory blob or to a
+ * stream. Used for model snapshots and network files.
+ */
+class SnapshotWriter{
+public:
+    std::vector<unsigned char> bytes; /*!< the blob, when not writing to a stream */
+
+    SnapshotWriter() : out(NULL), pos(0){}
+
+    /*!
+     * writes to a stream rather than to bytes
+     */
+    SnapshotWriter(std::ostream& o) : out(&o), pos(0){}
+
+    void writeRaw(const void* data, size_t size){
+        if(size == 0)
+            return;
+        if(out != NULL){
+            out->write(static_cast<const char*>(data), size);
+        }else{
+            size_t at = bytes.size();
+            bytes.resize(at + size);
+            std::memcpy(&bytes[at], data, size);
+        }
+        pos += size;
+    }
+
+    void writeInt(int value){
+        writeRaw(&value, sizeof(int));
+    }
+
+    void writeInt64(int64_t value){
+        writeRaw(&value, sizeof(int64_t));
+    }
+
+    void writeDouble(double value){
+        writeRaw(&value, sizeof(double));
+    }
+
+    void writeString(const std::string& s){
+        writeInt(s.size());
+        writeRaw(s.data(), s.size());
+    }
+
+    template<class T>
+    void writeVector(const std::vector<T>& vec){
+        writeInt(vec.size());
+        if(vec.size() > 0)
+            writeRaw(&vec[0], vec.size() * sizeof(T));
+    }
+
+    void writeBools(const std::vector<bool>& vec){
+        std::vector<unsigned char> v(vec.begin(), vec.end());
+        writeVector(v);
+    }
+
+    void writeStrings(const std::vector<std::string>& vec){
+        writeInt(vec.size());
+        for(int i=0;i<vec.size();i++)
+            writeString(vec[i]);
+    }
+
+    /*!
+     * pads the output to the next 8 byte boundary
+     */
+    void align(){
+        static const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        writeRaw(zeros, (8 - pos % 8) % 8);
+    }
+
+    /*!
+     * starts an 8 byte aligned array of length elements, which the caller
+     * then writes with writeRaw, followed by a call to align
+     */
+    void beginArray(int64_t length){
+        align();
+        writeInt64(length);
+    }
+
+    /*!
+     * an array that SnapshotReader::readArray can return in place
+     */
+    template<class T>
+    void writeArray(const T* data, int64_t length){
+        beginArray(length);
+        writeRaw(data, length * sizeof(T));
+        align();
+    }
+
+    template<class T>
+    void writeArray(const std::vector<T>& vec){
+        writeArray(vec.empty() ? NULL : &vec[0], vec.size());
+    }
+
+protected:
+    std::ostream* out;
+    size_t pos;
+};
+
+
+/*!
+ * Reads the values written by a SnapshotWriter from memory. Reading past the
+ * end is an error, which is thrown so that the owner of the memory may
+ * release it.
+ */
+class SnapshotReader{
+public:
+    /*!
+     * \param b the blob
+     * \param w how the blob is described in errors
+     */
+    SnapshotReader(const std::vector<unsigned char>& b, const std::string& w = "Model snapshot") :
+        data(b.empty() ? NULL : reinterpret_cast<const char*>(&b[0])), size(b.size()), pos(0), what(w){}
+
+    /*!
+     * reads size bytes at d, which must be 8 byte aligned for readArray
+     */
+    SnapshotReader(const char* d, size_t s, const std::string& w) :
+        data(d), size(s), pos(0), what(w){}
+
+    void readRaw(void* out, size_t length){
+        if(length > size - pos)
+            corrupt();
+        if(length > 0)
+            std::memcpy(out, data + pos, length);
+        pos += length;
+    }
+
+    int readInt(){
+        int value = 0;
+        readRaw(&value, sizeof(int));
+        return value;
+    }
+
+    int64_t readInt64(){
+        int64_t value = 0;
+        readRaw(&value, sizeof(int64_t));
+        return value;
+    }
+
+    double readDouble(){
+        double value = 0.0;
+        readRaw(&value, sizeof(double));
+        return value;
+    }
+
+    std::string readString(){
+        int length = readSize(1);
+        std::string s(data + pos, length);
+        pos += length;
+        return s;
+    }
+
+    template<class T>
+    std::vector<T> readVector(){
+        int length = readSize(sizeof(T));
+        std::vector<T> vec(length);
+        if(length > 0)
+            readRaw(&vec[0], length * sizeof(T));
+        return vec;
+    }
+
+    std::vector<bool> readBools(){
+        std::vector<unsigned char> v = readVector<unsigned char>();
+        return std::vector<bool>(v.begin(), v.end());
+    }
+
+    std::vector<std::string> readStrings(){
+        int length = readSize(sizeof(int));
+        std::vector<std::string> vec(length);
+        for(int i=0;i<length;i++)
+            vec[i] = readString();
+        return vec;
+    }
+
+    void align(){
+        size_t skip = (8 - pos % 8) % 8;
+        if(skip > size - pos)
+            corrupt();
+        pos += skip;
+    }
+
+    /*!
+     * an array written by SnapshotWriter::writeArray, in place
+     *
+     * \param expected the length the array must have, or -1 for any length
+     * \param length set to the length of the array
+     */
+    template<class T>
+    const T* readArray(int64_t expected, int64_t& length){
+        align();
+        length = readInt64();
+        if(length < 0 || (expected >= 0 && length != expected) ||
+                length > (int64_t) ((size - pos) / sizeof(T)))
+            corrupt();
+        const T* result = reinterpret_cast<const T*>(data + pos);
+        pos += length * sizeof(T);
+        align();
+        return result;
+    }
+
+    template<class T>
+    const T* readArray(int64_t expected){
+        int64_t length;
+        return readArray<T>(expected, length);
+    }
+
+    bool atEnd() const{
+        return pos == size;
+    }
+
+    /*!
+     * the number of bytes left to read
+     */
+    size_t remaining() const{
+        return size - pos;
+    }
+
+    void corrupt() const{
+        Rcpp::stop(what + " is truncated or corrupt");
+    }
+
+protected:
+    const char* data;
+    size_t size;
+    size_t pos;
+    std::string what;
+
+    //reads a length, checking that elements of elemSize bytes fit in the remainder
+    int readSize(size_t elemSize){
+        int length = readInt();
+        if(length < 0 || length * elemSize > size - pos)
+            corrupt();
+        return length;
+    }
+};
+
+}
+
+#endif /* SNAPSHOTCODECH_ */
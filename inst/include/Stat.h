@@ -60,6 +60,18 @@ public:
      */
     virtual void vDyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex) = 0;
 
+    /*!
+     * true if the statistic implements vChangeStat
+     */
+    virtual bool vHasChangeStat() const = 0;
+
+    /*!
+     * the change in the statistics from toggling (from, to), written to out,
+     * without modifying the statistic. Only available if vHasChangeStat().
+     */
+    virtual void vChangeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const = 0;
+
     /*!
      * calculate the change in the statistics from a hypothetical vertex toggle,
      * assuming that the network has not changed since the statistic was last calculated.
@@ -105,9 +117,10 @@ public:
     virtual int vSize() = 0;
 
     /*!
-     * returns the models statistics
+     * returns the models statistics. A view of the model arena, which can not
+     * be bound to a std::vector<double>& (see StatBuffer).
      */
-    virtual std::vector<double>& vStatistics() = 0;
+    virtual StatBuffer& vStatistics() = 0;
 
     /*!
      * set the model parameter values
@@ -120,9 +133,46 @@ public:
     virtual void vSetTheta(const std::vector<double>&th) = 0;
 
     /*!
-     * the model parameter values
+     * the model parameter values, as a view of the model arena
+     */
+    virtual StatBuffer& vTheta() = 0;
+
+    /*!
+     * makes the statistics, last statistics and parameters views of
+     * locations in a model arena
+     */
+    virtual void vBindArena(const boost::shared_ptr<StatArena>& arena, double* st,
+            double* last, double* theta) = 0;
+
+    /*!
+     * shares a model's dyad context with the statistic
+     */
+    virtual void vBindDyadContext(const boost::shared_ptr< DyadContext<Engine> >& context) = 0;
+
+    /*!
+     * sets the number of threads vCalculate may use
+     */
+    virtual void vSetCalculateThreads(int n) = 0;
+
+    /*!
+     * true if vCalculate may run concurrently with other statistics
+     */
+    virtual bool vIsCalculateThreadSafe() const = 0;
+
+    /*!
+     * true if the statistic implements vSaveSnapshot and vLoadSnapshot
+     */
+    virtual bool vHasSnapshot() const = 0;
+
+    /*!
+     * appends the calculated state of the statistic (other than the statistics) to out
+     */
+    virtual void vSaveSnapshot(std::vector<double>& out) const = 0;
+
+    /*!
+     * restores the state written by vSaveSnapshot, in place of vCalculate
      */
-    virtual std::vector<double>& vTheta() = 0;
+    virtual void vLoadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in) = 0;
 
     /*!
      * \return the terms
@@ -247,6 +297,24 @@ public:
         stat.dyadUpdate(net,from,to,order,actorIndex);
     }
 
+    virtual bool vHasChangeStat() const{
+        return hasChangeStat();
+    }
+
+    inline bool hasChangeStat() const{
+        return stat.hasChangeStat();
+    }
+
+    virtual void vChangeStat(const BinaryNet<NetworkEngine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        changeStat(net,from,to,order,actorIndex,out);
+    }
+
+    inline void changeStat(const BinaryNet<NetworkEngine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        stat.changeStat(net,from,to,order,actorIndex,out);
+    }
+
     /*!
      * calculate the change in the statistics from a hypothetical vertex toggle,
      * assuming that the network has not changed since the statistic was last calculated.
@@ -341,11 +409,11 @@ public:
     /*!
      * returns the models statistics
      */
-    virtual std::vector<double>& vStatistics(){
+    virtual StatBuffer& vStatistics(){
         return statistics();
     }
 
-    inline std::vector<double>& statistics(){
+    inline StatBuffer& statistics(){
         return stat.statistics();
     }
 
@@ -374,14 +442,60 @@ public:
     /*!
      * the model parameter values
      */
-    virtual std::vector<double>& vTheta(){
+    virtual StatBuffer& vTheta(){
         return theta();
     }
 
-    inline std::vector<double>& theta(){
+    inline StatBuffer& theta(){
         return stat.theta();
     }
 
+    virtual void vBindArena(const boost::shared_ptr<StatArena>& arena, double* st,
+            double* last, double* theta){
+        bindArena(arena, st, last, theta);
+    }
+
+    inline void bindArena(const boost::shared_ptr<StatArena>& arena, double* st,
+            double* last, double* theta){
+        stat.bindArena(arena, st, last, theta);
+    }
+
+    virtual void vBindDyadContext(const boost::shared_ptr< DyadContext<NetworkEngine> >& context){
+        bindDyadContext(context);
+    }
+
+    inline void bindDyadContext(const boost::shared_ptr< DyadContext<NetworkEngine> >& context){
+        stat.bindDyadContext(context);
+    }
+
+    virtual void vSetCalculateThreads(int n){
+        setCalculateThreads(n);
+    }
+
+    inline void setCalculateThreads(int n){
+        stat.setCalculateThreads(n);
+    }
+
+    virtual bool vIsCalculateThreadSafe() const{
+        return isCalculateThreadSafe();
+    }
+
+    inline bool isCalculateThreadSafe() const{
+        return stat.isCalculateThreadSafe();
+    }
+
+    virtual bool vHasSnapshot() const{
+        return stat.hasSnapshot();
+    }
+
+    virtual void vSaveSnapshot(std::vector<double>& out) const{
+        stat.saveSnapshot(out);
+    }
+
+    virtual void vLoadSnapshot(const BinaryNet<NetworkEngine>& net, const std::vector<double>& in){
+        stat.loadSnapshot(net, in);
+    }
+
 
     /*!
      * \return the terms theta * stats
@@ -426,6 +540,54 @@ public:
 };
 
 
+/*!
+ * A log of the cached values a term changed during its last update, so that
+ * rollback can restore them in reverse order rather than recomputing them.
+ *
+ * Each entry is a key identifying the cached value (e.g. a member address or
+ * a dyad) and the value it held before the update. The journal only describes
+ * the last update of the object that wrote it, so copies start empty.
+ */
+template<class Key, class Value>
+class UndoJournal{
+protected:
+    std::vector< std::pair<Key, Value> > entries;
+public:
+
+    UndoJournal(){}
+
+    UndoJournal(const UndoJournal& other){}
+
+    UndoJournal& operator=(const UndoJournal& other){
+        entries.clear();
+        return *this;
+    }
+
+    /*!
+     * records that key held oldValue before the current update
+     */
+    inline void record(const Key& key, const Value& oldValue){
+        entries.push_back(std::make_pair(key, oldValue));
+    }
+
+    inline void clear(){
+        entries.clear();
+    }
+
+    inline int size() const{
+        return entries.size();
+    }
+
+    inline const Key& key(int i) const{
+        return entries[i].first;
+    }
+
+    inline const Value& value(int i) const{
+        return entries[i].second;
+    }
+};
+
+
 /*!
  * a class representing model statistics.
  *
@@ -439,13 +601,43 @@ public:
 template<class Engine>
 class BaseStat : public BaseOffset<Engine>{
 protected:
-    std::vector<double> thetas;/*!< the parameter values */
+    StatBuffer thetas;/*!< the parameter values */
+    UndoJournal<double*, double> undoLog;/*!< cached members changed by the last update */
+
+    /*!
+     * starts an update: stores the statistics for rollback and clears the
+     * undo journal. Call at the start of dyadUpdate before using journal.
+     */
+    void beginUpdate(){
+        BaseOffset<Engine>::resetLastStats();
+        undoLog.clear();
+    }
+
+    /*!
+     * records the current value of a cached member so that rollback restores it.
+     * value must be a member of this statistic.
+     */
+    inline void journal(double& value){
+        undoLog.record(&value, value);
+    }
+
 public:
 
     BaseStat(){}
 
     virtual ~BaseStat(){}
 
+    /*!
+     * restores the statistics and any journaled members to their values
+     * before the last update
+     */
+    void rollback(const BinaryNet<Engine>& net){
+        BaseOffset<Engine>::rollback(net);
+        for(int i=undoLog.size() - 1; i >= 0; i--)
+            *undoLog.key(i) = undoLog.value(i);
+        undoLog.clear();
+    }
+
     /*!
      * zeros and resizes stats and last stats. zeros and resizes theta if it is of the wrong dimension.
      */
@@ -470,10 +662,19 @@ public:
     /*!
      * the model parameter values
      */
-    std::vector<double>& theta(){
+    StatBuffer& theta(){
         return this->thetas;
     }
 
+    /*!
+     * binds the statistics and parameters to slices of a model arena
+     */
+    void bindArena(const boost::shared_ptr<StatArena>& arena, double* st,
+            double* last, double* theta){
+        this->bindStatistics(arena, st, last);
+        thetas.bind(arena, theta);
+    }
+
     /*!
      * \return the terms
      */
@@ -0,0 +1,221 @@
+#ifndef STATARENAH_
+#define STATARENAH_
+
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <atomic>
+#include <boost/shared_ptr.hpp>
+
+namespace lolog{
+
+
+/*!
+ * Contiguous storage for the statistics, the statistics prior to the last
+ * update and the parameter values of every term in a model.
+ *
+ * Each term's buffers are slices of these vectors, so taking a checkpoint
+ * of (or rolling back) the whole model is a single copy.
+ */
+class StatArena{
+public:
+    std::vector<double> stats;      /*!< statistics of all terms, in model order */
+    std::vector<double> lastStats;  /*!< statistics before the last update */
+    std::vector<double> thetas;     /*!< parameter values of all terms, in model order */
+
+    StatArena() : valid(false){}
+
+    /*!
+     * stores the current statistics as the rollback point
+     */
+    inline void checkpoint(){
+        if(stats.size() > 0)
+            std::memcpy(&lastStats[0], &stats[0], stats.size() * sizeof(double));
+    }
+
+    /*!
+     * restores the statistics saved by the last checkpoint
+     */
+    inline void restore(){
+        if(stats.size() > 0)
+            std::memcpy(&stats[0], &lastStats[0], stats.size() * sizeof(double));
+    }
+
+    /*!
+     * false if a term has detached from the arena (e.g. because its number
+     * of statistics changed), in which case the layout must be rebuilt.
+     */
+    bool isValid() const{
+        return valid;
+    }
+
+    void setValid(bool v){
+        valid = v;
+    }
+
+protected:
+    std::atomic<bool> valid;    /*!< atomic, as terms may be calculated concurrently */
+};
+
+
+/*!
+ * A vector of doubles used by terms to hold their statistics and parameters.
+ *
+ * A buffer either owns its memory, or is bound to a slice of a StatArena owned by
+ * a model. Binding is transparent to the term: element access, size and
+ * assignment from a std::vector behave the same in both cases. Assigning a
+ * vector of a different size to a bound buffer detaches it and marks the arena
+ * as needing to be rebuilt.
+ *
+ * Copies of a buffer always own their memory.
+ */
+class StatBuffer{
+public:
+    typedef double value_type;
+    typedef double* iterator;
+    typedef const double* const_iterator;
+
+    StatBuffer() : data_(NULL), size_(0){}
+
+    StatBuffer(int size, double value) : own(size, value){
+        data_ = own.size() > 0 ? &own[0] : NULL;
+        size_ = size;
+    }
+
+    StatBuffer(const std::vector<double>& v) : own(v){
+        data_ = own.size() > 0 ? &own[0] : NULL;
+        size_ = v.size();
+    }
+
+    StatBuffer(const StatBuffer& other) : own(other.begin(), other.end()){
+        data_ = own.size() > 0 ? &own[0] : NULL;
+        size_ = other.size_;
+    }
+
+    StatBuffer& operator=(const StatBuffer& other){
+        if(this != &other)
+            assign(other.begin(), other.size_);
+        return *this;
+    }
+
+    StatBuffer& operator=(const std::vector<double>& v){
+        assign(v.size() > 0 ? &v[0] : NULL, v.size());
+        return *this;
+    }
+
+    operator std::vector<double>() const{
+        return std::vector<double>(begin(), end());
+    }
+
+    inline double& operator[](int i){
+        return data_[i];
+    }
+
+    inline const double& operator[](int i) const{
+        return data_[i];
+    }
+
+    double& at(int i){
+        if(i < 0 || i >= size_)
+            throw std::out_of_range("StatBuffer: index out of range");
+        return data_[i];
+    }
+
+    inline int size() const{
+        return size_;
+    }
+
+    inline bool empty() const{
+        return size_ == 0;
+    }
+
+    inline double* data(){
+        return data_;
+    }
+
+    inline iterator begin(){
+        return data_;
+    }
+
+    inline iterator end(){
+        return data_ + size_;
+    }
+
+    inline const_iterator begin() const{
+        return data_;
+    }
+
+    inline const_iterator end() const{
+        return data_ + size_;
+    }
+
+    /*!
+     * resizes the buffer, detaching it from the arena if the size changes
+     */
+    void resize(int size, double value = 0.0){
+        if(size == size_)
+            return;
+        std::vector<double> v(begin(), end());
+        v.resize(size, value);
+        *this = v;
+    }
+
+    /*!
+     * true if the buffer is a slice of a model arena
+     */
+    inline bool isBound() const{
+        return (bool) arena;
+    }
+
+    /*!
+     * makes the buffer a view of location, copying the current values there.
+     * location must hold size() elements and remain valid while the arena lives.
+     */
+    void bind(const boost::shared_ptr<StatArena>& a, double* location){
+        if(arena && arena != a)
+            arena->setValid(false);
+        if(size_ > 0)
+            std::memmove(location, data_, size_ * sizeof(double));
+        arena = a;
+        data_ = location;
+        std::vector<double>().swap(own);
+    }
+
+    /*!
+     * takes ownership of a copy of the values and detaches from the arena
+     */
+    void unbind(){
+        if(!arena)
+            return;
+        own.assign(begin(), end());
+        data_ = own.size() > 0 ? &own[0] : NULL;
+        arena->setValid(false);
+        arena.reset();
+    }
+
+protected:
+    double* data_;
+    int size_;
+    std::vector<double> own;                /*!< storage when not bound */
+    boost::shared_ptr<StatArena> arena;     /*!< the arena when bound */
+
+    void assign(const double* v, int n){
+        if(arena && n == size_){
+            if(n > 0)
+                std::memmove(data_, v, n * sizeof(double));
+            return;
+        }
+        std::vector<double> tmp(v, v + n);
+        own.swap(tmp);
+        data_ = own.size() > 0 ? &own[0] : NULL;
+        size_ = n;
+        if(arena){
+            arena->setValid(false);
+            arena.reset();
+        }
+    }
+};
+
+}
+
+#endif /* STATARENAH_ */
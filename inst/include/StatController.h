@@ -15,6 +15,10 @@
 #define REGISTER_DIRECTED_STATISTIC(x) ((void(*)(Rcpp::XPtr< lolog::AbstractStat<lolog::Directed> >))R_GetCCallable("lolog", "registerDirectedStatistic"))(x)
 #define REGISTER_UNDIRECTED_OFFSET(x) ((void(*)(Rcpp::XPtr< lolog::AbstractOffset<lolog::Undirected> >))R_GetCCallable("lolog", "registerUndirectedOffset"))(x)
 #define REGISTER_DIRECTED_OFFSET(x) ((void(*)(Rcpp::XPtr< lolog::AbstractOffset<lolog::Directed> >))R_GetCCallable("lolog", "registerDirectedOffset"))(x)
+#define REGISTER_BIPARTITE_STATISTIC(x) ((void(*)(Rcpp::XPtr< lolog::AbstractStat<lolog::Bipartite> >))R_GetCCallable("lolog", "registerBipartiteStatistic"))(x)
+#define REGISTER_BIPARTITE_OFFSET(x) ((void(*)(Rcpp::XPtr< lolog::AbstractOffset<lolog::Bipartite> >))R_GetCCallable("lolog", "registerBipartiteOffset"))(x)
+#define REGISTER_DENSE_STATISTIC(x) ((void(*)(Rcpp::XPtr< lolog::AbstractStat<lolog::Dense> >))R_GetCCallable("lolog", "registerDenseStatistic"))(x)
+#define REGISTER_DENSE_OFFSET(x) ((void(*)(Rcpp::XPtr< lolog::AbstractOffset<lolog::Dense> >))R_GetCCallable("lolog", "registerDenseOffset"))(x)
 
 namespace lolog{
 
@@ -115,5 +119,13 @@ void registerDirectedOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Directed> >
 
 void registerUndirectedOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Undirected> > ps);
 
+void registerBipartiteStatistic(Rcpp::XPtr< lolog::AbstractStat<lolog::Bipartite> > ps);
+
+void registerBipartiteOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Bipartite> > ps);
+
+void registerDenseStatistic(Rcpp::XPtr< lolog::AbstractStat<lolog::Dense> > ps);
+
+void registerDenseOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Dense> > ps);
+
 
 #endif /* STATCONTROLLERH_ */
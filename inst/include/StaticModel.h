@@ -0,0 +1,335 @@
+#ifndef STATICMODELH_
+#define STATICMODELH_
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <cstring>
+#include <boost/shared_ptr.hpp>
+#include <Rcpp.h>
+
+#include "BinaryNet.h"
+#include "Stat.h"
+#include "StatArena.h"
+#include "DyadContext.h"
+#include "LatentOrderLikelihood.h"
+
+namespace lolog{
+
+
+/*!
+ * Applies op to each element of a tuple, in order. op is called as
+ * op(element, index).
+ */
+template<int I, int N>
+struct StaticTermLoop{
+    template<class Tuple, class Op>
+    static inline void apply(Tuple& terms, Op& op){
+        op(std::get<I>(terms), I);
+        StaticTermLoop<I + 1, N>::apply(terms, op);
+    }
+};
+
+template<int N>
+struct StaticTermLoop<N, N>{
+    template<class Tuple, class Op>
+    static inline void apply(Tuple& terms, Op& op){}
+};
+
+
+/*!
+ * A model whose terms are fixed at compile time.
+ *
+ * Terms are concrete statistic types (e.g. Stat<Undirected, Edges<Undirected> >)
+ * held by value, so the updates are called without virtual dispatch and may be
+ * inlined across terms. Statistics and parameters live in a contiguous StatArena,
+ * as in Model.
+ *
+ * The interface used by the generator (network, calculate, dyadUpdateChange,
+ * rollback) mirrors Model, so LatentOrderLikelihood<Engine>::growNetwork may be
+ * instantiated with either. Offsets and constraints are not supported.
+ *
+ * Typically compiled on demand from a formula with compileStaticModel in R.
+ */
+template<class Engine, class... Terms>
+class StaticModel{
+protected:
+    typedef std::tuple<Terms...> TermTuple;
+    static const int nTerms = sizeof...(Terms);
+
+    TermTuple terms;
+    boost::shared_ptr< BinaryNet<Engine> > net;
+    boost::shared_ptr<StatArena> state;
+    boost::shared_ptr< DyadContext<Engine> > context;
+
+    struct CreateOp{
+        Rcpp::List& params;
+        CreateOp(Rcpp::List& p) : params(p){}
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            term = Term(Rcpp::as<Rcpp::List>(params[i]));
+        }
+    };
+
+    struct CalculateOp{
+        const BinaryNet<Engine>& net;
+        CalculateOp(const BinaryNet<Engine>& n) : net(n){}
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            term.calculate(net);
+        }
+    };
+
+    struct SizeOp{
+        int n;
+        SizeOp() : n(0){}
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            if(term.statistics().size() != term.theta().size())
+                ::Rf_error("StaticModel: term %s has %d statistics but %d parameters",
+                        term.name().c_str(), term.statistics().size(), term.theta().size());
+            n += term.statistics().size();
+        }
+    };
+
+    struct BindOp{
+        boost::shared_ptr<StatArena> arena;
+        boost::shared_ptr< DyadContext<Engine> > context;
+        int c;
+        BindOp(const boost::shared_ptr<StatArena>& a,
+                const boost::shared_ptr< DyadContext<Engine> >& ctx) : arena(a), context(ctx), c(0){}
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            int s = term.statistics().size();
+            term.bindArena(arena, slice(arena->stats, c), slice(arena->lastStats, c),
+                    slice(arena->thetas, c));
+            term.bindDyadContext(context);
+            c += s;
+        }
+    };
+
+    struct DyadUpdateOp{
+        const BinaryNet<Engine>& net;
+        const int& from;
+        const int& to;
+        const std::vector<int>& order;
+        const int& actorIndex;
+        DyadUpdateOp(const BinaryNet<Engine>& n, const int& f, const int& t,
+                const std::vector<int>& o, const int& a) :
+            net(n), from(f), to(t), order(o), actorIndex(a){}
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            term.dyadUpdate(net, from, to, order, actorIndex);
+        }
+    };
+
+    struct RollbackOp{
+        const BinaryNet<Engine>& net;
+        RollbackOp(const BinaryNet<Engine>& n) : net(n){}
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            term.rollback(net);
+        }
+    };
+
+    struct NamesOp{
+        std::vector<std::string> names;
+        template<class Term>
+        inline void operator()(Term& term, int i){
+            std::vector<std::string> nm = term.statNames();
+            names.insert(names.end(), nm.begin(), nm.end());
+        }
+    };
+
+    static double* slice(std::vector<double>& v, int offset){
+        return v.size() > 0 ? &v[0] + offset : NULL;
+    }
+
+    template<class Op>
+    inline void forEach(Op& op){
+        StaticTermLoop<0, nTerms>::apply(terms, op);
+    }
+
+    void bindState(){
+        SizeOp size;
+        forEach(size);
+        boost::shared_ptr<StatArena> arena(new StatArena());
+        arena->stats.resize(size.n);
+        arena->lastStats.resize(size.n);
+        arena->thetas.resize(size.n);
+        context = boost::shared_ptr< DyadContext<Engine> >(new DyadContext<Engine>());
+        BindOp bind(arena, context);
+        forEach(bind);
+        arena->setValid(true);
+        state = arena;
+    }
+
+    inline StatArena& ensureState(){
+        if(!state || !state->isValid())
+            bindState();
+        return *state;
+    }
+
+public:
+
+    /*!
+     * \param network the network
+     * \param params a list with the parameters of each term, in order
+     */
+    StaticModel(const BinaryNet<Engine>& network, Rcpp::List params) :
+        net(new BinaryNet<Engine>(network)){
+        if(params.size() != nTerms)
+            ::Rf_error("StaticModel: expected parameters for %d terms, got %d",
+                    nTerms, (int) params.size());
+        CreateOp create(params);
+        forEach(create);
+        calculate();
+    }
+
+    boost::shared_ptr< BinaryNet<Engine> > network() const{
+        return net;
+    }
+
+    void setNetwork(const boost::shared_ptr< BinaryNet<Engine> > network){
+        net = network;
+    }
+
+    void calculate(){
+        CalculateOp calc(*net);
+        forEach(calc);
+        ensureState();
+    }
+
+    const std::vector<double>& statistics(){
+        return ensureState().stats;
+    }
+
+    const std::vector<double>& thetas(){
+        return ensureState().thetas;
+    }
+
+    void setThetas(const std::vector<double>& newThetas){
+        StatArena& arena = ensureState();
+        if(newThetas.size() != arena.thetas.size())
+            ::Rf_error("StaticModel.setThetas: size mismatch");
+        if(newThetas.size() > 0)
+            std::memcpy(&arena.thetas[0], &newThetas[0], newThetas.size() * sizeof(double));
+    }
+
+    std::vector<std::string> names(){
+        NamesOp nm;
+        forEach(nm);
+        return nm.names;
+    }
+
+    double logLik(){
+        StatArena& arena = ensureState();
+        double ll = 0.0;
+        for(int i=0;i<arena.stats.size();i++)
+            ll += arena.stats[i] * arena.thetas[i];
+        return ll;
+    }
+
+    /*!
+     * see Model::dyadUpdate
+     */
+    inline void dyadUpdate(int &from, int &to, std::vector<int> &order, int &actorIndex){
+        ensureState().checkpoint();
+        context->reset(*net, from, to);
+        DyadUpdateOp update(*net, from, to, order, actorIndex);
+        forEach(update);
+        context->clear();
+    }
+
+    /*!
+     * see Model::dyadUpdateChange
+     */
+    inline double dyadUpdateChange(int &from, int &to, std::vector<int> &order, int &actorIndex,
+            std::vector<double>& delta){
+        ensureState().checkpoint();
+        context->reset(*net, from, to);
+        DyadUpdateOp update(*net, from, to, order, actorIndex);
+        forEach(update);
+        context->clear();
+        StatArena& arena = ensureState();
+        int n = arena.stats.size();
+        const double* st = slice(arena.stats, 0);
+        const double* last = slice(arena.lastStats, 0);
+        const double* th = slice(arena.thetas, 0);
+        double lo = 0.0;
+        for(int j=0;j<n;j++){
+            delta[j] = st[j] - last[j];
+            lo += th[j] * delta[j];
+        }
+        return lo;
+    }
+
+    /*!
+     * see Model::isDyadBlocked. Static models have no offsets.
+     */
+    inline bool isDyadBlocked(int from, int to){
+        return false;
+    }
+
+    inline void rollback(){
+        StatArena& arena = ensureState();
+        RollbackOp roll(*net);
+        forEach(roll);
+        arena.restore();
+    }
+
+    /*!
+     * Generates a network from the empty graph with a uniformly random vertex
+     * order. The model network is left unchanged.
+     */
+    Rcpp::List generateNetwork(){
+        GetRNGstate();
+        int n = net->size();
+        std::vector<int> vertices(n);
+        for(int i=0; i<n; i++)
+            vertices[i] = i;
+        LatentOrderLikelihood<Engine>::shuffle(vertices, n);
+        PutRNGstate();
+        return generateNetworkWithOrder(vertices);
+    }
+
+    /*!
+     * Generates a network from the empty graph with the given vertex order.
+     * Returns the same components as LatentOrderLikelihood::generateNetwork.
+     */
+    Rcpp::List generateNetworkWithOrder(std::vector<int> vert_order){
+        if(vert_order.size() != net->size())
+            ::Rf_error("StaticModel: the order must have one element per vertex");
+        boost::shared_ptr< BinaryNet<Engine> > observed = net;
+        net = net->clone();
+        net->emptyGraph();
+        calculate();
+        std::vector<double> emptyStats = statistics();
+        std::vector<double> stats(emptyStats.size(), 0.0);
+        std::vector<double> eStats(emptyStats.size(), 0.0);
+
+        GetRNGstate();
+        LatentOrderLikelihood<Engine>::growNetwork(*this, vert_order, stats, eStats, NULL);
+        PutRNGstate();
+
+        std::vector<int> rankOrder = vert_order;
+        for(int i=0;i<vert_order.size();i++)
+            rankOrder[vert_order[i]] = i;
+        DiscreteAttrib attr = DiscreteAttrib();
+        attr.setName("__order__");
+        net->addDiscreteVariable(rankOrder, attr);
+        Rcpp::List result;
+        result["network"] = net->cloneR();
+        result["emptyNetworkStats"] = wrap(emptyStats);
+        result["stats"] = wrap(stats);
+        result["expectedStats"] = wrap(eStats);
+
+        net = observed;
+        calculate();
+        return result;
+    }
+};
+
+}
+
+#endif /* STATICMODELH_ */
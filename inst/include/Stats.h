@@ -13,130 +13,6 @@
 namespace lolog{
 
 
-
-/*!
- * Counts shared neighbors of two nodes. type == 4
- */
-template<class Engine>
-int sharedNbrs(const BinaryNet<Engine>& net, int from, int to){
-     return sharedNbrs(net, from, to, 4);
-}
-
-
-/*!
- * Counts shared neighbors of two nodes.
- * type = 1     :   from -> to -> nbr -> from
- * type = 2     :   from -> to <- nbr <- from (homogeneous)
- * type = 3     :   either type 1 or 2
- * type = 4     :   all combinations
- */
-template<class Engine>
-int sharedNbrs(const BinaryNet<Engine>& net, int from, int to, int type){
-    if(net.isDirected()){
-        if(type == 4)
-            return allDirectedSharedNbrs(net, from, to);
-        return directedSharedNbrs(net, from, to, type);
-    }
-    return undirectedSharedNbrs(net, from, to);
-}
-
-
-
-template<class Engine>
-int undirectedSharedNbrs(const BinaryNet<Engine>& net, int from, int to){
-    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
-    NeighborIterator fit = net.begin(from);
-    NeighborIterator fend = net.end(from);
-    NeighborIterator tit = net.begin(to);
-    NeighborIterator tend = net.end(to);
-    int shared = 0;
-    while(tit!=tend && fit!=fend){
-        if(*tit==*fit){
-            shared++;
-            tit++;
-            fit++;
-        }else if(*tit<*fit){
-            tit++;
-        }else
-            fit++;
-    }
-    return shared;
-}
-
-template<class Engine>
-int allDirectedSharedNbrs(const BinaryNet<Engine>& net, int from, int to){
-    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
-    NeighborIterator ifit = net.inBegin(from);
-    NeighborIterator ifend = net.inEnd(from);
-    NeighborIterator ofit = net.outBegin(from);
-    NeighborIterator ofend = net.outEnd(from);
-    int shared = 0;
-    while(ifit != ifend){
-        shared += net.hasEdge(*ifit, to);
-        shared += net.hasEdge(to, *ifit);
-        ifit++;
-    }
-    while(ofit != ofend){
-        shared += net.hasEdge(*ofit, to);
-        shared += net.hasEdge(to, *ofit);
-        ofit++;
-    }
-    return shared;
-}
-
-
-/*!
- * type = 1     :   from -> to -> nbr -> from
- * type = 2     :   from -> to <- nbr <- from (homogeneous)
- * type = 3     :   either type 1 or 2
- */
-template<class Engine>
-int directedSharedNbrs(const BinaryNet<Engine>& net, int from, int to, int type){
-    typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
-    NeighborIterator fit, fend, tit, tend;
-
-    int sn = 0;
-    if(type == 1 || type == 3){
-        fit = net.inBegin(from);
-        fend = net.inEnd(from);
-        tit = net.outBegin(to);
-        tend = net.outEnd(to);
-        while(fit != fend && tit != tend){
-            if(*tit == *fit){
-                sn++;
-                tit++;
-                fit++;
-            }else if(*tit < *fit)
-                tit++;
-            else
-                fit++;
-        }
-    }
-    if(type == 2 || type == 3){
-        fit = net.outBegin(from);
-        fend = net.outEnd(from);
-        tit = net.inBegin(to);
-        tend = net.inEnd(to);
-        while(fit != fend && tit != tend){
-            if(*tit == *fit){
-                if(type == 3){
-                    bool counted = net.hasEdge(to, *tit) && net.hasEdge(*tit, from);
-                    if(!counted)
-                        sn++;
-                }else
-                    sn++;
-                tit++;
-                fit++;
-            }else if(*tit < *fit)
-                tit++;
-            else
-                fit++;
-        }
-    }
-    return sn;
-}
-
-
 /*!
  * the number of edges in the network
  */
@@ -162,15 +38,32 @@ public:
         return statnames;
     }
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
     void calculate(const BinaryNet<Engine>& net){
         this->initSingle(net.nEdges());
     }
 
+    bool isCalculateThreadSafe() const{
+        return true;
+    }
+
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
         BaseOffset<Engine>::update(net.hasEdge(from,to) ? -1.0 : 1.0, 0);
     }
 
+    bool hasChangeStat() const{
+        return true;
+    }
+
+    void changeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        out[0] = net.hasEdge(from,to) ? -1.0 : 1.0;
+    }
+
     bool isOrderIndependent(){
         return true;
     }
@@ -182,6 +75,8 @@ public:
 
 typedef Stat<Directed, Edges<Directed> > DirectedEdges;
 typedef Stat<Undirected, Edges<Undirected> > UndirectedEdges;
+typedef Stat<Bipartite, Edges<Bipartite> > BipartiteEdges;
+typedef Stat<Dense, Edges<Dense> > DenseEdges;
 
 
 /*!
@@ -233,6 +128,15 @@ public:
         return statnames;
     }
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){
+        if(!net.isDirected())
+            direction = UNDIRECTED;
+    }
+
     void calculate(const BinaryNet<Engine>& net){
         if(!net.isDirected())
             direction = UNDIRECTED;
@@ -292,6 +196,37 @@ public:
         }
     }
 
+    bool hasChangeStat() const{
+        return true;
+    }
+
+    void changeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        bool edge = net.hasEdge(from,to);
+        int n;
+        if(!net.isDirected())
+            n = net.degree(to);
+        else if(direction==IN)
+            n = net.indegree(to);
+        else
+            n = net.outdegree(from);
+        for(int i=0;i<starDegrees.size();i++){
+            if(edge)
+                out[i] = nchoosek(n-1.0,starDegrees[i]) - nchoosek(n,starDegrees[i]);
+            else
+                out[i] = nchoosek(n+1.0,starDegrees[i]) - nchoosek(n,starDegrees[i]);
+        }
+        if(!net.isDirected()){
+            n = net.degree(from);
+            for(int i=0;i<starDegrees.size();i++){
+                if(edge)
+                    out[i] += nchoosek(n-1.0,starDegrees[i]) - nchoosek(n,starDegrees[i]);
+                else
+                    out[i] += nchoosek(n+1.0,starDegrees[i]) - nchoosek(n,starDegrees[i]);
+            }
+        }
+    }
+
     bool isOrderIndependent(){
         return true;
     }
@@ -300,6 +235,8 @@ public:
 
 typedef Stat<Directed, Star<Directed> > DirectedStar;
 typedef Stat<Undirected, Star<Undirected> > UndirectedStar;
+typedef Stat<Bipartite, Star<Bipartite> > BipartiteStar;
+typedef Stat<Dense, Star<Dense> > DenseStar;
 
 
 /*!
@@ -333,32 +270,17 @@ public:
         std::vector<std::string> statnames(1,"triangles");
         return statnames;
     }
-    int sharedNbrs(const BinaryNet<Engine>& net, int from, int to){
+    int sharedNbrs(const BinaryNet<Engine>& net, int from, int to) const{
         if(net.isDirected()){
             return directedSharedNbrs(net, from, to);
         }
         return undirectedSharedNbrs(net, from, to);
     }
-    int undirectedSharedNbrs(const BinaryNet<Engine>& net, int from, int to){
-        NeighborIterator fit = net.begin(from);
-        NeighborIterator fend = net.end(from);
-        NeighborIterator tit = net.begin(to);
-        NeighborIterator tend = net.end(to);
-        int shared = 0;
-        while(tit!=tend && fit!=fend){
-            if(*tit==*fit){
-                shared++;
-                tit++;
-                fit++;
-            }else if(*tit<*fit){
-                tit++;
-            }else
-                fit++;
-        }
-        return shared;
+    int undirectedSharedNbrs(const BinaryNet<Engine>& net, int from, int to) const{
+        return net.sharedNeighbors(from, to);
     }
 
-    int directedSharedNbrs(const BinaryNet<Engine>& net, int from, int to){
+    int directedSharedNbrs(const BinaryNet<Engine>& net, int from, int to) const{
         NeighborIterator ifit = net.inBegin(from);
         NeighborIterator ifend = net.inEnd(from);
         NeighborIterator ofit = net.outBegin(from);
@@ -378,27 +300,29 @@ public:
     }
 
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
     void calculate(const BinaryNet<Engine>& net){
         this->initSingle(0.0);
-        double sumTri = 0.0;
-
-        boost::shared_ptr<std::vector< std::pair<int,int> > > edges = net.edgelist();
-
-        std::vector< std::pair<int,int> >::iterator it = edges->begin();
-        while(it != edges->end()){
-            int shared = sharedNbrs(net, (*it).first,(*it).second);
-            sumTri += shared;
-            it++;
-        }
+        double sumTri = parallelEdgeSum(net, this->calculateThreads(), [&](int from, int to){
+            return (double) sharedNbrs(net, from, to);
+        });
         sumTri = sumTri/3.0;
         this->stats[0] = sumTri;//sumSqrtTri - sumSqrtExpected;
     }
 
+    bool isCalculateThreadSafe() const{
+        return true;
+    }
+
 
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
-        int shared = sharedNbrs(net, from, to);
-        bool hasEdge = net.hasEdge(from,to);
+        DyadContext<Engine>& dyad = this->dyadContext(net, from, to);
+        int shared = dyad.sharedCount();
+        bool hasEdge = dyad.hasEdge();
         if(hasEdge){
             BaseOffset<Engine>::update(-shared,0);
             //sumTri -= shared;
@@ -409,6 +333,16 @@ public:
         //this->stats[0] = sumTri;//sumSqrtTri - sumSqrtExpected;
     }
 
+    bool hasChangeStat() const{
+        return true;
+    }
+
+    void changeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        int shared = sharedNbrs(net, from, to);
+        out[0] = net.hasEdge(from,to) ? -shared : shared;
+    }
+
     bool isOrderIndependent(){
         return true;
     }
@@ -416,6 +350,7 @@ public:
 
 typedef Stat<Directed, Triangles<Directed> > DirectedTriangles;
 typedef Stat<Undirected, Triangles<Undirected> > UndirectedTriangles;
+typedef Stat<Dense, Triangles<Dense> > DenseTriangles;
 
 
 template<class Engine>
@@ -425,20 +360,17 @@ protected:
     double triangles;
     double twostars;
 
-    double lastTriangles;
-    double lastTwostars;
-
 public:
 
     Clustering(){
-        lastTwostars = lastTriangles = twostars = triangles = 0.0;
+        twostars = triangles = 0.0;
     }
 
     /*!
      * \param params
      */
     Clustering(List params){
-        lastTwostars = lastTriangles = twostars = triangles = 0.0;
+        twostars = triangles = 0.0;
     }
 
     std::string name(){
@@ -450,31 +382,29 @@ public:
         return statnames;
     }
 
-    void resetMemory(){
-        lastTriangles = triangles;
-        lastTwostars = twostars;
+
+    bool hasSnapshot() const{
+        return true;
     }
 
-    void rollback(const BinaryNet<Engine>& net){
-        BaseOffset<Engine>::rollback(net);
-        twostars = lastTwostars;
-        triangles = lastTriangles;
+    void saveSnapshot(std::vector<double>& out) const{
+        out.push_back(triangles);
+        out.push_back(twostars);
     }
 
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){
+        triangles = in.at(0);
+        twostars = in.at(1);
+    }
 
     void calculate(const BinaryNet<Engine>& net){
         int nstats = 1;
 
         this->init(nstats);
         triangles = twostars = 0.0;
-        boost::shared_ptr<std::vector< std::pair<int,int> > > edges = net.edgelist();
-
-        std::vector< std::pair<int,int> >::iterator it = edges->begin();
-        while(it != edges->end()){
-            int shared = sharedNbrs(net, (*it).first,(*it).second);
-            triangles += shared;
-            it++;
-        }
+        triangles = parallelEdgeSum(net, this->calculateThreads(), [&](int from, int to){
+            return (double) sharedNbrs(net, from, to);
+        });
         triangles = triangles/3.0;
 
         twostars = 0.0;
@@ -490,10 +420,12 @@ public:
 
 
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
-        BaseOffset<Engine>::resetLastStats();
-        resetMemory();
-        int shared = sharedNbrs(net, from, to);
-        bool hasEdge = net.hasEdge(from,to);
+        this->beginUpdate();
+        this->journal(triangles);
+        this->journal(twostars);
+        DyadContext<Engine>& dyad = this->dyadContext(net, from, to);
+        int shared = dyad.sharedCount();
+        bool hasEdge = dyad.hasEdge();
         if(hasEdge){
             triangles -= shared;
         }else{
@@ -501,7 +433,7 @@ public:
         }
 
 
-        int n = net.degree(to);
+        int n = dyad.toDegree();
 
         if(hasEdge){
             twostars += -nchoosek(n,2.0) + nchoosek(n-1.0,2.0);
@@ -511,7 +443,7 @@ public:
         }
 
         if(!net.isDirected()){
-            n = net.degree(from);
+            n = dyad.fromDegree();
             if(hasEdge){
                 twostars += -nchoosek(n,2.0) + nchoosek(n-1.0,2.0);
 
@@ -532,6 +464,7 @@ public:
 
 //typedef Stat<Directed, Clustering<Directed> > DirectedClustering;
 typedef Stat<Undirected, Clustering<Undirected> > UndirectedClustering;
+typedef Stat<Dense, Clustering<Dense> > DenseClustering;
 
 
 
@@ -539,23 +472,21 @@ template<class Engine>
 class Transitivity : public BaseStat< Engine > {
 protected:
     typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     double triads;
     double nPosTriads;
 
-    double lastTriads;
-    double lastNPosTriads;
-
 public:
 
     Transitivity(){
-        triads = lastTriads = nPosTriads = lastNPosTriads = 0.0;
+        triads = nPosTriads = 0.0;
     }
 
     /*!
      * \param params
      */
     Transitivity(List params){
-        triads = lastTriads = nPosTriads = lastNPosTriads = 0.0;
+        triads = nPosTriads = 0.0;
     }
 
     std::string name(){
@@ -567,44 +498,45 @@ public:
         return statnames;
     }
 
-    void resetMemory(){
-        lastTriads = triads;
-        lastNPosTriads = nPosTriads;
+
+    bool hasSnapshot() const{
+        return true;
     }
 
-    void rollback(const BinaryNet<Engine>& net){
-        BaseOffset<Engine>::rollback(net);
-        nPosTriads = lastNPosTriads;
-        triads = lastTriads;
+    void saveSnapshot(std::vector<double>& out) const{
+        out.push_back(triads);
+        out.push_back(nPosTriads);
     }
 
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){
+        triads = in.at(0);
+        nPosTriads = in.at(1);
+    }
 
     void calculate(const BinaryNet<Engine>& net){
         int nstats = 1;
 
         this->init(nstats);
         triads = nPosTriads = 0.0;
-        boost::shared_ptr<std::vector< std::pair<int,int> > > edges = net.edgelist();
-
-        std::vector< std::pair<int,int> >::iterator it = edges->begin();
-        while(it != edges->end()){
-            int shared = sharedNbrs(net, (*it).first,(*it).second);
-            triads += shared;
-            nPosTriads += std::min(net.degree((*it).first), net.degree((*it).second)) - 1.0;
-            it++;
-        }
+        triads = parallelEdgeSum(net, this->calculateThreads(), [&](int from, int to){
+            return (double) sharedNbrs(net, from, to);
+        });
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++)
+            nPosTriads += std::min(net.degree(it->first), net.degree(it->second)) - 1.0;
         this->stats[0] = (1.0 + triads) / (1.0 + nPosTriads);
     }
 
 
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
-        BaseOffset<Engine>::resetLastStats();
-        resetMemory();
-        int shared = sharedNbrs(net, from, to);
-        bool hasEdge = net.hasEdge(from,to);
+        this->beginUpdate();
+        this->journal(triads);
+        this->journal(nPosTriads);
+        DyadContext<Engine>& dyad = this->dyadContext(net, from, to);
+        int shared = dyad.sharedCount();
+        bool hasEdge = dyad.hasEdge();
         int change = hasEdge ? -1 : 1;
-        int fromDeg = net.degree(from);
-        int toDeg = net.degree(to);
+        int fromDeg = dyad.fromDegree();
+        int toDeg = dyad.toDegree();
         triads += change * 3.0 * shared;
         NeighborIterator it = net.begin(from);
         NeighborIterator end = net.end(from);
@@ -634,12 +566,16 @@ public:
 };
 typedef Stat<Directed, Transitivity<Directed> > DirectedTransitivity;
 typedef Stat<Undirected, Transitivity<Undirected> > UndirectedTransitivity;
+typedef Stat<Dense, Transitivity<Dense> > DenseTransitivity;
 
 /*!
  * the number of reciprocal edges in the network
  */
 template<class Engine>
 class Mutual : public BaseStat< Engine > {
+protected:
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
+
 public:
     Mutual(){
         std::vector<double> v(1,0.0);
@@ -666,6 +602,10 @@ public:
         return statnames;
     }
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
     void calculate(const BinaryNet<Engine>& net){
         this->init(1);
         if(!net.isDirected())
@@ -673,10 +613,9 @@ public:
 
         double rec = 0.0;
         int from, to;
-        boost::shared_ptr< std::vector< std::pair<int,int> > > edges = net.edgelist();
-        for(int i=0;i<edges->size();i++){
-            from = (*edges)[i].first;
-            to = (*edges)[i].second;
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+            from = it->first;
+            to = it->second;
             if(from<to && net.hasEdge(to,from))
                 rec++;
         }
@@ -698,6 +637,18 @@ public:
         BaseOffset<Engine>::update(change,0);
     }
 
+    bool hasChangeStat() const{
+        return true;
+    }
+
+    void changeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        if(!net.hasEdge(to,from))
+            out[0] = 0.0;
+        else
+            out[0] = net.hasEdge(from,to) ? -1.0 : 1.0;
+    }
+
     bool isOrderIndependent(){
         return true;
     }
@@ -714,6 +665,7 @@ template<class Engine>
 class NodeMatch : public BaseStat< Engine > {
 protected:
     typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     std::string variableName; /*!< the name of the matching variable */
     int varIndex; /*!< the index of the variable in the network */
     int nstats; /*!< the number of stats generated (i.e. the number of levels squared) */
@@ -763,12 +715,12 @@ public:
         //nstats = nlevels*nlevels;
         nstats = 1;
         this->init(nstats);
-        boost::shared_ptr< std::vector< std::pair<int,int> > > edges = net.edgelist();
-        for(int i=0;i<edges->size();i++){
-            from = (*edges)[i].first;
-            to = (*edges)[i].second;
-            value1 = net.discreteVariableValue(varIndex,from) - 1;
-            value2 = net.discreteVariableValue(varIndex,to) - 1;
+        const int* values = net.discreteVariableColumn(varIndex);
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+            from = it->first;
+            to = it->second;
+            value1 = values[from] - 1;
+            value2 = values[to] - 1;
             //this->stats[value1 + nlevels*value2]++;
             if(value1==value2)
                 this->stats[0]++;
@@ -789,17 +741,28 @@ public:
         }
     }
 
+    bool hasChangeStat() const{
+        return true;
+    }
+
+    void changeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        bool match = net.discreteVariableValue(varIndex,from) == net.discreteVariableValue(varIndex,to);
+        out[0] = !match ? 0.0 : (net.hasEdge(from,to) ? -1.0 : 1.0);
+    }
+
     void discreteVertexUpdate(const BinaryNet<Engine>& net, const  int& vert,
             const int& variable, const  int& newValue, const  std::vector<int> &order, const  int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
         if(variable != varIndex)
             return;
-        int val = net.discreteVariableValue(varIndex,vert);
+        const int* values = net.discreteVariableColumn(varIndex);
+        int val = values[vert];
         if(net.isDirected()){
             NeighborIterator it = net.outBegin(vert);
             NeighborIterator end = net.outEnd(vert);
             while(it!=end){
-                int val2 = net.discreteVariableValue(varIndex,*it);
+                int val2 = values[*it];
                 if(val2==val)
                     BaseOffset<Engine>::update(-1.0,0);//this->stats[0]--;
                 if(val2==newValue)
@@ -809,7 +772,7 @@ public:
             it = net.inBegin(vert);
             end = net.inEnd(vert);
             while(it!=end){
-                int val2 = net.discreteVariableValue(varIndex,*it);
+                int val2 = values[*it];
                 if(val2==val)
                     BaseOffset<Engine>::update(-1.0,0);//this->stats[0]--;
                 if(val2==newValue)
@@ -820,7 +783,7 @@ public:
             NeighborIterator it = net.begin(vert);
             NeighborIterator end = net.end(vert);
             while(it!=end){
-                int val2 = net.discreteVariableValue(varIndex,*it);
+                int val2 = values[*it];
                 if(val2==val)
                     BaseOffset<Engine>::update(-1.0,0);//this->stats[0]--;
                 if(val2==newValue)
@@ -842,6 +805,8 @@ public:
 
 typedef Stat<Directed, NodeMatch<Directed> > DirectedNodeMatch;
 typedef Stat<Undirected, NodeMatch<Undirected> > UndirectedNodeMatch;
+typedef Stat<Bipartite, NodeMatch<Bipartite> > BipartiteNodeMatch;
+typedef Stat<Dense, NodeMatch<Dense> > DenseNodeMatch;
 
 
 
@@ -853,6 +818,7 @@ template<class Engine>
 class NodeMix : public BaseStat< Engine > {
 protected:
     typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     std::string variableName; /*!< the name of the matching variable */
     int varIndex; /*!< the index of the variable in the network */
     int nstats; /*!< the number of stats generated (i.e. the number of levels squared) */
@@ -923,12 +889,12 @@ public:
         nlevels = levels.size();
         nstats = nlevels * (nlevels + 1) / 2;
         this->init(nstats);
-        boost::shared_ptr< std::vector< std::pair<int,int> > > edges = net.edgelist();
-        for(int i=0;i<edges->size();i++){
-            from = (*edges)[i].first;
-            to = (*edges)[i].second;
-            value1 = net.discreteVariableValue(varIndex,from) - 1;
-            value2 = net.discreteVariableValue(varIndex,to) - 1;
+        const int* values = net.discreteVariableColumn(varIndex);
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+            from = it->first;
+            to = it->second;
+            value1 = values[from] - 1;
+            value2 = values[to] - 1;
             //this->stats[value1 + nlevels*value2]++;
             this->stats[getIndex(value1,value2)]++;
 
@@ -964,6 +930,8 @@ public:
 
 typedef Stat<Directed, NodeMix<Directed> > DirectedNodeMix;
 typedef Stat<Undirected, NodeMix<Undirected> > UndirectedNodeMix;
+typedef Stat<Bipartite, NodeMix<Bipartite> > BipartiteNodeMix;
+typedef Stat<Dense, NodeMix<Dense> > DenseNodeMix;
 
 
 
@@ -1101,6 +1069,8 @@ public:
 
 typedef Stat<Directed, Degree<Directed> > DirectedDegree;
 typedef Stat<Undirected, Degree<Undirected> > UndirectedDegree;
+typedef Stat<Bipartite, Degree<Bipartite> > BipartiteDegree;
+typedef Stat<Dense, Degree<Dense> > DenseDegree;
 
 
 template<class Engine>
@@ -1110,20 +1080,17 @@ protected:
     double nEdges;
     double crossProd;
 
-    double lastNEdges;
-    double lastCrossProd;
-
 public:
 
     DegreeCrossProd(){
-        lastNEdges = lastCrossProd = crossProd = nEdges = 0.0;
+        crossProd = nEdges = 0.0;
     }
 
     /*!
      * \param params
      */
     DegreeCrossProd(List params){
-        lastNEdges = lastCrossProd = nEdges = crossProd = 0.0;
+        nEdges = crossProd = 0.0;
     }
 
     std::string name(){
@@ -1135,31 +1102,29 @@ public:
         return statnames;
     }
 
-    void resetMemory(){
-        lastNEdges = nEdges;
-        lastCrossProd = crossProd;
+
+    bool hasSnapshot() const{
+        return true;
     }
 
-    void rollback(const BinaryNet<Engine>& net){
-        BaseOffset<Engine>::rollback(net);
-        nEdges = lastNEdges;
-        crossProd = lastCrossProd;
+    void saveSnapshot(std::vector<double>& out) const{
+        out.push_back(nEdges);
+        out.push_back(crossProd);
     }
 
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){
+        nEdges = in.at(0);
+        crossProd = in.at(1);
+    }
 
     void calculate(const BinaryNet<Engine>& net){
         int nstats = 1;
 
         this->init(nstats);
         nEdges = net.nEdges();
-        crossProd = 0.0;
-        boost::shared_ptr<std::vector< std::pair<int,int> > > edges = net.edgelist();
-
-        std::vector< std::pair<int,int> >::iterator it = edges->begin();
-        while(it != edges->end()){
-            crossProd += net.degree((*it).first) * net.degree((*it).second);
-            it++;
-        }
+        crossProd = parallelEdgeSum(net, this->calculateThreads(), [&](int from, int to){
+            return (double) net.degree(from) * net.degree(to);
+        });
         if(nEdges==0)
             this->stats[0] = 0;
         else
@@ -1168,8 +1133,9 @@ public:
 
 
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
-        BaseOffset<Engine>::resetLastStats();
-        resetMemory();
+        this->beginUpdate();
+        this->journal(nEdges);
+        this->journal(crossProd);
         double toDeg;
         double fromDeg;
         bool addingEdge = !net.hasEdge(from,to);
@@ -1220,6 +1186,8 @@ public:
 
 typedef Stat<Directed, DegreeCrossProd<Directed> > DirectedDegreeCrossProd;
 typedef Stat<Undirected, DegreeCrossProd<Undirected> > UndirectedDegreeCrossProd;
+typedef Stat<Bipartite, DegreeCrossProd<Bipartite> > BipartiteDegreeCrossProd;
+typedef Stat<Dense, DegreeCrossProd<Dense> > DenseDegreeCrossProd;
 
 
 /*!
@@ -1276,7 +1244,7 @@ public:
         return statnames;
     }
 
-    double getValue(const BinaryNet<Engine>& net, int ind){
+    double getValue(const BinaryNet<Engine>& net, int ind) const{
         double val;
         if(isDiscrete)
             val = net.discreteVariableValue(varIndex,ind);
@@ -1309,8 +1277,10 @@ public:
         int nstats = 1;
         this->init(nstats);
         this->stats[0] = 0;
+        const double* contValues = isDiscrete ? NULL : net.continVariableColumn(varIndex);
+        const int* disValues = isDiscrete ? net.discreteVariableColumn(varIndex) : NULL;
         for(int i=0;i<net.size();i++){
-            double val = getValue(net,i);
+            double val = isDiscrete ? disValues[i] : contValues[i];
             if(net.isDirected()){
                 if(direction == IN || direction == UNDIRECTED)
                     this->stats[0] += val * net.indegree(i);
@@ -1336,6 +1306,24 @@ public:
         }
     }
 
+    bool hasChangeStat() const{
+        return true;
+    }
+
+    void changeStat(const BinaryNet<Engine>& net,const int &from,const int &to,
+            const std::vector<int> &order,const int &actorIndex, double* out) const{
+        double change = 2.0 * (!net.hasEdge(from,to) - 0.5);
+        out[0] = 0.0;
+        if(net.isDirected()){
+            if(direction == IN || direction == UNDIRECTED)
+                out[0] += change * getValue(net,to);
+            if(direction == OUT || direction == UNDIRECTED)
+                out[0] += change * getValue(net,from);
+        }else{
+            out[0] = change * (getValue(net,to)+getValue(net,from));
+        }
+    }
+
     void discreteVertexUpdate(const BinaryNet<Engine>& net, const  int& vert,
             const int& variable, const  int& newValue, const  std::vector<int> &order, const  int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
@@ -1384,6 +1372,8 @@ public:
 
 typedef Stat<Directed, NodeCov<Directed> > DirectedNodeCov;
 typedef Stat<Undirected, NodeCov<Undirected> > UndirectedNodeCov;
+typedef Stat<Bipartite, NodeCov<Bipartite> > BipartiteNodeCov;
+typedef Stat<Dense, NodeCov<Dense> > DenseNodeCov;
 
 
 
@@ -1391,21 +1381,21 @@ template<class Engine>
 class Gwesp : public BaseStat< Engine > {
 protected:
     typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     double alpha;
     double oneexpa;
     double expa;
     std::vector< boost::container::flat_map<int,int> > sharedValues;
-    int lastFrom;
-    int lastTo;
+    UndoJournal< std::pair<int,int>, int > sharedLog; /*!< prior cache entries, -1 if absent */
 public:
 
     Gwesp() : alpha(.5), oneexpa(1.0 - exp(-alpha)), expa(exp(alpha)),
-    sharedValues(), lastFrom(0), lastTo(0){
+    sharedValues(){
     }
 
     virtual ~Gwesp(){};
 
-    Gwesp(List params) : sharedValues(), lastFrom(0), lastTo(0){
+    Gwesp(List params) : sharedValues(){
         ParamParser p(name(), params);
         alpha = p.parseNext< double >("alpha");
         p.end();
@@ -1438,18 +1428,13 @@ public:
         if(it != sharedValues[f].end()){
             return it->second;
         }
+        if(!net.isDirected())
+            return net.sharedNeighbors(f, t);
         NeighborIterator fit1, fend1, tit1, tend1;
-        if(!net.isDirected()){
-            fit1 = net.begin(f);
-            fend1 = net.end(f);
-            tit1 = net.begin(t);
-            tend1 = net.end(t);
-        }else{
-            fit1 = net.inBegin(f);
-            fend1 = net.inEnd(f);
-            tit1 = net.outBegin(t);
-            tend1 = net.outEnd(t);
-        }
+        fit1 = net.inBegin(f);
+        fend1 = net.inEnd(f);
+        tit1 = net.outBegin(t);
+        tend1 = net.outEnd(t);
         int sn = 0;
         while(fit1 != fend1 && tit1 != tend1){
             if(*tit1 == *fit1){
@@ -1470,6 +1455,7 @@ public:
             f = std::min(f,t);
             t = std::max(tmp,t);
         }
+        journalSharedValue(f, t);
         sharedValues[f][t] = nbrs;
     }
     void eraseSharedValue(const BinaryNet<Engine>& net, int f, int t){
@@ -1478,79 +1464,109 @@ public:
             f = std::min(f,t);
             t = std::max(tmp,t);
         }
+        journalSharedValue(f, t);
         sharedValues[f].erase(t);
     }
 
+    //records the cached value of (f, t) before it is changed. (f, t) must be normalized.
+    void journalSharedValue(int f, int t){
+        boost::container::flat_map<int,int>::iterator it = sharedValues[f].find(t);
+        sharedLog.record(std::make_pair(f, t), it != sharedValues[f].end() ? it->second : -1);
+    }
+
+    bool hasSnapshot() const{
+        return true;
+    }
+
+    //the shared neighbor cache, as (from, to, value) triples
+    void saveSnapshot(std::vector<double>& out) const{
+        for(int i=0;i<sharedValues.size();i++){
+            boost::container::flat_map<int,int>::const_iterator it = sharedValues[i].begin();
+            for(; it != sharedValues[i].end(); it++){
+                out.push_back(i);
+                out.push_back(it->first);
+                out.push_back(it->second);
+            }
+        }
+    }
+
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){
+        sharedValues = std::vector< boost::container::flat_map<int,int> >(net.size());
+        sharedLog.clear();
+        for(int i=0;i + 2 < in.size();i += 3){
+            boost::container::flat_map<int,int>& m = sharedValues[(int) in[i]];
+            m.insert(m.end(), std::make_pair((int) in[i + 1], (int) in[i + 2]));
+        }
+    }
+
     virtual void calculate(const BinaryNet<Engine>& net){
         this->init(1);
         double result = 0.0;
         sharedValues = std::vector< boost::container::flat_map<int,int> >();
         for(int i = 0 ; i<net.size();i++)
             sharedValues.push_back(boost::container::flat_map<int,int>());
-        boost::shared_ptr<std::vector< std::pair<int,int> > > el = net.edgelist();
-        for(int i=0;i<el->size();i++){
-            int from = el->at(i).first;
-            int to = el->at(i).second;
-            int sn = sharedNbrs(net, from, to);
-            setSharedValue(net,from,to,sn);
-            result += 1.0 - pow(oneexpa,sn);
+        //count shared partners in parallel, then fill the cache in edge order
+        int nThreads = std::max(1, std::min(this->calculateThreads(), net.nEdges()));
+        std::vector< std::vector<int> > sn(nThreads);
+        parallelEdges(net, nThreads, [&](int t, EdgeIterator it, EdgeIterator end){
+            for(;it != end;it++)
+                sn[t].push_back(sharedNbrs(net, it->first, it->second));
+        });
+        EdgeIterator it = net.edgesBegin();
+        for(int t=0;t<nThreads;t++){
+            for(int i=0;i<sn[t].size();i++,it++){
+                setSharedValue(net,it->first,it->second,sn[t][i]);
+                result += 1.0 - pow(oneexpa,sn[t][i]);
+            }
         }
         this->stats[0] = expa * result;
+        sharedLog.clear();
+    }
+
+    bool isCalculateThreadSafe() const{
+        return true;
     }
 
 
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
-        BaseOffset<Engine>::resetLastStats();
-        NeighborIterator fit, fend, tit, tend;
-        if(!net.isDirected()){
-            fit = net.begin(from);
-            fend = net.end(from);
-            tit = net.begin(to);
-            tend = net.end(to);
-        }else{
-            fit = net.inBegin(from);
-            fend = net.inEnd(from);
-            tit = net.outBegin(to);
-            tend = net.outEnd(to);
-        }
-        bool add = !net.hasEdge(from,to);
+        this->beginUpdate();
+        sharedLog.clear();
+        DyadContext<Engine>& dyad = this->dyadContext(net, from, to);
+        const std::vector<int>& shared = dyad.sharedList();
+        bool add = !dyad.hasEdge();
         double change = 2.0 * (add - 0.5);
         double delta = 0.0;
-        int sn = 0;
+        int sn = shared.size();
         double mult = (1.0 - (!add ? 1.0/oneexpa : oneexpa));
-        while(fit != fend && tit != tend){
-            if(*tit == *fit){
-                sn++;
-                //tie from to --> shared neighbor
-                int tnsn = sharedNbrs(net,to,*tit);
-                setSharedValue(net,to,*tit,tnsn + (add ? 1 : -1));
-                delta += pow(oneexpa,tnsn) * mult;//pow(oneexpa,tnsn) - pow(oneexpa,tnsn + change);
-
-                //tie from shared neighbor --> from
-                int nfsn = sharedNbrs(net,*tit,from);
-                setSharedValue(net,*tit,from,nfsn + (add ? 1 : -1));
-                delta += pow(oneexpa,nfsn) * mult;
-                tit++;
-                fit++;
-            }else if(*tit < *fit)
-                tit = std::lower_bound(tit,tend,*fit);
-            else
-                fit = std::lower_bound(fit,fend,*tit);
+        for(int i=0;i<sn;i++){
+            int nbr = shared[i];
+            //tie from to --> shared neighbor
+            int tnsn = sharedNbrs(net,to,nbr);
+            setSharedValue(net,to,nbr,tnsn + (add ? 1 : -1));
+            delta += pow(oneexpa,tnsn) * mult;//pow(oneexpa,tnsn) - pow(oneexpa,tnsn + change);
+
+            //tie from shared neighbor --> from
+            int nfsn = sharedNbrs(net,nbr,from);
+            setSharedValue(net,nbr,from,nfsn + (add ? 1 : -1));
+            delta += pow(oneexpa,nfsn) * mult;
         }
         if(add)
             setSharedValue(net,from,to,sn);
         else
             eraseSharedValue(net,from,to);
-        lastFrom=from;
-        lastTo=to;
         this->stats[0] += expa * (delta + change * (1.0 - pow(oneexpa,sn)));
     }
 
     void rollback(const BinaryNet<Engine>& net){
-        BinaryNet<Engine>* pnet = const_cast< BinaryNet<Engine>* > (&net);
-        pnet->toggle(lastFrom, lastTo);
-        this->dyadUpdate(net, lastFrom, lastTo, std::vector<int>(), -1);
-        pnet->toggle(lastFrom, lastTo);
+        BaseStat<Engine>::rollback(net);
+        for(int i=sharedLog.size() - 1; i >= 0; i--){
+            const std::pair<int,int>& dyad = sharedLog.key(i);
+            if(sharedLog.value(i) < 0)
+                sharedValues[dyad.first].erase(dyad.second);
+            else
+                sharedValues[dyad.first][dyad.second] = sharedLog.value(i);
+        }
+        sharedLog.clear();
     }
 
     bool isOrderIndependent(){
@@ -1560,6 +1576,7 @@ public:
 
 typedef Stat<Directed, Gwesp<Directed> > DirectedGwesp;
 typedef Stat<Undirected, Gwesp<Undirected> > UndirectedGwesp;
+typedef Stat<Dense, Gwesp<Dense> > DenseGwesp;
 
 
 
@@ -1607,6 +1624,15 @@ public:
 
     }
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
+    void loadSnapshot(const BinaryNet<Engine>& net, const std::vector<double>& in){
+        oneexpa = 1.0 - exp(-alpha);
+        expalpha = exp(alpha);
+    }
+
     virtual void calculate(const BinaryNet<Engine>& net){
         oneexpa = 1.0 - exp(-alpha);
         expalpha = exp(alpha);
@@ -1662,6 +1688,8 @@ public:
 
 typedef Stat<Directed, GwDegree<Directed> > DirectedGwDegree;
 typedef Stat<Undirected, GwDegree<Undirected> > UndirectedGwDegree;
+typedef Stat<Bipartite, GwDegree<Bipartite> > BipartiteGwDegree;
+typedef Stat<Dense, GwDegree<Dense> > DenseGwDegree;
 
 
 template<class Engine>
@@ -1698,18 +1726,13 @@ public:
     //in directed networks this only counts | t --> f --> neighbor --> t | cycles.
 
     int sharedNbrs(const BinaryNet<Engine>& net, int f, int t){
+        if(!net.isDirected())
+            return net.sharedNeighbors(f, t);
         NeighborIterator fit, fend, tit, tend;
-        if(!net.isDirected()){
-            fit = net.begin(f);
-            fend = net.end(f);
-            tit = net.begin(t);
-            tend = net.end(t);
-        }else{
-            fit = net.inBegin(f);
-            fend = net.inEnd(f);
-            tit = net.outBegin(t);
-            tend = net.outEnd(t);
-        }
+        fit = net.inBegin(f);
+        fend = net.inEnd(f);
+        tit = net.outBegin(t);
+        tend = net.outEnd(t);
 
         int sn = 0;
         while(fit != fend && tit != tend){
@@ -1725,18 +1748,20 @@ public:
         return sn;
     }
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
     virtual void calculate(const BinaryNet<Engine>& net){
         this->init(1);
 
         //for each node, how many neighbors does its neighbor have? Where end index is greater than starting index, to avoid duplicates
 
-        double result = 0.0;
-
         double oneexpa = 1 - exp(-alpha);
         int n = net.size();
         //std::vector<int> dp ;
 
-        for (int f=0;f<n;f++){
+        double result = parallelSum(n, this->calculateThreads(), [&](int f){
             std::set<int> twoaways;
             NeighborIterator fit, fend;
             if(!net.isDirected()){
@@ -1768,13 +1793,20 @@ public:
                 }
                 fit++;
             }
+            double r = 0.0;
             std::set<int>::iterator it;//set iterator
-            for (it = twoaways.begin() ; it!=twoaways.end(); ++it)                 result += 1.0 - pow(oneexpa,sharedNbrs(net,f,*it));
-        }
+            for (it = twoaways.begin() ; it!=twoaways.end(); ++it)
+                r += 1.0 - pow(oneexpa,sharedNbrs(net,f,*it));
+            return r;
+        });
 
         this->stats[0] = exp(alpha) * result;
     }
 
+    bool isCalculateThreadSafe() const{
+        return true;
+    }
+
 
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
@@ -1822,6 +1854,8 @@ public:
 
 typedef Stat<Directed, Gwdsp<Directed> > DirectedGwdsp;
 typedef Stat<Undirected, Gwdsp<Undirected> > UndirectedGwdsp;
+typedef Stat<Bipartite, Gwdsp<Bipartite> > BipartiteGwdsp;
+typedef Stat<Dense, Gwdsp<Dense> > DenseGwdsp;
 
 //Edgewise Shared Parnters. One stat for each user-generated value.
 template<class Engine>
@@ -1829,6 +1863,7 @@ class Esp : public BaseStat< Engine > {
     //first part of code based on the code for Degree
 protected:
     typedef typename BinaryNet<Engine>::NeighborIterator NeighborIterator;
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     std::vector<int> esps;
     int type;
 
@@ -1876,62 +1911,57 @@ public:
         return statnames;
     }
 
+    bool hasSnapshot() const{
+        return true;
+    }
+
     virtual void calculate(const BinaryNet<Engine>& net){
         int nstats = esps.size();
         this->init(nstats);
 
-        boost::shared_ptr< std::vector<std::pair<int,int> > > el = net.edgelist();
-
-        for(int i=0;i<el->size();i++){
-            int from = el->at(i).first;
-            int to = el->at(i).second;
-            int espi = sharedNbrs(net, from, to, type);
-            for(int j=0;j<nstats;j++){
-                this->stats[j] += espi==esps[j];
+        int nThreads = std::max(1, std::min(this->calculateThreads(), net.nEdges()));
+        std::vector< std::vector<double> > partial(nThreads, std::vector<double>(nstats, 0.0));
+        parallelEdges(net, nThreads, [&](int t, EdgeIterator it, EdgeIterator end){
+            for(;it != end;it++){
+                int espi = sharedNbrs(net, it->first, it->second, type);
+                for(int j=0;j<nstats;j++){
+                    partial[t][j] += espi==esps[j];
+                }
             }
-        }
+        });
+        for(int t=0;t<nThreads;t++)
+            for(int j=0;j<nstats;j++)
+                this->stats[j] += partial[t][j];
 
     }
 
+    bool isCalculateThreadSafe() const{
+        return true;
+    }
+
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
+        DyadContext<Engine>& dyad = this->dyadContext(net, from, to);
         int nstats = esps.size();
-        int espi = sharedNbrs(net, from, to, type);
-        double change = 2.0 * (!net.hasEdge(from,to) - 0.5);
+        int espi = dyad.sharedCount(type);
+        double change = 2.0 * (!dyad.hasEdge() - 0.5);
         for(int j=0;j<nstats;j++){ //main edge change from-to
             this->stats[j] += change*(espi==esps[j]);
         }
         if(type == 1 || !net.isDirected()){
-            NeighborIterator fit, fend, tit, tend;
-            if(!net.isDirected()){
-                fit = net.begin(from);
-                fend = net.end(from);
-                tit = net.begin(to);
-                tend = net.end(to);
-            }else{
-                fit = net.inBegin(from);
-                fend = net.inEnd(from);
-                tit = net.outBegin(to);
-                tend = net.outEnd(to);
-            }
-            while(fit != fend && tit != tend){
-                if(*tit == *fit){ //it's a shared neighbor
-                    int fnsn = sharedNbrs(net, *fit, from,  type);
-                    for(int j=0;j<nstats;j++){ // side edge change +/-1
-                        this->stats[j] += (fnsn+change)==esps[j];
-                        this->stats[j] -= fnsn==esps[j];
-                    }
-                    int tnsn = sharedNbrs(net, to, *fit, type);
-                    for(int j=0;j<nstats;j++){ // side edge change +/-1
-                        this->stats[j] += (tnsn+change)==esps[j];
-                        this->stats[j] -= tnsn==esps[j];
-                    }
-                    tit++;
-                    fit++;
-                }else if(*tit < *fit)
-                    tit++;
-                else
-                    fit++;
+            const std::vector<int>& shared = dyad.sharedList();
+            for(int i=0;i<shared.size();i++){ //shared neighbors
+                int nbr = shared[i];
+                int fnsn = sharedNbrs(net, nbr, from,  type);
+                for(int j=0;j<nstats;j++){ // side edge change +/-1
+                    this->stats[j] += (fnsn+change)==esps[j];
+                    this->stats[j] -= fnsn==esps[j];
+                }
+                int tnsn = sharedNbrs(net, to, nbr, type);
+                for(int j=0;j<nstats;j++){ // side edge change +/-1
+                    this->stats[j] += (tnsn+change)==esps[j];
+                    this->stats[j] -= tnsn==esps[j];
+                }
             }
         }else{
             // A bit brute force. Will work with any definition of shared nbr
@@ -2012,6 +2042,7 @@ public:
 
 typedef Stat<Directed, Esp<Directed> > DirectedEsp;
 typedef Stat<Undirected, Esp<Undirected> > UndirectedEsp;
+typedef Stat<Dense, Esp<Dense> > DenseEsp;
 
 /*!
  * Great circle distance between two long-lat points
@@ -2019,6 +2050,7 @@ typedef Stat<Undirected, Esp<Undirected> > UndirectedEsp;
 template<class Engine>
 class GeoDist : public BaseStat< Engine > {
 protected:
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     std::string latVarName;
     int latIndex;
     std::string longVarName;
@@ -2077,16 +2109,18 @@ public:
         }
         if(latIndex<0)
             ::Rf_error("latitude attribute not found in network");
+        const double* lat = net.continVariableColumn(latIndex);
         for(int i=0;i<net.size();i++){
-            double deg = net.continVariableValue(latIndex,i);
+            double deg = lat[i];
             if(deg<-90 || deg>90)
                 Rf_error("Latitude values out of range.");
         }
 
         if(longIndex<0)
             ::Rf_error("longitude attribute not found in network");
+        const double* lon = net.continVariableColumn(longIndex);
         for(int i=0;i<net.size();i++){
-            double deg = net.continVariableValue(longIndex,i);
+            double deg = lon[i];
             if(deg<-180 || deg>180)
                 Rf_error("Longitude values out of range.");
         }
@@ -2094,20 +2128,21 @@ public:
         int nstats = distCuts.size();
         this->init(nstats);
 
-        boost::shared_ptr< std::vector<std::pair<int,int> > > el = net.edgelist();
-        for(int i=0;i<el->size();i++){
-            int from = el->at(i).first;
-            int to = el->at(i).second;
-            double distance = dist(
-                    net.continVariableValue(latIndex,from),
-                    net.continVariableValue(longIndex,from),
-                    net.continVariableValue(latIndex,to),
-                    net.continVariableValue(longIndex,to)
-            );
-            for(int j=0;j<distCuts.size();j++){
-                this->stats[j] += std::min(distCuts[j], distance);
+        int nThreads = std::max(1, std::min(this->calculateThreads(), net.nEdges()));
+        std::vector< std::vector<double> > partial(nThreads, std::vector<double>(nstats, 0.0));
+        parallelEdges(net, nThreads, [&](int t, EdgeIterator it, EdgeIterator end){
+            for(;it != end;it++){
+                int from = it->first;
+                int to = it->second;
+                double distance = dist(lat[from], lon[from], lat[to], lon[to]);
+                for(int j=0;j<nstats;j++){
+                    partial[t][j] += std::min(distCuts[j], distance);
+                }
             }
-        }
+        });
+        for(int t=0;t<nThreads;t++)
+            for(int j=0;j<nstats;j++)
+                this->stats[j] += partial[t][j];
         //this->stats[0] = result / (double) net.nEdges();
     }
 
@@ -2115,12 +2150,9 @@ public:
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
         double change = 2.0 * (!net.hasEdge(from,to) - 0.5);
-        double distance = dist(
-                net.continVariableValue(latIndex,from),
-                net.continVariableValue(longIndex,from),
-                net.continVariableValue(latIndex,to),
-                net.continVariableValue(longIndex,to)
-        );
+        const double* lat = net.continVariableColumn(latIndex);
+        const double* lon = net.continVariableColumn(longIndex);
+        double distance = dist(lat[from], lon[from], lat[to], lon[to]);
         for(int j=0;j<distCuts.size();j++){
             this->stats[j] += change * std::min(distCuts[j], distance);
         }
@@ -2138,6 +2170,7 @@ public:
 
 typedef Stat<Directed, GeoDist<Directed> > DirectedGeoDist;
 typedef Stat<Undirected, GeoDist<Undirected> > UndirectedGeoDist;
+typedef Stat<Dense, GeoDist<Dense> > DenseGeoDist;
 
 
 /*!
@@ -2146,6 +2179,7 @@ typedef Stat<Undirected, GeoDist<Undirected> > UndirectedGeoDist;
 template<class Engine>
 class Dist : public BaseStat< Engine > {
 protected:
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     EdgeDirection direction;
     std::vector< std::string > varNames;
     std::vector<int> indices;
@@ -2174,8 +2208,8 @@ public:
     double dist(const BinaryNet<Engine>& net, int from, int to){
         double ssq = 0.0;
         for(int j=0;j<indices.size();j++){
-            ssq += pow(net.continVariableValue(indices[j],from) -
-                    net.continVariableValue(indices[j],to), 2.0);
+            const double* values = net.continVariableColumn(indices[j]);
+            ssq += pow(values[from] - values[to], 2.0);
         }
         return sqrt(ssq);
     }
@@ -2199,11 +2233,10 @@ public:
         this->init(nstats);
 
 
-        boost::shared_ptr< std::vector<std::pair<int,int> > > el = net.edgelist();
         double result = 0.0;
-        for(int i=0;i<el->size();i++){
-            int from = el->at(i).first;
-            int to = el->at(i).second;
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+            int from = it->first;
+            int to = it->second;
             result += dist(net, from,to);
         }
         this->stats[0] = result;
@@ -2229,6 +2262,7 @@ public:
 
 typedef Stat<Directed, Dist<Directed> > DirectedDist;
 typedef Stat<Undirected, Dist<Undirected> > UndirectedDist;
+typedef Stat<Dense, Dist<Dense> > DenseDist;
 
 
 
@@ -2238,6 +2272,7 @@ typedef Stat<Undirected, Dist<Undirected> > UndirectedDist;
 template<class Engine>
 class AbsDiff : public BaseStat< Engine > {
 protected:
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     std::vector< std::string > varNames;
     std::vector<int> indices;
     double power;
@@ -2269,8 +2304,8 @@ public:
     double dist(const BinaryNet<Engine>& net, int from, int to){
         double ssq = 0.0;
         for(int j=0;j<indices.size();j++){
-            ssq += pow(abs(net.continVariableValue(indices[j],from) -
-                    net.continVariableValue(indices[j],to)), power);
+            const double* values = net.continVariableColumn(indices[j]);
+            ssq += pow(abs(values[from] - values[to]), power);
         }
         return ssq;
     }
@@ -2294,11 +2329,10 @@ public:
         this->init(nstats);
 
 
-        boost::shared_ptr< std::vector<std::pair<int,int> > > el = net.edgelist();
         double result = 0.0;
-        for(int i=0;i<el->size();i++){
-            int from = el->at(i).first;
-            int to = el->at(i).second;
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+            int from = it->first;
+            int to = it->second;
             result += dist(net, from,to);
         }
         this->stats[0] = result;
@@ -2324,6 +2358,8 @@ public:
 
 typedef Stat<Directed, AbsDiff<Directed> > DirectedAbsDiff;
 typedef Stat<Undirected, AbsDiff<Undirected> > UndirectedAbsDiff;
+typedef Stat<Bipartite, AbsDiff<Bipartite> > BipartiteAbsDiff;
+typedef Stat<Dense, AbsDiff<Dense> > DenseAbsDiff;
 
 
 
@@ -2394,6 +2430,8 @@ public:
 
 typedef Stat<Directed, PreferentialAttachment<Directed> > DirectedPreferentialAttachment;
 typedef Stat<Undirected, PreferentialAttachment<Undirected> > UndirectedPreferentialAttachment;
+typedef Stat<Bipartite, PreferentialAttachment<Bipartite> > BipartitePreferentialAttachment;
+typedef Stat<Dense, PreferentialAttachment<Dense> > DensePreferentialAttachment;
 
 
 template<class Engine>
@@ -2442,8 +2480,9 @@ public:
     void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,
             const std::vector<int> &order,const int &actorIndex){
         BaseOffset<Engine>::resetLastStats();
-        double shared = sharedNbrs(net, from, to);
-        bool hasEdge = net.hasEdge(from,to);
+        DyadContext<Engine>& dyad = this->dyadContext(net, from, to);
+        double shared = dyad.sharedCount();
+        bool hasEdge = dyad.hasEdge();
         int deg = net.degree(order[actorIndex]) - hasEdge;
         int alter = order[actorIndex] == from ? to : from;
         double altDeg = net.degree(alter) - hasEdge;
@@ -2483,6 +2522,7 @@ public:
 
 typedef Stat<Directed, SharedNbrs<Directed> > DirectedSharedNbrs;
 typedef Stat<Undirected, SharedNbrs<Undirected> > UndirectedSharedNbrs;
+typedef Stat<Dense, SharedNbrs<Dense> > DenseSharedNbrs;
 
 
 
@@ -2492,6 +2532,7 @@ typedef Stat<Undirected, SharedNbrs<Undirected> > UndirectedSharedNbrs;
 template<class Engine>
 class NodeLogMaxCov : public BaseStat< Engine > {
 protected:
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
     EdgeDirection direction;
     std::string variableName;
     int varIndex;
@@ -2572,11 +2613,9 @@ public:
         varIndex = variableIndex;
         int nstats = 1;
         this->init(nstats);
-        boost::shared_ptr< std::vector<std::pair<int,int> > > el = net.edgelist();
-
-        for(int i=0;i<el->size();i++){
-            int from = el->at(i).first;
-            int to = el->at(i).second;
+        for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+            int from = it->first;
+            int to = it->second;
             double val1 = getValue(net,from);
             double val2 = getValue(net,to);
             double val = val1 > val2 ? val1 : val2;
@@ -2607,6 +2646,7 @@ public:
 
 typedef Stat<Directed, NodeLogMaxCov<Directed> > DirectedNodeLogMaxCov;
 typedef Stat<Undirected, NodeLogMaxCov<Undirected> > UndirectedNodeLogMaxCov;
+typedef Stat<Dense, NodeLogMaxCov<Dense> > DenseNodeLogMaxCov;
 
 
 
@@ -2696,9 +2736,10 @@ public:
         this->init(nstats);
         double n = net.size();
         double deg = 0.0;
+        const int* values = net.discreteVariableColumn(varIndex);
         for(int i=0;i<n;i++){
             deg = degree(net,i);
-            int val = net.discreteVariableValue(varIndex,i) - 1;
+            int val = values[i] - 1;
             if(val<nstats)
                 this->stats[val] += deg;
         }
@@ -2730,6 +2771,8 @@ public:
 
 typedef Stat<Directed, NodeFactor<Directed> > DirectedNodeFactor;
 typedef Stat<Undirected, NodeFactor<Undirected> > UndirectedNodeFactor;
+typedef Stat<Bipartite, NodeFactor<Bipartite> > BipartiteNodeFactor;
+typedef Stat<Dense, NodeFactor<Dense> > DenseNodeFactor;
 
 /**
 * An example lolog statistic, defined as the sum of dcov over the values that have edges
@@ -2806,7 +2849,9 @@ public:
 };
 
 typedef Stat<Undirected, EdgeCov<Undirected> > UndirectedEdgeCov;
+typedef Stat<Bipartite, EdgeCov<Bipartite> > BipartiteEdgeCov;
 typedef Stat<Directed, EdgeCov<Directed> > DirectedEdgeCov;
+typedef Stat<Dense, EdgeCov<Dense> > DenseEdgeCov;
 
 
 /*!
@@ -2814,6 +2859,9 @@ typedef Stat<Directed, EdgeCov<Directed> > DirectedEdgeCov;
  */
 template<class Engine>
 class TwoPath : public BaseStat< Engine > {
+protected:
+    typedef typename BinaryNet<Engine>::EdgeIterator EdgeIterator;
+
 public:
     TwoPath(){
         std::vector<double> v(1,0.0);
@@ -2840,20 +2888,23 @@ public:
         return statnames;
     }
     
+    bool hasSnapshot() const{
+        return true;
+    }
+
     void calculate(const BinaryNet<Engine>& net){
         this->init(1);
         double rec = 0.0;
         int from, to;
-        boost::shared_ptr< std::vector< std::pair<int,int> > > edges = net.edgelist();
         if(!net.isDirected()){
             for(int i=0; i<net.size();i++){
                 double nEd = net.degree(i);
                 rec += nchoosek(nEd, 2.0);
             }
         }else{
-            for(int i=0;i<edges->size();i++){
-                from = (*edges)[i].first;
-                to = (*edges)[i].second;
+            for(EdgeIterator it = net.edgesBegin(); it != net.edgesEnd(); it++){
+                from = it->first;
+                to = it->second;
                 rec+=(net.outdegree(to)-net.hasEdge(to,from));
             }
         }
@@ -2883,6 +2934,8 @@ public:
 
 typedef Stat<Directed, TwoPath<Directed> > DirectedTwoPath;
 typedef Stat<Undirected, TwoPath<Undirected> > UndirectedTwoPath;
+typedef Stat<Bipartite, TwoPath<Bipartite> > BipartiteTwoPath;
+typedef Stat<Dense, TwoPath<Dense> > DenseTwoPath;
 
 
 
@@ -2991,7 +3044,9 @@ public:
 };
 
 typedef Stat<Undirected, EdgeCovSparse<Undirected> > UndirectedEdgeCovSparse;
+typedef Stat<Bipartite, EdgeCovSparse<Bipartite> > BipartiteEdgeCovSparse;
 typedef Stat<Directed, EdgeCovSparse<Directed> > DirectedEdgeCovSparse;
+typedef Stat<Dense, EdgeCovSparse<Dense> > DenseEdgeCovSparse;
 
 
 
@@ -7,7 +7,8 @@
 namespace lolog {
 
 /*!
- *
+ * An undirected vertex. The network engines no longer use it, and it is kept
+ * for code written against earlier versions.
  */
 class UndirectedVertex: public Vertex {
 
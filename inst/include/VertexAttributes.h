@@ -0,0 +1,205 @@
+#ifndef VERTEXATTRIBUTESH_
+#define VERTEXATTRIBUTESH_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+namespace lolog{
+
+
+/*!
+ * The continuous and discrete vertex variables of a network, stored by column.
+ *
+ * Each variable is a contiguous array with one value per vertex, along with a
+ * matching array of observed flags. A term can fetch a column once and read
+ * the values of many vertices from it, rather than looking each one up through
+ * the network.
+ *
+ * Copies share their columns copy-on-write: a column is only duplicated
+ * when one of the copies changes it.
+ *
+ * Columns are invalidated by any change to the variables, or by adding or
+ * removing vertices.
+ */
+class VertexAttributes{
+protected:
+    typedef boost::shared_ptr< std::vector<double> > ContPtr;
+    typedef boost::shared_ptr< std::vector<int> > DisPtr;
+    typedef boost::shared_ptr< std::vector<char> > ObsPtr;
+
+    int n;
+    std::vector<ContPtr> contVals;
+    std::vector<ObsPtr> contObs;
+    std::vector<DisPtr> disVals;
+    std::vector<ObsPtr> disObs;
+
+    /*!
+     * a column, for writing. Copies it if it is shared.
+     */
+    template<class T>
+    static std::vector<T>& writable(boost::shared_ptr< std::vector<T> >& column){
+        if(!column.unique())
+            column = boost::shared_ptr< std::vector<T> >(new std::vector<T>(*column));
+        return *column;
+    }
+
+    template<class T>
+    static void permute(boost::shared_ptr< std::vector<T> >& column, const std::vector<int>& order){
+        boost::shared_ptr< std::vector<T> > tmp(new std::vector<T>(column->size()));
+        for(int i=0;i<order.size();i++)
+            (*tmp)[i] = (*column)[order[i]];
+        column = tmp;
+    }
+
+    template<class T>
+    static void erase(boost::shared_ptr< std::vector<T> >& column, int v){
+        std::vector<T>& c = writable(column);
+        c.erase(c.begin() + v);
+    }
+
+public:
+
+    VertexAttributes() : n(0){}
+
+    /*!
+     * n vertices without variables
+     */
+    VertexAttributes(int size) : n(size){}
+
+    /*!
+     * the number of vertices
+     */
+    int size() const{
+        return n;
+    }
+
+    int nContinVariables() const{
+        return contVals.size();
+    }
+
+    int nDiscreteVariables() const{
+        return disVals.size();
+    }
+
+    /*!
+     * the values of continuous variable which, indexed by vertex
+     */
+    inline const double* continColumn(int which) const{
+        return n == 0 ? NULL : &(*contVals[which])[0];
+    }
+
+    /*!
+     * the values of discrete variable which, indexed by vertex
+     */
+    inline const int* discreteColumn(int which) const{
+        return n == 0 ? NULL : &(*disVals[which])[0];
+    }
+
+    inline double continValue(int which, int at) const{
+        return (*contVals[which])[at];
+    }
+
+    inline void setContinValue(int which, int at, double value){
+        writable(contVals[which])[at] = value;
+    }
+
+    inline int discreteValue(int which, int at) const{
+        return (*disVals[which])[at];
+    }
+
+    inline void setDiscreteValue(int which, int at, int value){
+        writable(disVals[which])[at] = value;
+    }
+
+    inline bool continObserved(int which, int at) const{
+        return (*contObs[which])[at];
+    }
+
+    inline void setContinObserved(int which, int at, bool observed){
+        writable(contObs[which])[at] = observed;
+    }
+
+    inline bool discreteObserved(int which, int at) const{
+        return (*disObs[which])[at];
+    }
+
+    inline void setDiscreteObserved(int which, int at, bool observed){
+        writable(disObs[which])[at] = observed;
+    }
+
+    /*!
+     * adds a continuous variable, observed for every vertex
+     * \param vals one value per vertex
+     */
+    void addContinVariable(const std::vector<double>& vals){
+        contVals.push_back(ContPtr(new std::vector<double>(vals.begin(), vals.begin() + n)));
+        contObs.push_back(ObsPtr(new std::vector<char>(n, 1)));
+    }
+
+    /*!
+     * adds a discrete variable, observed for every vertex
+     * \param vals one value per vertex
+     */
+    void addDiscreteVariable(const std::vector<int>& vals){
+        disVals.push_back(DisPtr(new std::vector<int>(vals.begin(), vals.begin() + n)));
+        disObs.push_back(ObsPtr(new std::vector<char>(n, 1)));
+    }
+
+    void removeContinVariable(int which){
+        contVals.erase(contVals.begin() + which);
+        contObs.erase(contObs.begin() + which);
+    }
+
+    void removeDiscreteVariable(int which){
+        disVals.erase(disVals.begin() + which);
+        disObs.erase(disObs.begin() + which);
+    }
+
+    /*!
+     * adds a vertex, with every variable unobserved
+     */
+    void addVertex(){
+        n++;
+        for(int i=0;i<contVals.size();i++){
+            writable(contVals[i]).push_back(0.0);
+            writable(contObs[i]).push_back(0);
+        }
+        for(int i=0;i<disVals.size();i++){
+            writable(disVals[i]).push_back(0);
+            writable(disObs[i]).push_back(0);
+        }
+    }
+
+    /*!
+     * removes vertex v. Vertices above v move down by one.
+     */
+    void removeVertex(int v){
+        n--;
+        for(int i=0;i<contVals.size();i++){
+            erase(contVals[i], v);
+            erase(contObs[i], v);
+        }
+        for(int i=0;i<disVals.size();i++){
+            erase(disVals[i], v);
+            erase(disObs[i], v);
+        }
+    }
+
+    /*!
+     * renumbers the vertices so that new vertex i is old vertex order[i]
+     */
+    void relabel(const std::vector<int>& order){
+        for(int i=0;i<contVals.size();i++){
+            permute(contVals[i], order);
+            permute(contObs[i], order);
+        }
+        for(int i=0;i<disVals.size();i++){
+            permute(disVals[i], order);
+            permute(disObs[i], order);
+        }
+    }
+};
+
+}
+
+#endif /* VERTEXATTRIBUTESH_ */
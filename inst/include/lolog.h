@@ -8,12 +8,14 @@
 #include "DirectedVertex.h"
 #include "LatentOrderLikelihood.h"
 #include "Model.h"
+#include "NetworkFile.h"
 #include "Offset.h"
 #include "ParamParser.h"
 #include "Ranker.h"
 #include "ShallowCopyable.h"
 #include "Stat.h"
 #include "StatController.h"
+#include "StaticModel.h"
 #include "UndirectedVertex.h"
 #include "tests.h"
 #include "util.h"
@@ -6,6 +6,9 @@
 #include <cmath>
 #include <memory>
 #include<vector>
+#include <thread>
+#include <exception>
+#include <algorithm>
 #include <boost/shared_ptr.hpp>
 namespace lolog{
 
@@ -96,6 +99,62 @@ std::string asString(const T &item){
 
 
 
+/*!
+ * Splits [0, n) into (at most) nThreads contiguous ranges and calls
+ * fn(thread, begin, end) on each in its own thread. Runs on the calling thread
+ * when nThreads <= 1. fn must not call the R API. An exception thrown by fn is
+ * rethrown on the calling thread once all the threads have finished.
+ */
+template<class Fn>
+void parallelRanges(int n, int nThreads, Fn fn){
+    nThreads = std::max(1, std::min(nThreads, n));
+    if(nThreads == 1){
+        fn(0, 0, n);
+        return;
+    }
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(nThreads);
+    int chunk = n / nThreads;
+    int extra = n % nThreads;
+    int begin = 0;
+    for(int t=0;t<nThreads;t++){
+        int end = begin + chunk + (t < extra ? 1 : 0);
+        workers.push_back(std::thread([&fn, &errors, t, begin, end](){
+            try{
+                fn(t, begin, end);
+            }catch(...){
+                errors[t] = std::current_exception();
+            }
+        }));
+        begin = end;
+    }
+    for(int t=0;t<nThreads;t++)
+        workers[t].join();
+    for(int t=0;t<nThreads;t++)
+        if(errors[t])
+            std::rethrow_exception(errors[t]);
+}
+
+/*!
+ * The sum of fn(i) over [0, n), computed with per-thread partial sums.
+ * fn must not call the R API.
+ */
+template<class Fn>
+double parallelSum(int n, int nThreads, Fn fn){
+    std::vector<double> partial(std::max(1, std::min(nThreads, n)), 0.0);
+    parallelRanges(n, nThreads, [&](int t, int begin, int end){
+        double sum = 0.0;
+        for(int i=begin;i<end;i++)
+            sum += fn(i);
+        partial[t] = sum;
+    });
+    double result = 0.0;
+    for(int t=0;t<partial.size();t++)
+        result += partial[t];
+    return result;
+}
+
+
 /*!
  * An enumeriation of the types of edges
  */
@@ -17,8 +17,12 @@ RCPP_MODULE(lolog) {
     .constructor<Rcpp::IntegerMatrix,int>()
     .constructor<SEXP>()
     .method("clone",&DirectedNet::cloneR)
+    .method("saveFile",&DirectedNet::saveFileR)
+    .method("loadFile",&DirectedNet::loadFileR)
     .method("size",&DirectedNet::size)
     .method("isDirected",&DirectedNet::isDirected)
+    .method("isBipartite",&DirectedNet::isBipartite)
+    .method("firstModeSize",&DirectedNet::firstModeSize)
     .method("setDyads",&DirectedNet::setDyadsR)
     .method("getDyads",&DirectedNet::getDyadsR)
     .method("emptyGraph",&DirectedNet::emptyGraph)
@@ -48,8 +52,12 @@ RCPP_MODULE(lolog) {
     .constructor<Rcpp::IntegerMatrix,int>()
     .constructor<SEXP>()
     .method("clone",&UndirectedNet::cloneR)
+    .method("saveFile",&UndirectedNet::saveFileR)
+    .method("loadFile",&UndirectedNet::loadFileR)
     .method("size",&UndirectedNet::size)
     .method("isDirected",&UndirectedNet::isDirected)
+    .method("isBipartite",&UndirectedNet::isBipartite)
+    .method("firstModeSize",&UndirectedNet::firstModeSize)
     .method("setDyads",&UndirectedNet::setDyadsR)
     .method("getDyads",&UndirectedNet::getDyadsR)
     .method("emptyGraph",&UndirectedNet::emptyGraph)
@@ -73,6 +81,72 @@ RCPP_MODULE(lolog) {
     .method("setAllDyadsMissing",&UndirectedNet::setAllDyadsMissingR3)
     ;
 
+    class_<BipartiteNet >("BipartiteNet")
+    .constructor<Rcpp::IntegerMatrix,int,int>()
+    .constructor<SEXP>()
+    .method("clone",&BipartiteNet::cloneR)
+    .method("saveFile",&BipartiteNet::saveFileR)
+    .method("loadFile",&BipartiteNet::loadFileR)
+    .method("size",&BipartiteNet::size)
+    .method("isDirected",&BipartiteNet::isDirected)
+    .method("isBipartite",&BipartiteNet::isBipartite)
+    .method("firstModeSize",&BipartiteNet::firstModeSize)
+    .method("setDyads",&BipartiteNet::setDyadsR)
+    .method("getDyads",&BipartiteNet::getDyadsR)
+    .method("emptyGraph",&BipartiteNet::emptyGraph)
+    .method("edges",&BipartiteNet::edgelistR1)
+    .method("edges",&BipartiteNet::edgelistR2)
+    .method("[",&BipartiteNet::getDyadMatrixR)
+    .method("[<-",&BipartiteNet::setDyadMatrixR)
+    .method("variableNames",&BipartiteNet::getVariableNamesR1)
+    .method("variableNames",&BipartiteNet::getVariableNamesR2)
+    .method("[[",&BipartiteNet::getVariableR)
+    .method("getVariable",&BipartiteNet::getVariableR)
+    .method("getVariable",&BipartiteNet::getVariableR1)
+    .method("[[<-",&BipartiteNet::setVariableR)
+    .method("nMissing",&BipartiteNet::nMissingR)
+    .method("nEdges",&BipartiteNet::nEdgesR1)
+    .method("nEdges",&BipartiteNet::nEdgesR2)
+    .method("degree",&BipartiteNet::degreeR)
+    .method("neighbors",&BipartiteNet::neighborsR)
+    .method("setAllDyadsMissing",&BipartiteNet::setAllDyadsMissingR1)
+    .method("setAllDyadsMissing",&BipartiteNet::setAllDyadsMissingR2)
+    .method("setAllDyadsMissing",&BipartiteNet::setAllDyadsMissingR3)
+    ;
+
+    class_<DenseNet >("DenseNet")
+    .constructor<Rcpp::IntegerMatrix,int>()
+    .constructor<SEXP>()
+    .method("clone",&DenseNet::cloneR)
+    .method("saveFile",&DenseNet::saveFileR)
+    .method("loadFile",&DenseNet::loadFileR)
+    .method("size",&DenseNet::size)
+    .method("isDirected",&DenseNet::isDirected)
+    .method("isBipartite",&DenseNet::isBipartite)
+    .method("firstModeSize",&DenseNet::firstModeSize)
+    .method("setDyads",&DenseNet::setDyadsR)
+    .method("getDyads",&DenseNet::getDyadsR)
+    .method("emptyGraph",&DenseNet::emptyGraph)
+    .method("edges",&DenseNet::edgelistR1)
+    .method("edges",&DenseNet::edgelistR2)
+    .method("[",&DenseNet::getDyadMatrixR)
+    .method("[<-",&DenseNet::setDyadMatrixR)
+    .method("variableNames",&DenseNet::getVariableNamesR1)
+    .method("variableNames",&DenseNet::getVariableNamesR2)
+    .method("[[",&DenseNet::getVariableR)
+    .method("getVariable",&DenseNet::getVariableR)
+    .method("getVariable",&DenseNet::getVariableR1)
+    .method("[[<-",&DenseNet::setVariableR)
+    .method("nMissing",&DenseNet::nMissingR)
+    .method("nEdges",&DenseNet::nEdgesR1)
+    .method("nEdges",&DenseNet::nEdgesR2)
+    .method("degree",&DenseNet::degreeR)
+    .method("neighbors",&DenseNet::neighborsR)
+    .method("setAllDyadsMissing",&DenseNet::setAllDyadsMissingR1)
+    .method("setAllDyadsMissing",&DenseNet::setAllDyadsMissingR2)
+    .method("setAllDyadsMissing",&DenseNet::setAllDyadsMissingR3)
+    ;
+
     class_<Model<Undirected> >("UndirectedModel")
     .constructor()
     .constructor< Model<Undirected> >()
@@ -91,6 +165,13 @@ RCPP_MODULE(lolog) {
     .method("isIndependent",&Model<Undirected>::isIndependent)
     //added in 
     .method("dyadUpdate",&Model<Undirected>::dyadUpdate)
+    .method("setProfiling",&Model<Undirected>::setProfiling)
+    .method("profile",&Model<Undirected>::profileR)
+    .method("changeStatistics",&Model<Undirected>::changeStatisticsR)
+    .method("setThreads",&Model<Undirected>::setThreads)
+    .method("getThreads",&Model<Undirected>::getThreads)
+    .method("snapshot",&Model<Undirected>::snapshot)
+    .method("restoreSnapshot",&Model<Undirected>::restoreSnapshot)
     ;
     class_<Model<Directed> >("DirectedModel")
     .constructor()
@@ -110,12 +191,73 @@ RCPP_MODULE(lolog) {
     .method("isIndependent",&Model<Directed>::isIndependent)
     //added in
     .method("dyadUpdate",&Model<Directed>::dyadUpdate)
+    .method("setProfiling",&Model<Directed>::setProfiling)
+    .method("profile",&Model<Directed>::profileR)
+    .method("changeStatistics",&Model<Directed>::changeStatisticsR)
+    .method("setThreads",&Model<Directed>::setThreads)
+    .method("getThreads",&Model<Directed>::getThreads)
+    .method("snapshot",&Model<Directed>::snapshot)
+    .method("restoreSnapshot",&Model<Directed>::restoreSnapshot)
+    ;
+    class_<Model<Bipartite> >("BipartiteModel")
+    .constructor()
+    .constructor< Model<Bipartite> >()
+    .method("setNetwork",&Model<Bipartite>::setNetworkR)
+    .method("getNetwork",&Model<Bipartite>::getNetworkR)
+    .method("addStatistic",&Model<Bipartite>::addStatistic)
+    .method("addOffset",&Model<Bipartite>::addOffset)
+    .method("calculate",&Model<Bipartite>::calculate)
+    .method("statistics",&Model<Bipartite>::statisticsR)
+    .method("names",&Model<Bipartite>::names)
+    .method("offset",&Model<Bipartite>::offset)
+    .method("thetas",&Model<Bipartite>::thetasR)
+    .method("setThetas",&Model<Bipartite>::setThetas)
+    .method("setVertexOrder",&Model<Bipartite>::setVertexOrderVector)
+    .method("getVertexOrder",&Model<Bipartite>::getVertexOrderVector)
+    .method("isIndependent",&Model<Bipartite>::isIndependent)
+    //added in
+    .method("dyadUpdate",&Model<Bipartite>::dyadUpdate)
+    .method("setProfiling",&Model<Bipartite>::setProfiling)
+    .method("profile",&Model<Bipartite>::profileR)
+    .method("changeStatistics",&Model<Bipartite>::changeStatisticsR)
+    .method("setThreads",&Model<Bipartite>::setThreads)
+    .method("getThreads",&Model<Bipartite>::getThreads)
+    .method("snapshot",&Model<Bipartite>::snapshot)
+    .method("restoreSnapshot",&Model<Bipartite>::restoreSnapshot)
+    ;
+    class_<Model<Dense> >("DenseModel")
+    .constructor()
+    .constructor< Model<Dense> >()
+    .method("setNetwork",&Model<Dense>::setNetworkR)
+    .method("getNetwork",&Model<Dense>::getNetworkR)
+    .method("addStatistic",&Model<Dense>::addStatistic)
+    .method("addOffset",&Model<Dense>::addOffset)
+    .method("calculate",&Model<Dense>::calculate)
+    .method("statistics",&Model<Dense>::statisticsR)
+    .method("names",&Model<Dense>::names)
+    .method("offset",&Model<Dense>::offset)
+    .method("thetas",&Model<Dense>::thetasR)
+    .method("setThetas",&Model<Dense>::setThetas)
+    .method("setVertexOrder",&Model<Dense>::setVertexOrderVector)
+    .method("getVertexOrder",&Model<Dense>::getVertexOrderVector)
+    .method("isIndependent",&Model<Dense>::isIndependent)
+    //added in 
+    .method("dyadUpdate",&Model<Dense>::dyadUpdate)
+    .method("setProfiling",&Model<Dense>::setProfiling)
+    .method("profile",&Model<Dense>::profileR)
+    .method("changeStatistics",&Model<Dense>::changeStatisticsR)
+    .method("setThreads",&Model<Dense>::setThreads)
+    .method("getThreads",&Model<Dense>::getThreads)
+    .method("snapshot",&Model<Dense>::snapshot)
+    .method("restoreSnapshot",&Model<Dense>::restoreSnapshot)
     ;
 
     class_<LatentOrderLikelihood<Undirected> >("UndirectedLatentOrderLikelihood")
     .constructor< Model<Undirected> >()
     .method("setModel",&LatentOrderLikelihood<Undirected>::setModel)
     .method("getModel",&LatentOrderLikelihood<Undirected>::getModelR)
+    .method("setProfiling",&LatentOrderLikelihood<Undirected>::setProfiling)
+    .method("profile",&LatentOrderLikelihood<Undirected>::profile)
     .method("setThetas",&LatentOrderLikelihood<Undirected>::setThetas)
     .method("variationalModelFrame",&LatentOrderLikelihood<Undirected>::variationalModelFrame)
     .method("variationalModelFrameWithFunc",&LatentOrderLikelihood<Undirected>::variationalModelFrameWithFunc)
@@ -124,6 +266,15 @@ RCPP_MODULE(lolog) {
     .method("calcChangeStats",&LatentOrderLikelihood<Undirected>::calcChangeStats)
     .method("generateNetworkReturnChanges",&LatentOrderLikelihood<Undirected>::generateNetworkReturnChanges)
     .method("generateNetworkWithEdgeOrder",&LatentOrderLikelihood<Undirected>::generateNetworkWithEdgeOrder)
+    .method("generateConditionalNetwork",&LatentOrderLikelihood<Undirected>::generateConditionalNetwork)
+    .method("generateConditionalNetworkWithDyads",&LatentOrderLikelihood<Undirected>::generateConditionalNetworkWithDyads)
+    .method("generateNetworksWithThetas",&LatentOrderLikelihood<Undirected>::generateNetworksWithThetas)
+    .method("generateNetworkCheckpointed",&LatentOrderLikelihood<Undirected>::generateNetworkCheckpointed)
+    .method("resumeNetworkGeneration",&LatentOrderLikelihood<Undirected>::resumeNetworkGeneration)
+    .method("setDyadMaskBlocks",&LatentOrderLikelihood<Undirected>::setDyadMaskBlocks)
+    .method("setDyadMaskDyads",&LatentOrderLikelihood<Undirected>::setDyadMaskDyads)
+    .method("clearDyadMask",&LatentOrderLikelihood<Undirected>::clearDyadMask)
+    .method("nPermittedDyads",&LatentOrderLikelihood<Undirected>::nPermittedDyads)
     
     ;
 
@@ -131,6 +282,8 @@ RCPP_MODULE(lolog) {
     .constructor< Model<Directed> >()
     .method("setModel",&LatentOrderLikelihood<Directed>::setModel)
     .method("getModel",&LatentOrderLikelihood<Directed>::getModelR)
+    .method("setProfiling",&LatentOrderLikelihood<Directed>::setProfiling)
+    .method("profile",&LatentOrderLikelihood<Directed>::profile)
     .method("setThetas",&LatentOrderLikelihood<Directed>::setThetas)
     .method("variationalModelFrame",&LatentOrderLikelihood<Directed>::variationalModelFrame)
     .method("variationalModelFrameWithFunc",&LatentOrderLikelihood<Directed>::variationalModelFrameWithFunc)
@@ -139,6 +292,65 @@ RCPP_MODULE(lolog) {
     .method("calcChangeStats",&LatentOrderLikelihood<Directed>::calcChangeStats)
     .method("generateNetworkReturnChanges",&LatentOrderLikelihood<Directed>::generateNetworkReturnChanges)
     .method("generateNetworkWithEdgeOrder",&LatentOrderLikelihood<Directed>::generateNetworkWithEdgeOrder)
+    .method("generateConditionalNetwork",&LatentOrderLikelihood<Directed>::generateConditionalNetwork)
+    .method("generateConditionalNetworkWithDyads",&LatentOrderLikelihood<Directed>::generateConditionalNetworkWithDyads)
+    .method("generateNetworksWithThetas",&LatentOrderLikelihood<Directed>::generateNetworksWithThetas)
+    .method("generateNetworkCheckpointed",&LatentOrderLikelihood<Directed>::generateNetworkCheckpointed)
+    .method("resumeNetworkGeneration",&LatentOrderLikelihood<Directed>::resumeNetworkGeneration)
+    .method("setDyadMaskBlocks",&LatentOrderLikelihood<Directed>::setDyadMaskBlocks)
+    .method("setDyadMaskDyads",&LatentOrderLikelihood<Directed>::setDyadMaskDyads)
+    .method("clearDyadMask",&LatentOrderLikelihood<Directed>::clearDyadMask)
+    .method("nPermittedDyads",&LatentOrderLikelihood<Directed>::nPermittedDyads)
+    
+    ;
+
+    class_<LatentOrderLikelihood<Bipartite> >("BipartiteLatentOrderLikelihood")
+    .constructor< Model<Bipartite> >()
+    .method("setModel",&LatentOrderLikelihood<Bipartite>::setModel)
+    .method("getModel",&LatentOrderLikelihood<Bipartite>::getModelR)
+    .method("setProfiling",&LatentOrderLikelihood<Bipartite>::setProfiling)
+    .method("profile",&LatentOrderLikelihood<Bipartite>::profile)
+    .method("setThetas",&LatentOrderLikelihood<Bipartite>::setThetas)
+    .method("variationalModelFrame",&LatentOrderLikelihood<Bipartite>::variationalModelFrame)
+    .method("variationalModelFrameWithFunc",&LatentOrderLikelihood<Bipartite>::variationalModelFrameWithFunc)
+    .method("generateNetwork",&LatentOrderLikelihood<Bipartite>::generateNetwork)
+    //added in
+    .method("calcChangeStats",&LatentOrderLikelihood<Bipartite>::calcChangeStats)
+    .method("generateConditionalNetwork",&LatentOrderLikelihood<Bipartite>::generateConditionalNetwork)
+    .method("generateConditionalNetworkWithDyads",&LatentOrderLikelihood<Bipartite>::generateConditionalNetworkWithDyads)
+    .method("generateNetworksWithThetas",&LatentOrderLikelihood<Bipartite>::generateNetworksWithThetas)
+    .method("setDyadMaskBlocks",&LatentOrderLikelihood<Bipartite>::setDyadMaskBlocks)
+    .method("setDyadMaskDyads",&LatentOrderLikelihood<Bipartite>::setDyadMaskDyads)
+    .method("clearDyadMask",&LatentOrderLikelihood<Bipartite>::clearDyadMask)
+    .method("nPermittedDyads",&LatentOrderLikelihood<Bipartite>::nPermittedDyads)
+    .method("generateNetworkCheckpointed",&LatentOrderLikelihood<Bipartite>::generateNetworkCheckpointed)
+    .method("resumeNetworkGeneration",&LatentOrderLikelihood<Bipartite>::resumeNetworkGeneration)
+    
+    ;
+
+    class_<LatentOrderLikelihood<Dense> >("DenseLatentOrderLikelihood")
+    .constructor< Model<Dense> >()
+    .method("setModel",&LatentOrderLikelihood<Dense>::setModel)
+    .method("getModel",&LatentOrderLikelihood<Dense>::getModelR)
+    .method("setProfiling",&LatentOrderLikelihood<Dense>::setProfiling)
+    .method("profile",&LatentOrderLikelihood<Dense>::profile)
+    .method("setThetas",&LatentOrderLikelihood<Dense>::setThetas)
+    .method("variationalModelFrame",&LatentOrderLikelihood<Dense>::variationalModelFrame)
+    .method("variationalModelFrameWithFunc",&LatentOrderLikelihood<Dense>::variationalModelFrameWithFunc)
+    .method("generateNetwork",&LatentOrderLikelihood<Dense>::generateNetwork)
+    //added in
+    .method("calcChangeStats",&LatentOrderLikelihood<Dense>::calcChangeStats)
+    .method("generateNetworkReturnChanges",&LatentOrderLikelihood<Dense>::generateNetworkReturnChanges)
+    .method("generateNetworkWithEdgeOrder",&LatentOrderLikelihood<Dense>::generateNetworkWithEdgeOrder)
+    .method("generateConditionalNetwork",&LatentOrderLikelihood<Dense>::generateConditionalNetwork)
+    .method("generateConditionalNetworkWithDyads",&LatentOrderLikelihood<Dense>::generateConditionalNetworkWithDyads)
+    .method("generateNetworksWithThetas",&LatentOrderLikelihood<Dense>::generateNetworksWithThetas)
+    .method("generateNetworkCheckpointed",&LatentOrderLikelihood<Dense>::generateNetworkCheckpointed)
+    .method("resumeNetworkGeneration",&LatentOrderLikelihood<Dense>::resumeNetworkGeneration)
+    .method("setDyadMaskBlocks",&LatentOrderLikelihood<Dense>::setDyadMaskBlocks)
+    .method("setDyadMaskDyads",&LatentOrderLikelihood<Dense>::setDyadMaskDyads)
+    .method("clearDyadMask",&LatentOrderLikelihood<Dense>::clearDyadMask)
+    .method("nPermittedDyads",&LatentOrderLikelihood<Dense>::nPermittedDyads)
     
     ;
 
@@ -148,6 +360,10 @@ RCPP_MODULE(lolog) {
     function("registerUndirectedStatistic",&registerUndirectedStatistic);
     function("registerDirectedStatistic",&registerDirectedOffset);
     function("registerUndirectedStatistic",&registerUndirectedOffset);
+    function("registerBipartiteStatistic",&registerBipartiteStatistic);
+    function("registerBipartiteOffset",&registerBipartiteOffset);
+    function("registerDenseStatistic",&registerDenseStatistic);
+    function("registerDenseOffset",&registerDenseOffset);
 
     function("runLologCppTests",&tests::runLologTests);
 }
@@ -26,6 +26,24 @@ template<> UndirStatMapPtr StatController<Undirected>::statMapPtr =
 template<> UndirOffsetMapPtr StatController<Undirected>::offsetMapPtr =
         UndirOffsetMapPtr(new std::map< std::string, UndirOffsetPtr >);
 
+typedef boost::shared_ptr< AbstractStat<Bipartite> > BipartStatPtr;
+typedef boost::shared_ptr< std::map< std::string, BipartStatPtr > > BipartStatMapPtr;
+typedef boost::shared_ptr< AbstractOffset<Bipartite> > BipartOffsetPtr;
+typedef boost::shared_ptr< std::map< std::string, BipartOffsetPtr > > BipartOffsetMapPtr;
+template<> BipartStatMapPtr StatController<Bipartite>::statMapPtr =
+        BipartStatMapPtr(new std::map< std::string, BipartStatPtr >);
+template<> BipartOffsetMapPtr StatController<Bipartite>::offsetMapPtr =
+        BipartOffsetMapPtr(new std::map< std::string, BipartOffsetPtr >);
+
+typedef boost::shared_ptr< AbstractStat<Dense> > DenseStatPtr;
+typedef boost::shared_ptr< std::map< std::string, DenseStatPtr > > DenseStatMapPtr;
+typedef boost::shared_ptr< AbstractOffset<Dense> > DenseOffsetPtr;
+typedef boost::shared_ptr< std::map< std::string, DenseOffsetPtr > > DenseOffsetMapPtr;
+template<> DenseStatMapPtr StatController<Dense>::statMapPtr =
+        DenseStatMapPtr(new std::map< std::string, DenseStatPtr >);
+template<> DenseOffsetMapPtr StatController<Dense>::offsetMapPtr =
+        DenseOffsetMapPtr(new std::map< std::string, DenseOffsetPtr >);
+
 
 }
 
@@ -97,6 +115,68 @@ void initStats(){
     R_RegisterCCallable("lolog",
             "registerUndirectedOffset",(DL_FUNC) &registerUndirectedOffset);
 
+    /*
+     * Bipartite network statistics
+     */
+    registerStatistic( BipartStatPtr( new BipartiteEdges() ) );
+    registerStatistic( BipartStatPtr( new BipartiteStar() ) );
+    registerStatistic( BipartStatPtr( new BipartiteNodeMatch() ) );
+    registerStatistic( BipartStatPtr( new BipartiteNodeMix() ) );
+    registerStatistic( BipartStatPtr( new BipartiteDegree() ) );
+    registerStatistic( BipartStatPtr( new BipartiteDegreeCrossProd() ) );
+    registerStatistic( BipartStatPtr( new BipartiteNodeCov() ) );
+    registerStatistic( BipartStatPtr( new BipartiteGwDegree() ) );
+    registerStatistic( BipartStatPtr( new BipartiteGwdsp() ) );
+    registerStatistic( BipartStatPtr( new BipartiteAbsDiff() ) );
+    registerStatistic( BipartStatPtr( new BipartitePreferentialAttachment() ) );
+    registerStatistic( BipartStatPtr( new BipartiteNodeFactor() ) );
+    registerStatistic( BipartStatPtr( new BipartiteEdgeCov() ) );
+    registerStatistic( BipartStatPtr( new BipartiteTwoPath() ) );
+    registerStatistic( BipartStatPtr( new BipartiteEdgeCovSparse() ) );
+
+    ////////			Offsets				/////////
+    registerOffset( BipartOffsetPtr( new BipartiteBoundedDegreeConstraint() ) );
+    //Make registration available outside lolog compilation unit
+    R_RegisterCCallable("lolog",
+            "registerBipartiteStatistic",(DL_FUNC) &registerBipartiteStatistic);
+    R_RegisterCCallable("lolog",
+            "registerBipartiteOffset",(DL_FUNC) &registerBipartiteOffset);
+
+    /*
+     * Dense network statistics
+     */
+    registerStatistic( DenseStatPtr( new DenseEdges() ) );
+    registerStatistic( DenseStatPtr( new DenseTriangles() ) );
+    registerStatistic( DenseStatPtr( new DenseClustering() ) );
+    registerStatistic( DenseStatPtr( new DenseTransitivity() ) );
+    registerStatistic( DenseStatPtr( new DenseNodeLogMaxCov() ) );
+    registerStatistic( DenseStatPtr( new DenseNodeMix() ) );
+    registerStatistic( DenseStatPtr( new DenseDegree() ) );
+    registerStatistic( DenseStatPtr( new DenseNodeMatch() ) );
+    registerStatistic( DenseStatPtr( new DenseStar() ) );
+    registerStatistic( DenseStatPtr( new DenseNodeCov() ) );
+    registerStatistic( DenseStatPtr( new DenseEdgeCovSparse() ) );
+    registerStatistic( DenseStatPtr( new DenseGwesp() ) );
+    registerStatistic( DenseStatPtr( new DenseGeoDist() ) );
+    registerStatistic( DenseStatPtr( new DenseGwDegree() ) );
+    registerStatistic( DenseStatPtr( new DenseGwdsp() ) );
+    registerStatistic( DenseStatPtr( new DenseEsp() ) );
+    registerStatistic( DenseStatPtr( new DenseDegreeCrossProd() ) );
+    registerStatistic( DenseStatPtr( new DensePreferentialAttachment() ) );
+    registerStatistic( DenseStatPtr( new DenseSharedNbrs() ) );
+    registerStatistic( DenseStatPtr( new DenseNodeFactor() ) );
+    registerStatistic( DenseStatPtr( new DenseAbsDiff() ) );
+    registerStatistic( DenseStatPtr( new DenseEdgeCov() ) );
+    registerStatistic( DenseStatPtr( new DenseTwoPath() ) );
+
+    ////////			Offsets				/////////
+    registerOffset( DenseOffsetPtr( new DenseBoundedDegreeConstraint() ) );
+    //Make registration available outside lolog compilation unit
+    R_RegisterCCallable("lolog",
+            "registerDenseStatistic",(DL_FUNC) &registerDenseStatistic);
+    R_RegisterCCallable("lolog",
+            "registerDenseOffset",(DL_FUNC) &registerDenseOffset);
+
 }
 
 
@@ -110,6 +190,16 @@ void registerUndirectedStatistic(Rcpp::XPtr< lolog::AbstractStat<lolog::Undirect
             boost::shared_ptr< lolog::AbstractStat<lolog::Undirected> >(ps->vCloneUnsafe()));
 }
 
+void registerBipartiteStatistic(Rcpp::XPtr< lolog::AbstractStat<lolog::Bipartite> > ps){
+    lolog::StatController<lolog::Bipartite>::addStat(
+            boost::shared_ptr< lolog::AbstractStat<lolog::Bipartite> >(ps->vCloneUnsafe()));
+}
+
+void registerDenseStatistic(Rcpp::XPtr< lolog::AbstractStat<lolog::Dense> > ps){
+    lolog::StatController<lolog::Dense>::addStat(
+            boost::shared_ptr< lolog::AbstractStat<lolog::Dense> >(ps->vCloneUnsafe()));
+}
+
 void registerDirectedOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Directed> > ps){
     lolog::StatController<lolog::Directed>::addOffset(
             boost::shared_ptr< lolog::AbstractOffset<lolog::Directed> >(ps->vCloneUnsafe()));
@@ -120,6 +210,16 @@ void registerUndirectedOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Undirecte
             boost::shared_ptr< lolog::AbstractOffset<lolog::Undirected> >(ps->vCloneUnsafe()));
 }
 
+void registerBipartiteOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Bipartite> > ps){
+    lolog::StatController<lolog::Bipartite>::addOffset(
+            boost::shared_ptr< lolog::AbstractOffset<lolog::Bipartite> >(ps->vCloneUnsafe()));
+}
+
+void registerDenseOffset(Rcpp::XPtr< lolog::AbstractOffset<lolog::Dense> > ps){
+    lolog::StatController<lolog::Dense>::addOffset(
+            boost::shared_ptr< lolog::AbstractOffset<lolog::Dense> >(ps->vCloneUnsafe()));
+}
+
 
 
 
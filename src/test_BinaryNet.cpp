@@ -1,6 +1,11 @@
 #include <Rcpp.h>
 
 #include <BinaryNet.h>
+#include <CsrNetwork.h>
+#include <AdjacencyArena.h>
+#include <NetworkFile.h>
+#include <limits>
+#include <sstream>
 #include <tests.h>
 
 namespace lolog{
@@ -35,9 +40,565 @@ void netTest(){
 
 }
 
+void bipartiteNetTest(){
+    Rcpp::IntegerMatrix el(2,2);
+    el(0,0) = 1; el(0,1) = 5;
+    el(1,0) = 7; el(1,1) = 2;
+    BinaryNet<Bipartite> net(el,4,20);
+    EXPECT_TRUE(net.isBipartite());
+    EXPECT_TRUE(net.size() == 24);
+    EXPECT_TRUE(net.firstModeSize() == 4);
+    EXPECT_TRUE(net.maxEdges() == 80);
+    EXPECT_TRUE(net.nEdges() == 2);
+    EXPECT_TRUE(net.hasEdge(4,0) && net.hasEdge(1,6));
+
+    //ties within a mode are ignored
+    net.addEdge(0,1);
+    net.addEdge(10,11);
+    EXPECT_TRUE(net.nEdges() == 2);
+    net.toggle(0,10);
+    EXPECT_TRUE(net.hasEdge(10,0));
+    for(int i=0;i<50;i++){
+        std::pair<int,int> d = net.randomDyad();
+        EXPECT_TRUE((d.first < 4) != (d.second < 4));
+    }
+
+    //reordering within the modes keeps the mode sizes
+    std::vector<int> order(24);
+    for(int i=0;i<24;i++)
+        order[i] = i;
+    std::swap(order[0], order[3]);
+    std::swap(order[4], order[23]);
+    BinaryNet<Bipartite> re(net, true);
+    re.reorderVertices(order);
+    EXPECT_TRUE(re.firstModeSize() == 4 && re.nEdges() == 3);
+    EXPECT_TRUE(re.hasEdge(23,3) && re.hasEdge(1,6) && re.hasEdge(10,3));
+
+    //copies share the modes unless deep
+    boost::shared_ptr< BinaryNet<Bipartite> > cl = net.clone();
+    EXPECT_TRUE(cl->firstModeSize() == 4 && cl->nEdges() == 3);
+    EXPECT_TRUE(!BinaryNet<Undirected>().isBipartite());
+}
+
+template <class Engine>
+void csrNetworkTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,40);
+    for(int i=0;i<120;i++){
+        std::pair<int,int> d = net.randomDyad();
+        net.addEdge(d.first, d.second);
+    }
+    CsrNetwork csr(net);
+    EXPECT_TRUE(csr.size() == 40);
+    EXPECT_TRUE(csr.nEdges() == net.nEdges());
+    for(int i=0;i<40;i++){
+        for(int j=0;j<40;j++)
+            EXPECT_TRUE(csr.hasEdge(i,j) == net.hasEdge(i,j));
+        if(net.isDirected()){
+            EXPECT_TRUE(csr.outdegree(i) == net.outdegree(i));
+            EXPECT_TRUE(csr.indegree(i) == net.indegree(i));
+        }else
+            EXPECT_TRUE(csr.degree(i) == net.degree(i));
+    }
+
+    //the snapshot does not follow the network
+    std::pair<int,int> d = net.randomDyad();
+    bool had = net.hasEdge(d.first, d.second);
+    net.toggle(d.first, d.second);
+    EXPECT_TRUE(csr.hasEdge(d.first, d.second) == had);
+}
+
+void denseNetTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Undirected> sparse(tmp,70);
+    BinaryNet<Dense> dense(tmp,70);
+    for(int i=0;i<600;i++){
+        std::pair<int,int> d = sparse.randomDyad();
+        sparse.toggle(d.first, d.second);
+        dense.toggle(d.first, d.second);
+    }
+    EXPECT_TRUE(dense.nEdges() == sparse.nEdges());
+    EXPECT_TRUE(*dense.edgelist() == *sparse.edgelist());
+    for(int i=0;i<70;i++){
+        EXPECT_TRUE(dense.degree(i) == sparse.degree(i));
+        std::vector<int> dn(dense.begin(i), dense.end(i));
+        std::vector<int> sn(sparse.begin(i), sparse.end(i));
+        EXPECT_TRUE(dn == sn);
+        if(dn.size() > 0){
+            BinaryNet<Dense>::NeighborIterator last = dense.end(i);
+            last--;
+            EXPECT_TRUE(*last == dn.back());
+        }
+        for(int j=0;j<70;j++){
+            EXPECT_TRUE(dense.hasEdge(i,j) == sparse.hasEdge(i,j));
+            EXPECT_TRUE(dense.sharedNeighbors(i,j) == sparse.sharedNeighbors(i,j));
+        }
+    }
+    std::vector<int> shared, expected;
+    dense.sharedNeighbors(3, 64, shared);
+    sparse.sharedNeighbors(3, 64, expected);
+    EXPECT_TRUE(shared == expected);
+    for(int i=0;i<20;i++){
+        std::pair<int,int> e = dense.randomEdge();
+        EXPECT_TRUE(dense.hasEdge(e.first, e.second));
+    }
+
+    //deep copies share rows until either side writes to them
+    boost::shared_ptr< BinaryNet<Dense> > cl = dense.clone();
+    bool had = dense.hasEdge(3, 64);
+    cl->toggle(3, 64);
+    EXPECT_TRUE(dense.hasEdge(3, 64) == had && cl->hasEdge(64, 3) != had);
+    dense.toggle(7, 8);
+    EXPECT_TRUE(cl->hasEdge(7, 8) == sparse.hasEdge(7, 8));
+    dense.toggle(7, 8);
+    cl->emptyGraph();
+    EXPECT_TRUE(cl->nEdges() == 0 && dense.nEdges() == sparse.nEdges());
+    EXPECT_TRUE(!dense.hasEdge(5,5));
+}
+
+void adjacencyArenaTest(){
+    //interleaved growth relocates slots and eventually compacts the arena
+    AdjacencyArena arena(3);
+    std::vector< std::set<int> > expected(3);
+    for(int i=0;i<3000;i++){
+        int v = i % 3;
+        int x = floor(Rf_runif(0, 2000));
+        EXPECT_TRUE(arena.insert(v, x) == expected[v].insert(x).second);
+        if(i % 5 == 0){
+            int y = floor(Rf_runif(0, 2000));
+            EXPECT_TRUE(arena.erase(v, y) == (expected[v].erase(y) == 1));
+        }
+    }
+    EXPECT_TRUE(arena.unused() < arena.allocated());
+    for(int v=0;v<3;v++){
+        EXPECT_TRUE(arena.degree(v) == expected[v].size());
+        EXPECT_TRUE(std::equal(arena.begin(v), arena.end(v), expected[v].begin()));
+    }
+    arena.compact();
+    EXPECT_TRUE(arena.unused() == 0);
+    EXPECT_TRUE(std::equal(arena.begin(2), arena.end(2), expected[2].begin()));
+
+    //removing a vertex shifts the ids above it
+    Rcpp::IntegerMatrix el(3,2);
+    el(0,0) = 1; el(0,1) = 2;
+    el(1,0) = 2; el(1,1) = 4;
+    el(2,0) = 4; el(2,1) = 1;
+    BinaryNet<Directed> net(el,5);
+    boost::shared_ptr< BinaryNet<Directed> > cl = net.clone();
+    net.removeVertex(1);
+    EXPECT_TRUE(net.size() == 4 && net.nEdges() == 1);
+    EXPECT_TRUE(net.hasEdge(2,0) && net.indegree(0) == 1);
+    EXPECT_TRUE(cl->size() == 5 && cl->nEdges() == 3 && cl->hasEdge(1,3));
+
+    //reordering follows the vertices
+    std::vector<int> order(5);
+    for(int i=0;i<5;i++)
+        order[i] = 4 - i;
+    cl->reorderVertices(order);
+    EXPECT_TRUE(cl->hasEdge(4,3) && cl->hasEdge(3,1) && cl->hasEdge(1,4));
+    EXPECT_TRUE(cl->nEdges() == 3 && cl->outdegree(0) == 0);
+}
+
+void hubAdjacencyTest(){
+    AdjacencyArena arena(4);
+    arena.setHubDegree(32);
+    std::vector< std::set<int> > expected(4);
+    for(int i=0;i<4000;i++){
+        //vertex 0 becomes a hub, and moves in and out of the arena
+        int v = i % 7 == 0 ? 1 + (i % 3) : 0;
+        int x = floor(Rf_runif(0, i < 2000 ? 300 : 60));
+        if(Rf_runif(0, 1) < (i < 2000 ? 0.7 : 0.3)){
+            EXPECT_TRUE(arena.insert(v, x) == expected[v].insert(x).second);
+        }else{
+            EXPECT_TRUE(arena.erase(v, x) == (expected[v].erase(x) == 1));
+        }
+        EXPECT_TRUE(arena.contains(v, x) == (expected[v].count(x) == 1));
+        EXPECT_TRUE(arena.degree(v) == expected[v].size());
+        if(i % 97 == 0){
+            EXPECT_TRUE(std::equal(arena.begin(v), arena.end(v), expected[v].begin()));
+        }
+        if(i == 1999){
+            EXPECT_TRUE(arena.nHubs() > 0);
+        }
+    }
+    for(int v=0;v<4;v++)
+        EXPECT_TRUE(std::equal(arena.begin(v), arena.end(v), expected[v].begin()));
+
+    //reading one hub does not move the neighbours of another
+    for(int i=0;i<40;i++){
+        arena.insert(2, 100 + i);
+        arena.insert(3, 200 + i);
+    }
+    arena.insert(2, 99);
+    arena.insert(3, 199);
+    expected[2].clear();
+    expected[2].insert(arena.begin(2), arena.end(2));
+    const int* b2 = arena.begin(2);
+    const int* e2 = arena.end(2);
+    arena.begin(3);
+    EXPECT_TRUE(arena.nHubs() >= 2);
+    EXPECT_TRUE(std::equal(b2, e2, expected[2].begin()));
+
+    //hubs follow vertex removal, with the ids above it shifted down
+    arena.removeVertex(1);
+    EXPECT_TRUE(arena.size() == 3 && arena.contains(1, 98) && arena.contains(2, 198));
+    arena.clearAll();
+    EXPECT_TRUE(arena.nHubs() == 0 && arena.degree(2) == 0);
+}
+
+template <class Engine>
+void randomEdgeTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,8);
+    for(int i=0;i<12;i++){
+        std::pair<int,int> d = net.randomDyad();
+        net.addEdge(d.first, d.second);
+    }
+    //every edge and non-edge is drawn
+    std::set< std::pair<int,int> > edges, nonEdges;
+    for(int i=0;i<3000;i++){
+        std::pair<int,int> e = net.randomEdge();
+        EXPECT_TRUE(net.hasEdge(e.first, e.second));
+        std::pair<int,int> d = net.randomNonEdge();
+        EXPECT_TRUE(d.first != d.second && !net.hasEdge(d.first, d.second));
+        if(!net.isDirected()){
+            if(e.first > e.second)
+                std::swap(e.first, e.second);
+            if(d.first > d.second)
+                std::swap(d.first, d.second);
+        }
+        edges.insert(e);
+        nonEdges.insert(d);
+    }
+    EXPECT_TRUE(edges.size() == net.nEdges());
+    EXPECT_TRUE(nonEdges.size() == net.maxEdges() - net.nEdges());
+
+    //the index follows toggles
+    net.emptyGraph();
+    net.addEdge(3,5);
+    for(int i=0;i<20;i++){
+        std::pair<int,int> e = net.randomEdge();
+        EXPECT_TRUE(e.first == 3 || e.first == 5);
+    }
+}
+
+void bipartiteRandomEdgeTest(){
+    Rcpp::IntegerMatrix el(1,2);
+    el(0,0) = 1; el(0,1) = 4;
+    BinaryNet<Bipartite> net(el,2,3);
+    std::set< std::pair<int,int> > nonEdges;
+    for(int i=0;i<500;i++){
+        std::pair<int,int> d = net.randomNonEdge();
+        EXPECT_TRUE(d.first < 2 && d.second >= 2 && !net.hasEdge(d.first, d.second));
+        nonEdges.insert(d);
+    }
+    EXPECT_TRUE(nonEdges.size() == 5);
+}
+
+template <class Engine>
+void edgeIteratorTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,50);
+    for(int i=0;i<200;i++){
+        std::pair<int,int> d = net.randomDyad();
+        net.addEdge(d.first, d.second);
+    }
+    std::vector< std::pair<int,int> > el = *net.edgelist();
+    std::vector< std::pair<int,int> > visited(net.edgesBegin(), net.edgesEnd());
+    EXPECT_TRUE(visited == el);
+
+    //the parts of a partition follow one another in edge order
+    std::vector<int> cuts = net.edgePartition(4);
+    EXPECT_TRUE(cuts.size() == 5 && cuts[0] == 0 && cuts[4] == 50);
+    std::vector< std::pair<int,int> > joined;
+    for(int p=0;p<4;p++)
+        joined.insert(joined.end(), net.edgesBegin(cuts[p], cuts[p + 1]), net.edgesEnd(cuts[p + 1]));
+    EXPECT_TRUE(joined == el);
+
+    double sum = parallelEdgeSum(net, 3, [&](int from, int to){
+        return (double) from * to;
+    });
+    double expected = 0.0;
+    for(int i=0;i<el.size();i++)
+        expected += (double) el[i].first * el[i].second;
+    EXPECT_NEAR(sum, expected);
+
+    BinaryNet<Engine> empty(tmp,10);
+    EXPECT_TRUE(empty.edgesBegin() == empty.edgesEnd());
+    EXPECT_TRUE(!(net.edgesBegin() == net.edgesEnd()));
+}
+
+template <class Engine>
+void missingnessTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,200);
+    bool directed = net.isDirected();
+    std::set< std::pair<int,int> > expected;
+    //rows pass through the sparse, bitmap and all missing forms
+    for(int i=0;i<6000;i++){
+        int from = floor(Rf_runif(0, i < 3000 ? 4 : 200));
+        int to = floor(Rf_runif(0, 200));
+        bool value = Rf_runif(0, 1) < (i < 3000 ? 0.8 : 0.3);
+        bool was = expected.count(std::make_pair(from, to)) == 1;
+        EXPECT_TRUE(net.setMissing(from, to, value) == was);
+        if(from != to){
+            if(value){
+                expected.insert(std::make_pair(from, to));
+                if(!directed)
+                    expected.insert(std::make_pair(to, from));
+            }else{
+                expected.erase(std::make_pair(from, to));
+                if(!directed)
+                    expected.erase(std::make_pair(to, from));
+            }
+        }
+        EXPECT_TRUE(net.isMissing(from, to) == (expected.count(std::make_pair(from, to)) == 1));
+    }
+    for(int i=0;i<200;i++){
+        int n = 0;
+        for(int j=0;j<200;j++)
+            n += net.isMissing(i, j);
+        EXPECT_TRUE(net.nMissing(i) == n);
+    }
+    boost::shared_ptr< std::vector< std::pair<int,int> > > dyads = net.missingDyads();
+    EXPECT_TRUE(dyads->size() == (directed ? expected.size() : expected.size() / 2));
+    for(int i=0;i<dyads->size();i++)
+        EXPECT_TRUE(expected.count(dyads->at(i)) == 1);
+    for(int i=0;i<100;i++){
+        EXPECT_TRUE(net.isMissing(1, net.randomDyad(1, true)));
+    }
+
+    //bulk changes, and following the ids when a vertex is removed
+    std::vector<int> nodes;
+    nodes.push_back(3);
+    nodes.push_back(7);
+    net.setAllDyadsMissing(nodes, true);
+    EXPECT_TRUE(net.nMissing(7) == 199 && !net.isMissing(7, 7));
+    EXPECT_TRUE(net.isMissing(150, 7) == !directed);
+    net.setMissing(7, 150, false);
+    EXPECT_TRUE(net.nMissing(7) == 198);
+    net.removeVertex(5);
+    EXPECT_TRUE(net.nMissing(6) == 197 && !net.isMissing(6, 149) && net.isMissing(6, 148));
+    net.setAllDyadsObserved();
+    EXPECT_TRUE(net.missingDyads()->size() == 0);
+    net.setAllDyadsMissing();
+    net.addVertex();
+    EXPECT_TRUE(net.isMissing(0, 199) && net.isMissing(199, 0) == !directed);
+}
+
+template <class Engine>
+void vertexAttributeTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,5);
+    ContinAttrib cattr;
+    cattr.setName("cont");
+    std::vector<double> cvals;
+    for(int i=0;i<5;i++)
+        cvals.push_back(i + 0.5);
+    net.addContinVariable(cvals,cattr);
+    DiscreteAttrib dattr;
+    dattr.setName("fact");
+    std::vector<int> dvals;
+    for(int i=0;i<5;i++)
+        dvals.push_back(10 + i);
+    net.addDiscreteVariable(dvals,dattr);
+
+    //columns hold the values by vertex id
+    const double* cont = net.continVariableColumn(0);
+    const int* fact = net.discreteVariableColumn(0);
+    for(int i=0;i<5;i++){
+        EXPECT_NEAR(cont[i], net.continVariableValue(0,i));
+        EXPECT_TRUE(fact[i] == net.discreteVariableValue(0,i));
+    }
+
+    //shallow copies share the columns, deep copies do not
+    BinaryNet<Engine> shallow(net);
+    BinaryNet<Engine> deep(net, true);
+    net.setDiscreteVariableValue(0,1,42);
+    net.setContinVariableObserved(0,2,false);
+    EXPECT_TRUE(shallow.discreteVariableValue(0,1) == 42);
+    EXPECT_TRUE(deep.discreteVariableValue(0,1) == 11);
+    EXPECT_TRUE(!shallow.continVariableObserved(0,2) && deep.continVariableObserved(0,2));
+
+    //the values follow the vertices when they move
+    net.removeVertex(0);
+    EXPECT_TRUE(net.discreteVariableColumn(0)[0] == 42);
+    EXPECT_NEAR(net.continVariableColumn(0)[3], 4.5);
+    std::vector<int> order;
+    for(int i=3;i>=0;i--)
+        order.push_back(i);
+    net.reorderVertices(order);
+    EXPECT_TRUE(net.discreteVariableValues(0)[3] == 42 && !net.continVariableObserved(0,2));
+    net.addVertex();
+    EXPECT_TRUE(!net.discreteVariableObserved(0,4));
+}
+
+template <class Engine>
+void copyOnWriteTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,300);
+    for(int i=0;i<1500;i++){
+        std::pair<int,int> d = net.randomDyad();
+        net.addEdge(d.first, d.second);
+    }
+    for(int i=1;i<40;i++)
+        net.addEdge(0, i);
+    net.setMissing(3, 4, true);
+    ContinAttrib attr;
+    attr.setName("cont");
+    net.addContinVariable(std::vector<double>(300, 1.0), attr);
+    boost::shared_ptr< std::vector< std::pair<int,int> > > before = net.edgelist();
+
+    //changes to a clone are not seen by the original
+    boost::shared_ptr< BinaryNet<Engine> > cl = net.clone();
+    for(int i=0;i<200;i++){
+        std::pair<int,int> d = cl->randomDyad();
+        cl->toggle(d.first, d.second);
+    }
+    cl->removeEdge(0, 1);
+    cl->setMissing(3, 4, false);
+    cl->setContinVariableValue(0, 5, 2.0);
+    EXPECT_TRUE(*net.edgelist() == *before);
+    EXPECT_TRUE(net.hasEdge(0, 1) && !cl->hasEdge(0, 1));
+    EXPECT_TRUE(net.isMissing(3, 4) && !cl->isMissing(3, 4));
+    EXPECT_NEAR(net.continVariableValue(0, 5), 1.0);
+
+    //and changes to the original are not seen by the clone
+    boost::shared_ptr< std::vector< std::pair<int,int> > > cloned = cl->edgelist();
+    net.emptyGraph();
+    net.setAllDyadsObserved();
+    EXPECT_TRUE(*cl->edgelist() == *cloned);
+    EXPECT_TRUE(cl->nEdges() == cloned->size() && !cl->isMissing(3, 4));
+
+    //nor are changes to a shared hub
+    AdjacencyArena arena(50);
+    arena.setHubDegree(16);
+    for(int i=1;i<40;i++)
+        arena.insert(0, i);
+    arena.erase(0, 7);
+    AdjacencyArena copy(arena);
+    copy.erase(0, 1);
+    copy.insert(0, 7);
+    EXPECT_TRUE(arena.nHubs() == 1 && copy.nHubs() == 1);
+    EXPECT_TRUE(arena.contains(0, 1) && !arena.contains(0, 7) && arena.degree(0) == 38);
+    EXPECT_TRUE(!copy.contains(0, 1) && copy.contains(0, 7) && copy.degree(0) == 38);
+    EXPECT_TRUE(std::count(arena.begin(0), arena.end(0), 7) == 0);
+}
+
+//reads a network from an 8 byte aligned copy of the written bytes
+template <class Engine>
+boost::shared_ptr< BinaryNet<Engine> > readNetworkBytes(const std::string& bytes){
+    std::vector<int64_t> buffer(bytes.size() / 8 + 1);
+    std::memcpy(&buffer[0], bytes.data(), bytes.size());
+    SnapshotReader in(reinterpret_cast<const char*>(&buffer[0]), bytes.size(), "Network file");
+    return readNetwork<Engine>(in);
+}
+
+template <class Engine>
+bool networkBytesRejected(const std::string& bytes){
+    try{
+        readNetworkBytes<Engine>(bytes);
+    }catch(std::exception& e){
+        return true;
+    }
+    return false;
+}
+
+template <class Engine>
+void networkFileTest(){
+    Rcpp::IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,200);
+    for(int i=0;i<800;i++){
+        std::pair<int,int> d = net.randomDyad();
+        net.addEdge(d.first, d.second);
+    }
+    for(int i=1;i<150;i++)
+        net.addEdge(0, i);
+    net.setMissing(3, 4, true);
+    net.setMissing(9, 2, true);
+    std::vector<int> nodes(1, 7);
+    net.setAllDyadsMissing(nodes, true);
+    DiscreteAttrib dattr;
+    dattr.setName("fact");
+    std::vector<std::string> labels;
+    labels.push_back("a");
+    labels.push_back("b");
+    dattr.setLabels(labels);
+    dattr.setLowerBound(1);
+    std::vector<int> dvals(200, 1);
+    dvals[5] = 2;
+    net.addDiscreteVariable(dvals, dattr);
+    ContinAttrib cattr;
+    cattr.setName("cont");
+    cattr.setUpperBound(10.0);
+    std::vector<double> cvals;
+    for(int i=0;i<200;i++)
+        cvals.push_back(i / 3.0);
+    net.addContinVariable(cvals, cattr);
+    net.setContinVariableObserved(0, 8, false);
+
+    std::stringstream ss;
+    writeNetwork(ss, net);
+    std::string bytes = ss.str();
+    boost::shared_ptr< BinaryNet<Engine> > net2 = readNetworkBytes<Engine>(bytes);
+
+    EXPECT_TRUE(net2->size() == 200 && net2->nEdges() == net.nEdges());
+    EXPECT_TRUE(*net2->edgelist() == *net.edgelist());
+    EXPECT_TRUE(*net2->missingDyads() == *net.missingDyads());
+    EXPECT_TRUE(net2->nMissing(7) == 199 && net2->isMissing(3, 4));
+    EXPECT_TRUE(net2->discreteVariableValues(0) == dvals);
+    EXPECT_TRUE(net2->discreteVariableAttributes(0).labels() == labels);
+    EXPECT_TRUE(net2->discreteVariableAttributes(0).hasLowerBound());
+    EXPECT_TRUE(net2->continVariableAttributes(0).getName() == "cont");
+    EXPECT_NEAR(net2->continVariableAttributes(0).upperBound(), 10.0);
+    EXPECT_NEAR(net2->continVariableValue(0, 100), 100 / 3.0);
+    EXPECT_TRUE(!net2->continVariableObserved(0, 8) && net2->continVariableObserved(0, 9));
+
+    //the loaded network can be changed like any other
+    net2->removeEdge(0, 1);
+    net2->addEdge(0, 1);
+    net2->addEdge(198, 199);
+    EXPECT_TRUE(net2->hasEdge(0, 1) && net2->hasEdge(198, 199));
+    EXPECT_TRUE(net.hasEdge(198, 199) == (net2->nEdges() == net.nEdges()));
+
+    //trailing bytes and vertex counts larger than the file are rejected
+    EXPECT_TRUE(networkBytesRejected<Engine>(bytes + std::string(8, '\0')));
+    std::string huge = bytes;
+    size_t at = (20 + Engine::engineName().size() + 7) / 8 * 8 + sizeof(int);
+    int n;
+    std::memcpy(&n, bytes.data() + at, sizeof(int));
+    EXPECT_TRUE(n == 200);
+    n = std::numeric_limits<int>::max();
+    huge.replace(at, sizeof(int), reinterpret_cast<const char*>(&n), sizeof(int));
+    EXPECT_TRUE(networkBytesRejected<Engine>(huge));
+}
+
 void testBinaryNet(){
     RUN_TEST(netTest<Directed>());
     RUN_TEST(netTest<Undirected>())
+    RUN_TEST(bipartiteNetTest());
+    RUN_TEST(csrNetworkTest<Directed>());
+    RUN_TEST(csrNetworkTest<Undirected>());
+    RUN_TEST(denseNetTest());
+    RUN_TEST(csrNetworkTest<Dense>());
+    RUN_TEST(adjacencyArenaTest());
+    RUN_TEST(hubAdjacencyTest());
+    RUN_TEST(randomEdgeTest<Directed>());
+    RUN_TEST(randomEdgeTest<Undirected>());
+    RUN_TEST(randomEdgeTest<Dense>());
+    RUN_TEST(bipartiteRandomEdgeTest());
+    RUN_TEST(edgeIteratorTest<Directed>());
+    RUN_TEST(edgeIteratorTest<Undirected>());
+    RUN_TEST(edgeIteratorTest<Dense>());
+    RUN_TEST(missingnessTest<Directed>());
+    RUN_TEST(missingnessTest<Undirected>());
+    RUN_TEST(vertexAttributeTest<Directed>());
+    RUN_TEST(vertexAttributeTest<Undirected>());
+    RUN_TEST(copyOnWriteTest<Directed>());
+    RUN_TEST(copyOnWriteTest<Undirected>());
+    RUN_TEST(networkFileTest<Directed>());
+    RUN_TEST(networkFileTest<Undirected>());
+    RUN_TEST(networkFileTest<Dense>());
 
 }
 
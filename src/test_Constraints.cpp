@@ -9,6 +9,7 @@
 #include <Constraint.h>
 #include <Constraints.h>
 #include <Model.h>
+#include <LatentOrderLikelihood.h>
 #include <VarAttrib.h>
 #include <tests.h>
 namespace lolog {
@@ -38,9 +39,52 @@ void testBoundedDegree(){
     PutRNGstate();
 }
 
+/*!
+ * ties to saturated vertices are blocked, and skipped by generation
+ */
+template<class Engine>
+void testBoundedDegreePruning(){
+    IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,30);
+    Rcpp::List ll;
+    ll.push_back(0);
+    ll.push_back(3);
+    boost::shared_ptr< AbstractOffset<Engine> > off(
+            new Constraint<Engine,BoundedDegree<Engine> >(ll));
+    Model<Engine> model(net);
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Edges<Engine> >()));
+    model.addOffsetPtr(off);
+    model.setThetas(std::vector<double>(1,5.0));
+    model.calculate();
+
+    model.network()->addEdge(0,1);
+    model.network()->addEdge(0,2);
+    model.network()->addEdge(0,3);
+    EXPECT_TRUE(model.isDyadBlocked(0,4));
+    EXPECT_TRUE(model.isDyadBlocked(4,0));
+    EXPECT_TRUE(!model.isDyadBlocked(1,4));
+    EXPECT_TRUE(!model.isDyadBlocked(0,1));
+    model.network()->emptyGraph();
+    model.calculate();
+
+    std::vector<int> order(30);
+    for(int i=0;i<30;i++)
+        order[i] = i;
+    std::vector<double> stats(1, 0.0), eStats(1, 0.0);
+    model.setProfiling(true);
+    GetRNGstate();
+    LatentOrderLikelihood<Engine>::growNetwork(model, order, stats, eStats, NULL);
+    PutRNGstate();
+    for(int i=0;i<30;i++)
+        EXPECT_TRUE(model.network()->degree(i) <= 3);
+    EXPECT_NEAR(stats[0], model.network()->nEdges());
+    EXPECT_TRUE(model.getProfiler()->terms[0].dyadUpdates < (long) model.network()->maxEdges());
+}
+
 
 void testConstraints(){
     RUN_TEST(testBoundedDegree<Undirected>());
+    RUN_TEST(testBoundedDegreePruning<Undirected>());
 }
 
 }
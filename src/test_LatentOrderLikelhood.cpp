@@ -7,6 +7,7 @@
 #include <Model.h>
 #include <VarAttrib.h>
 #include <LatentOrderLikelihood.h>
+#include <StaticModel.h>
 #include <Ranker.h>
 #include <test_LatentOrderLikelihood.h>
 #include <tests.h>
@@ -106,6 +107,63 @@ void lt() {
     model.calculate();
 
     double llik = model.logLik();
+
+    //log odds from a single update should match the change in logLik
+    vector<double> th(2);
+    th[0] = -1.5;
+    th[1] = .3;
+    model.setThetas(th);
+    vector<int> ord0(30, 0);
+    vector<double> change(2);
+    for (int i = 0; i < 20; i++) {
+        pair<int, int> dyad = net.randomDyad();
+        int actor = 0;
+        vector<double> before = model.statistics();
+        double ll0 = model.logLik();
+        double lo = model.dyadUpdateChange(dyad.first, dyad.second, ord0, actor, change);
+        vector<double> after = model.statistics();
+        EXPECT_NEAR(lo, model.logLik() - ll0);
+        for (int k = 0; k < 2; k++)
+            EXPECT_NEAR(change[k], after[k] - before[k]);
+        if (i % 2 == 0)
+            model.network()->toggle(dyad.first, dyad.second);
+        else {
+            model.rollback();
+            vector<double> rolled = model.statistics();
+            for (int k = 0; k < 2; k++)
+                EXPECT_NEAR(rolled[k], before[k]);
+        }
+    }
+    //a statically composed model gives the same log odds
+    Rcpp::List staticParams;
+    staticParams.push_back(Rcpp::List());
+    staticParams.push_back(Rcpp::List());
+    StaticModel<Engine, Stat<Engine, Edges<Engine> >, Stat<Engine, Triangles<Engine> > >
+        smodel(*model.network(), staticParams);
+    smodel.setThetas(th);
+    EXPECT_NEAR(smodel.statistics()[1], model.statistics()[1]);
+    EXPECT_NEAR(smodel.logLik(), model.logLik());
+    vector<double> schange(2);
+    for (int i = 0; i < 10; i++) {
+        pair<int, int> dyad = net.randomDyad();
+        int actor = 0;
+        double lo = model.dyadUpdateChange(dyad.first, dyad.second, ord0, actor, change);
+        double slo = smodel.dyadUpdateChange(dyad.first, dyad.second, ord0, actor, schange);
+        EXPECT_NEAR(lo, slo);
+        model.rollback();
+        smodel.rollback();
+    }
+    EXPECT_NEAR(smodel.statistics()[0], model.statistics()[0]);
+    List sres = smodel.generateNetwork();
+    EXPECT_NEAR(smodel.statistics()[0], model.statistics()[0]);
+
+    //a deep clone has its own arena
+    boost::shared_ptr< Model<Engine> > cl = model.clone();
+    cl->setThetas(vector<double>(2, 1.0));
+    EXPECT_NEAR(model.thetas()[0], -1.5);
+    EXPECT_NEAR(cl->thetas()[0], 1.0);
+    model.setThetas(vector<double>(2, 0.0));
+    model.calculate();
     //Language call2("print",wrap(model.terms()));
     //call2.eval();
     //cout << "\nllik: " << llik << "\n";
@@ -124,6 +182,70 @@ void lt() {
     EXPECT_TRUE(model.getVertexOrderVector().size() == 30);
     lol.generateNetwork();
 
+    vector< pair<int, int> > freeDyads;
+    freeDyads.push_back(make_pair(1, 2));
+    freeDyads.push_back(make_pair(2, 1));
+    freeDyads.push_back(make_pair(4, 4));
+    freeDyads.push_back(make_pair(7, 20));
+    vector<int> vord(30);
+    for (int i = 0; i < 30; i++)
+        vord[i] = 29 - i;
+    lol.generateConditionalNetworkWithOrder(vord, freeDyads);
+
+    //only the free dyads are redrawn, and the drawn network records the order
+    vector<double> observedStats, drawnStats, eStats;
+    int nFree;
+    boost::shared_ptr< BinaryNet<Engine> > before = lol.getModel()->network()->clone();
+    vector<double> beforeStats = lol.getModel()->statistics();
+    boost::shared_ptr< BinaryNet<Engine> > after =
+        lol.drawConditionalNetwork(vord, freeDyads, observedStats, drawnStats, eStats, nFree);
+    set< pair<int, int> > freeSet(freeDyads.begin(), freeDyads.end());
+    for (int i = 0; i < 30; i++) {
+        for (int j = 0; j < 30; j++) {
+            bool isFree = freeSet.count(make_pair(i, j)) ||
+                (!net.isDirected() && freeSet.count(make_pair(j, i)));
+            if (!isFree)
+                EXPECT_TRUE(after->hasEdge(i, j) == before->hasEdge(i, j));
+            //the model is restored
+            EXPECT_TRUE(lol.getModel()->network()->hasEdge(i, j) == before->hasEdge(i, j));
+        }
+    }
+    for (int m = 0; m < beforeStats.size(); m++)
+        EXPECT_NEAR(lol.getModel()->statistics()[m], beforeStats[m]);
+    //the incrementally updated statistics match the drawn network
+    boost::shared_ptr< Model<Engine> > check = lol.getModel()->clone();
+    check->setNetwork(after);
+    check->calculate();
+    for (int m = 0; m < drawnStats.size(); m++)
+        EXPECT_NEAR(check->statistics()[m], drawnStats[m]);
+    EXPECT_TRUE(nFree == (net.isDirected() ? 3 : 2));
+    int order = indexOf(std::string("__order__"), after->discreteVarNames());
+    EXPECT_TRUE(order >= 0);
+    vector<int> ranks = after->discreteVariableValues(order);
+    for (int i = 0; i < 30; i++)
+        EXPECT_TRUE(ranks[vord[i]] == i);
+
+    NumericMatrix thetaMat(3, 2);
+    for (int r = 0; r < 3; r++) {
+        thetaMat(r, 0) = -2.0 + r * .1;
+        thetaMat(r, 1) = .1;
+    }
+    lol.generateNetworksWithThetas(thetaMat, 1);
+    lol.generateNetworksWithThetas(thetaMat, 2);
+
+    //every dyad is visited once per term, and non-edges are rolled back
+    lol.setProfiling(true);
+    lol.generateNetworksWithThetas(thetaMat, 2);
+    boost::shared_ptr<ModelProfile> profiler = lol.getModel()->getProfiler();
+    EXPECT_TRUE(profiler->terms.size() == 2);
+    long nDyads = 3 * net.maxEdges();
+    EXPECT_TRUE(profiler->terms[0].dyadUpdates == nDyads);
+    EXPECT_TRUE(profiler->terms[1].dyadUpdates == nDyads);
+    EXPECT_TRUE(profiler->terms[0].rollbacks == profiler->terms[1].rollbacks);
+    EXPECT_TRUE(profiler->terms[0].rollbacks < nDyads);
+    lol.setProfiling(false);
+    EXPECT_TRUE(!lol.getModel()->isProfiling());
+
     model.setVertexOrderVector(std::vector<int>());
     EXPECT_TRUE(model.getVertexOrderVector().size() == 0);
 
@@ -135,6 +257,118 @@ void lt() {
     PutRNGstate();
 }
 
+/*!
+ * structural zeros are never visited by generation
+ */
+template<class Engine>
+void dyadMaskTest() {
+    using namespace std;
+    IntegerMatrix tmp(0, 2);
+    BinaryNet<Engine> net(tmp, 20);
+    bool directed = net.isDirected();
+
+    //four blocks of five, with ties only within blocks
+    vector<int> blocks(20);
+    for (int i = 0; i < 20; i++)
+        blocks[i] = i % 4;
+    vector< vector<bool> > allowed(4, vector<bool>(4, false));
+    for (int b = 0; b < 4; b++)
+        allowed[b][b] = true;
+    boost::shared_ptr<DyadMask> mask(new DyadMask(directed, blocks, allowed));
+    EXPECT_TRUE(mask->isAllowed(0, 4));
+    EXPECT_TRUE(!mask->isAllowed(0, 1));
+    EXPECT_TRUE(!mask->isAllowed(0, 0));
+    EXPECT_NEAR(mask->nAllowed(), directed ? 80.0 : 40.0);
+    vector<int> rank(20);
+    for (int i = 0; i < 20; i++)
+        rank[i] = i;
+    vector<int> alters;
+    mask->priorAlters(12, rank, 12, alters);
+    EXPECT_TRUE(alters.size() == 3);
+
+    //a list of dyads
+    vector< pair<int, int> > dyads;
+    dyads.push_back(make_pair(0, 1));
+    dyads.push_back(make_pair(1, 0));
+    dyads.push_back(make_pair(2, 3));
+    dyads.push_back(make_pair(0, 1));
+    DyadMask listMask(20, directed, dyads);
+    EXPECT_TRUE(listMask.isAllowed(0, 1));
+    EXPECT_TRUE(listMask.isAllowed(3, 2) == !directed);
+    EXPECT_NEAR(listMask.nAllowed(), directed ? 3.0 : 2.0);
+    listMask.priorAlters(1, rank, 1, alters);
+    EXPECT_TRUE(alters.size() == 1 && alters[0] == 0);
+
+    //each permitted dyad is visited once, and ties only fall on them
+    Model<Engine> model(net);
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Edges<Engine> >()));
+    model.setThetas(vector<double>(1, 2.0));
+    model.setProfiling(true);
+    vector<double> stats(1, 0.0), eStats(1, 0.0);
+    GetRNGstate();
+    LatentOrderLikelihood<Engine>::growNetwork(model, rank, stats, eStats, NULL, mask.get());
+    PutRNGstate();
+    EXPECT_TRUE(model.getProfiler()->terms[0].dyadUpdates == (long) mask->nAllowed());
+    boost::shared_ptr< vector< pair<int, int> > > el = model.network()->edgelist();
+    EXPECT_TRUE(el->size() > 0);
+    EXPECT_NEAR(stats[0], el->size());
+    for (int i = 0; i < el->size(); i++)
+        EXPECT_TRUE(mask->isAllowed((*el)[i].first, (*el)[i].second));
+
+    //the same through the likelihood's coupled generator
+    model.network()->emptyGraph();
+    model.calculate();
+    model.setProfiling(false);
+    LatentOrderLikelihood<Engine> lol(model);
+    lol.setDyadMask(mask);
+    EXPECT_NEAR(lol.nPermittedDyads(), mask->nAllowed());
+    lol.setProfiling(true);
+    NumericMatrix thetaMat(2, 1);
+    thetaMat(0, 0) = 1.0;
+    thetaMat(1, 0) = 2.0;
+    lol.generateNetworksWithThetas(thetaMat, 1);
+    EXPECT_TRUE(lol.getModel()->getProfiler()->terms[0].dyadUpdates == 2 * (long) mask->nAllowed());
+    lol.clearDyadMask();
+    EXPECT_NEAR(lol.nPermittedDyads(), net.maxEdges());
+}
+
+/*!
+ * bipartite generation only visits the dyads between the modes
+ */
+void bipartiteTest() {
+    using namespace std;
+    IntegerMatrix tmp(0, 2);
+    BinaryNet<Bipartite> net(tmp, 3, 30);
+    Model<Bipartite> model(net);
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Bipartite> >(new BipartiteEdges()));
+    model.setThetas(vector<double>(1, 0.5));
+    model.calculate();
+
+    LatentOrderLikelihood<Bipartite> lol(model);
+    EXPECT_NEAR(lol.nPermittedDyads(), 90.0);
+    lol.setProfiling(true);
+    List res = lol.generateNetwork();
+    EXPECT_TRUE(lol.getModel()->getProfiler()->terms[0].dyadUpdates == 90);
+    lol.clearDyadMask();
+    EXPECT_NEAR(lol.nPermittedDyads(), 90.0);
+
+    //growNetwork restricts itself to the dyads between the modes
+    vector<double> stats(1, 0.0), eStats(1, 0.0);
+    Model<Bipartite> gen(model);
+    gen.setNetwork(net.clone());
+    gen.calculate();
+    vector<int> order(33);
+    for (int i = 0; i < 33; i++)
+        order[i] = 32 - i;
+    GetRNGstate();
+    LatentOrderLikelihood<Bipartite>::growNetwork(gen, order, stats, eStats, NULL);
+    PutRNGstate();
+    boost::shared_ptr< vector< pair<int, int> > > el = gen.network()->edgelist();
+    for (int i = 0; i < el->size(); i++)
+        EXPECT_TRUE(((*el)[i].first < 3) != ((*el)[i].second < 3));
+    EXPECT_NEAR(stats[0], el->size());
+}
+
 void rnker() {
     //Rcpp::Environment base_env("package:base");
     //Rcpp::Function set_seed_r = base_env["set.seed"];
@@ -166,6 +400,9 @@ void testLatent() {
     RUN_TEST(lt<Undirected>());
     RUN_TEST(lt<Directed>());
     RUN_TEST(rnker());
+    RUN_TEST(dyadMaskTest<Undirected>());
+    RUN_TEST(dyadMaskTest<Directed>());
+    RUN_TEST(bipartiteTest());
 
 }
 
@@ -158,6 +158,9 @@ void changeStatTest(std::string statName){
         ncpar.push_back(1);
         stat = boost::shared_ptr< Stat<Engine, Esp<Engine> > >(
                 new Stat<Engine, Esp<Engine> >(ncpar));
+    }else if(statName == "Mutual"){
+        stat = boost::shared_ptr< Stat<Engine, Mutual<Engine> > >(
+                new Stat<Engine, Mutual<Engine> >());
     }else if(statName == "TwoPath"){
       stat = boost::shared_ptr< Stat<Engine, TwoPath<Engine> > >(
         new Stat<Engine, TwoPath<Engine> >());
@@ -190,9 +193,20 @@ void changeStatTest(std::string statName){
         net.toggle(dyad.first,dyad.second);
     }
 
+    //read-only change statistics should agree with update
+    bool readOnly = model.hasChangeStats();
+    vector<double> change(model.statistics().size());
     for(int i=0;i<300;i++){
         pair<int,int> dyad = net.randomDyad();
+        if(readOnly)
+            model.changeStatistics(dyad.first,dyad.second, order, dyad.first, change);
+        vector<double> before = model.statistics();
         model.dyadUpdate(dyad.first,dyad.second, order, dyad.first);
+        if(readOnly){
+            vector<double> after = model.statistics();
+            for(int j=0;j<change.size();j++)
+                EXPECT_NEAR(change[j], after[j] - before[j]);
+        }
         if(Rf_runif(0.0,1.0) < .5)
             model.rollback();
         else
@@ -212,6 +226,261 @@ void changeStatTest(std::string statName){
     PutRNGstate();
 }
 
+/*!
+ * terms that share the dyad context of their model should agree with calculate
+ */
+template<class Engine>
+void sharedDyadContextTest(){
+    using namespace std;
+    IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,30);
+    GetRNGstate();
+    for(int i=0;i<60;i++){
+        pair<int,int> dyad = net.randomDyad();
+        net.addEdge(dyad.first,dyad.second);
+    }
+    Rcpp::List gwpar;
+    gwpar.push_back(.5);
+    Rcpp::List esppar;
+    vector<int> esps;
+    esps.push_back(0);
+    esps.push_back(1);
+    esps.push_back(2);
+    esppar.push_back(esps);
+    esppar.push_back(1);
+
+    Model<Engine> model(net);
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Edges<Engine> >()));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Triangles<Engine> >()));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Gwesp<Engine> >(gwpar)));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Esp<Engine> >(esppar)));
+    if(!net.isDirected())
+        model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Transitivity<Engine> >()));
+    model.calculate();
+
+    vector<int> order(30,1);
+    for(int i=0;i<30;i++) order[i] = i;
+    for(int i=0;i<300;i++){
+        pair<int,int> dyad = net.randomDyad();
+        model.dyadUpdate(dyad.first,dyad.second, order, dyad.first);
+        if(Rf_runif(0.0,1.0) < .5)
+            model.rollback();
+        else
+            net.toggle(dyad.first,dyad.second);
+    }
+    vector<double> mcmcStats = model.statistics();
+    model.calculateStatistics();
+    vector<double> realStats = model.statistics();
+    for(int i=0;i<realStats.size();i++)
+        EXPECT_NEAR((mcmcStats.at(i) + .0001)/(realStats.at(i) + .0001),1.0);
+
+    //the context memoises the same values as direct computation
+    DyadContext<Engine> context;
+    for(int i=0;i<50;i++){
+        pair<int,int> dyad = net.randomDyad();
+        context.reset(net, dyad.first, dyad.second);
+        EXPECT_TRUE(context.hasEdge() == net.hasEdge(dyad.first, dyad.second));
+        if(!net.isDirected())
+            EXPECT_TRUE(context.toDegree() == net.degree(dyad.second));
+        for(int type=1;type<5;type++)
+            EXPECT_TRUE(context.sharedCount(type) == sharedNbrs(net, dyad.first, dyad.second, type));
+    }
+    PutRNGstate();
+}
+
+/*!
+ * a term that adds a statistic on every dyad update
+ */
+template<class Engine>
+class GrowingStat : public BaseStat<Engine>{
+public:
+    GrowingStat(){}
+
+    GrowingStat(List params){}
+
+    std::string name(){
+        return "growing";
+    }
+
+    std::vector<std::string> statNames(){
+        return std::vector<std::string>(this->stats.size(), "growing");
+    }
+
+    void calculate(const BinaryNet<Engine>& net){
+        this->init(1);
+    }
+
+    void dyadUpdate(const BinaryNet<Engine>& net,const int &from,const int &to,const std::vector<int> &order,const int &actorIndex){
+        this->init(this->stats.size() + 1);
+    }
+};
+
+/*!
+ * dyadUpdateChange should reject a term that changes shape rather than write
+ * past the end of delta
+ */
+template<class Engine>
+void shapeChangeTest(){
+    using namespace std;
+    IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,20);
+    Model<Engine> model(net);
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Edges<Engine> >()));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, GrowingStat<Engine> >()));
+    model.calculate();
+    vector<double> delta(model.statistics().size());
+    EXPECT_EQUAL(delta.size(), 2);
+    vector<int> order(20);
+    for(int i=0;i<20;i++) order[i] = i;
+    int from = 0, to = 1;
+    bool rejected = false;
+    try{
+        model.dyadUpdateChange(from, to, order, from, delta);
+    }catch(std::exception& e){
+        rejected = true;
+    }
+    EXPECT_TRUE(rejected);
+}
+
+/*!
+ * a model restored from a snapshot should match the original, and its
+ * restored term state should be usable for updates
+ */
+template<class Engine>
+void snapshotTest(){
+    using namespace std;
+    IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,40);
+    GetRNGstate();
+    for(int i=0;i<120;i++){
+        pair<int,int> dyad = net.randomDyad();
+        net.addEdge(dyad.first,dyad.second);
+    }
+    vector<int> vals(40,1);
+    vals[3] = 2;
+    vector<string> labels(2,"a");
+    labels[1] = "b";
+    DiscreteAttrib attr;
+    attr.setName("fact");
+    attr.setLabels(labels);
+    net.addDiscreteVariable(vals, attr);
+    vector<double> cvals(40,1.5);
+    cvals[7] = -2.0;
+    ContinAttrib cattr;
+    cattr.setName("x");
+    cattr.setLowerBound(-3.0);
+    net.addContinVariable(cvals, cattr);
+    net.setMissing(1, 2, true);
+    net.setContinVariableObserved(0, 5, false);
+
+    Model<Engine> model(net);
+    model.addStatistic("edges", Rcpp::List());
+    model.addStatistic("triangles", Rcpp::List());
+    if(net.isDirected()){
+        model.addStatistic("mutual", Rcpp::List());
+    }else{
+        model.addStatistic("transitivity", Rcpp::List());
+        model.addStatistic("clustering", Rcpp::List());
+        model.addStatistic("degreeCrossProd", Rcpp::List());
+    }
+    vector<double> theta(model.statistics().size(), .1);
+    theta[0] = -1.0;
+    model.setThetas(theta);
+
+    Model<Engine> restored;
+    restored.restoreSnapshot(model.snapshot());
+    vector<double> st = model.statistics();
+    vector<double> rst = restored.statistics();
+    EXPECT_TRUE(st.size() == rst.size());
+    for(int i=0;i<st.size();i++)
+        EXPECT_NEAR(st[i], rst[i]);
+    vector<double> rth = restored.thetas();
+    for(int i=0;i<theta.size();i++)
+        EXPECT_NEAR(theta[i], rth[i]);
+
+    BinaryNet<Engine>& rnet = *restored.network();
+    EXPECT_EQUAL(rnet.nEdges(), net.nEdges());
+    for(int i=0;i<40;i++)
+        for(int j=0;j<40;j++)
+            EXPECT_TRUE(rnet.hasEdge(i,j) == net.hasEdge(i,j));
+    EXPECT_TRUE(rnet.isMissing(1,2));
+    EXPECT_TRUE(rnet.discreteVariableValues(0) == net.discreteVariableValues(0));
+    EXPECT_TRUE(rnet.discreteVariableAttributes(0).labels() == labels);
+    EXPECT_NEAR(rnet.continVariableValue(0, 7), -2.0);
+    EXPECT_TRUE(rnet.continVariableAttributes(0).hasLowerBound());
+    EXPECT_TRUE(!rnet.continVariableObserved(0, 5));
+
+    vector<int> order(40,1);
+    for(int i=0;i<40;i++) order[i] = i;
+    for(int i=0;i<100;i++){
+        pair<int,int> dyad = rnet.randomDyad();
+        restored.dyadUpdate(dyad.first,dyad.second, order, dyad.first);
+        rnet.toggle(dyad.first,dyad.second);
+    }
+    PutRNGstate();
+    vector<double> updated = restored.statistics();
+    restored.calculate();
+    vector<double> real = restored.statistics();
+    for(int i=0;i<real.size();i++)
+        EXPECT_NEAR(updated[i], real[i]);
+}
+
+/*!
+ * calculate with several threads should agree with the serial calculation
+ */
+template<class Engine>
+void threadedCalculateTest(){
+    using namespace std;
+    IntegerMatrix tmp(0,2);
+    BinaryNet<Engine> net(tmp,50);
+    GetRNGstate();
+    for(int i=0;i<150;i++){
+        pair<int,int> dyad = net.randomDyad();
+        net.addEdge(dyad.first,dyad.second);
+    }
+    PutRNGstate();
+    Rcpp::List gwpar;
+    gwpar.push_back(.5);
+    Rcpp::List esppar;
+    vector<int> esps;
+    esps.push_back(0);
+    esps.push_back(1);
+    esps.push_back(2);
+    esppar.push_back(esps);
+
+    Model<Engine> model(net);
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Edges<Engine> >()));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Triangles<Engine> >()));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Gwesp<Engine> >(gwpar)));
+    model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Esp<Engine> >(esppar)));
+    if(!net.isDirected())
+        model.addStatPtr(boost::shared_ptr< AbstractStat<Engine> >(new Stat<Engine, Gwdsp<Engine> >(gwpar)));
+    model.calculate();
+    vector<double> serial = model.statistics();
+
+    model.setThreads(3);
+    model.calculate();
+    vector<double> threaded = model.statistics();
+    EXPECT_TRUE(serial.size() == threaded.size());
+    for(int i=0;i<serial.size();i++)
+        EXPECT_NEAR(serial[i], threaded[i]);
+
+    //gwesp's shared partner cache is rebuilt correctly
+    vector<int> order(50,1);
+    for(int i=0;i<50;i++) order[i] = i;
+    for(int i=0;i<50;i++){
+        pair<int,int> dyad = net.randomDyad();
+        model.dyadUpdate(dyad.first,dyad.second, order, dyad.first);
+        net.toggle(dyad.first,dyad.second);
+    }
+    vector<double> updated = model.statistics();
+    model.setThreads(1);
+    model.calculate();
+    vector<double> real = model.statistics();
+    for(int i=0;i<real.size();i++)
+        EXPECT_NEAR(updated[i], real[i]);
+}
+
 
 void testStats(){
 
@@ -226,6 +495,7 @@ void testStats(){
     RUN_TEST(changeStatTest<Directed>("Esp"));
     RUN_TEST(changeStatTest<Directed>("NodeFactor"));
     RUN_TEST(changeStatTest<Directed>("TwoPath"));
+    RUN_TEST(changeStatTest<Directed>("Mutual"));
 
     RUN_TEST(changeStatTest<Undirected>("Triangles"));
     RUN_TEST(changeStatTest<Undirected>("Clustering"));
@@ -244,6 +514,22 @@ void testStats(){
     RUN_TEST(changeStatTest<Undirected>("NodeFactor"));
     RUN_TEST(changeStatTest<Undirected>("TwoPath"));
 
+    RUN_TEST(changeStatTest<Dense>("Triangles"));
+    RUN_TEST(changeStatTest<Dense>("Transitivity"));
+    RUN_TEST(changeStatTest<Dense>("Degree"));
+    RUN_TEST(changeStatTest<Dense>("Gwesp"));
+    RUN_TEST(changeStatTest<Dense>("Gwdsp"));
+    RUN_TEST(changeStatTest<Dense>("Esp"));
+
+    RUN_TEST(sharedDyadContextTest<Directed>());
+    RUN_TEST(sharedDyadContextTest<Undirected>());
+    RUN_TEST(sharedDyadContextTest<Dense>());
+    RUN_TEST(threadedCalculateTest<Directed>());
+    RUN_TEST(threadedCalculateTest<Undirected>());
+    RUN_TEST(snapshotTest<Directed>());
+    RUN_TEST(snapshotTest<Undirected>());
+    RUN_TEST(shapeChangeTest<Undirected>());
+
 }
 
 